@@ -0,0 +1,56 @@
+/**
+ * Binary vs Text Log Benchmark
+ * Logs the order-transition message N times through the text path and
+ * through LOGB, then compares bytes per record and ns per call
+ *
+ * Build: g++ -std=c++17 -O2 bench/BinaryLogBench.cpp src/Logger.cpp src/BinaryLog.cpp -Iinclude -pthread -o binary_log_bench
+ * Run:   ./binary_log_bench > /dev/null   (text lines go to stdout, results to stderr)
+ */
+
+#include "Logger.h"
+#include "OrderFSM.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+template <typename Fn>
+static double timeNsPerCall(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn(i);
+    Logger::flush();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main() {
+    const int iterations = 500000;
+    const char* textFile = "bench_text.log";
+    const char* binaryFile = "bench_binary.blog";
+    std::remove(textFile);
+    std::remove(binaryFile);
+
+    Logger::initialize(textFile);
+    double textNs = timeNsPerCall(iterations, [](int i) {
+        LOGF_INFO("Order ", i, " transitioned to ", OrderFSM::name(OrderState::CONFIRMED));
+    });
+
+    Logger::enableBinary(binaryFile);
+    double binaryNs = timeNsPerCall(iterations, [](int i) {
+        LOGB(LogLevel::INFO, "Order {} transitioned to {}", i, OrderFSM::name(OrderState::CONFIRMED));
+    });
+    Logger::disableBinary();
+
+    double textBytes = static_cast<double>(fs::file_size(textFile)) / iterations;
+    double binaryBytes = static_cast<double>(fs::file_size(binaryFile)) / iterations;
+
+    std::cerr << "=== Order transition log (" << iterations << " records) ===\n";
+    std::cerr << "text    " << textNs << " ns/call  " << textBytes << " bytes/record\n";
+    std::cerr << "binary  " << binaryNs << " ns/call  " << binaryBytes << " bytes/record\n";
+
+    std::remove(textFile);
+    std::remove(binaryFile);
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * CSV Point Lookup Benchmark
+ * Random single-order loads from an orders file (1M rows by default):
+ * scanning the mapped file until the ID matches (the loader before the
+ * sidecar index) against CsvIndex (binary search plus one pread). Also
+ * times the initial index build
+ *
+ * Build: g++ -std=c++17 -O2 bench/CsvIndexBench.cpp src/CsvIndex.cpp src/CsvReader.cpp src/MappedFile.cpp src/Logger.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o csv_index_bench
+ * Run:   ./csv_index_bench [rows] [dir]
+ */
+
+#include "CsvIndex.h"
+#include "CsvReader.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static double microsPer(Clock::time_point start, int count) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / count;
+}
+
+int main(int argc, char** argv) {
+    Logger::setLevel(LogLevel::ERROR);
+    const int rows = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const std::string dir = argc > 2 ? argv[2] : "csv_index_bench";
+    const std::string path = dir + "/orders.txt";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream out(path);
+        for (int id = 1; id <= rows; ++id) out << id << "," << id % 5000 << ",18.4,1,2,1700000000\n";
+    }
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pick(1, rows);
+    long checksum = 0;
+
+    const int scans = 200;
+    auto start = Clock::now();
+    for (int i = 0; i < scans; ++i) {
+        const int id = pick(rng);
+        CsvReader reader;
+        reader.open(path);
+        reader.forEachRow([&](const CsvRow& row) {
+            int rowId = 0, customerId = 0;
+            if (!row.get(0, rowId) || rowId != id) return true;
+            row.get(1, customerId);
+            checksum += customerId;
+            return false;
+        });
+    }
+    const double scanUs = microsPer(start, scans);
+
+    CsvIndex index(path);
+    start = Clock::now();
+    index.rebuild();
+    const double buildMs = microsPer(start, 1) / 1000.0;
+
+    const int lookups = 200000;
+    std::string line;
+    start = Clock::now();
+    for (int i = 0; i < lookups; ++i) {
+        if (!index.find(pick(rng), line)) return 1;
+        CsvRow row;
+        CsvReader::splitLine(line.data(), line.data() + line.size(), row);
+        int customerId = 0;
+        row.get(1, customerId);
+        checksum += customerId;
+    }
+    const double indexUs = microsPer(start, lookups);
+
+    std::cout << rows << " orders (checksum " << checksum << ")\n"
+              << "  full scan : " << scanUs << " us/lookup\n"
+              << "  index     : " << indexUs << " us/lookup (build " << buildMs << " ms)\n";
+    std::filesystem::remove_all(dir);
+    return 0;
+}
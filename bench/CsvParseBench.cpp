@@ -0,0 +1,96 @@
+/**
+ * CSV Parse Benchmark
+ * Writes an orders file in the orders.txt format (10M lines by default)
+ * and loads it twice: the previous loader (std::getline, stringstream
+ * split, std::stoi/std::stod) and CsvReader (mmap, SSE2 delimiter scan,
+ * std::from_chars). Reports rows/s and MB/s for each
+ *
+ * Build: g++ -std=c++17 -O2 bench/CsvParseBench.cpp src/CsvReader.cpp src/MappedFile.cpp src/Logger.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o csv_bench
+ * Run:   ./csv_bench [lines] [path]
+ */
+
+#include "CsvReader.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+static void writeOrders(const std::string& path, long lines) {
+    std::ofstream out(path, std::ios::trunc);
+    std::mt19937 rng(42);
+    auto pick = [&rng](unsigned range) { return static_cast<unsigned>(rng() % range); };
+    char line[96];
+    for (long i = 1; i <= lines; ++i) {
+        const int n = std::snprintf(line, sizeof(line), "%ld,%u,%u.%02u,%u,%u,%u\n", i, 1 + pick(50000),
+                                    5 + pick(200), pick(100), pick(7), pick(4),
+                                    1700000000u + static_cast<unsigned>(i));
+        out.write(line, n);
+    }
+}
+
+static void report(const char* name, long rows, double seconds, double checksum, std::uintmax_t bytes) {
+    std::cout << "  " << name << ": " << static_cast<long>(rows / seconds) << " rows/s, "
+              << static_cast<long>(bytes / seconds / (1 << 20)) << " MB/s (" << rows << " rows, checksum "
+              << static_cast<long>(checksum) << ")\n";
+}
+
+int main(int argc, char** argv) {
+    Logger::setLevel(LogLevel::ERROR);
+    const long lines = argc > 1 ? std::atol(argv[1]) : 10000000;
+    const std::string path = argc > 2 ? argv[2] : "csv_bench_orders.txt";
+
+    std::cout << "Writing " << lines << " orders to " << path << "...\n";
+    writeOrders(path, lines);
+    const std::uintmax_t bytes = std::filesystem::file_size(path);
+
+    // Previous loader: a stringstream and a std::string per field
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::ifstream file(path);
+        std::string line;
+        long rows = 0;
+        double checksum = 0.0;
+        while (std::getline(file, line)) {
+            std::stringstream ss(line);
+            std::string orderId, customerId, total, state, priority, timestamp;
+            std::getline(ss, orderId, ',');
+            std::getline(ss, customerId, ',');
+            std::getline(ss, total, ',');
+            std::getline(ss, state, ',');
+            std::getline(ss, priority, ',');
+            std::getline(ss, timestamp, ',');
+            checksum += std::stoi(customerId) + std::stod(total) + std::stoi(state);
+            rows++;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("getline+stringstream", rows, elapsed.count(), checksum, bytes);
+    }
+
+    // CsvReader: fields are views into the mapping
+    {
+        const auto start = std::chrono::steady_clock::now();
+        CsvReader reader;
+        if (!reader.open(path)) return 1;
+        double checksum = 0.0;
+        const long rows = static_cast<long>(reader.forEachRow([&](const CsvRow& row) {
+            int customerId = 0, state = 0;
+            double total = 0.0;
+            row.get(1, customerId);
+            row.get(2, total);
+            row.get(3, state);
+            checksum += customerId + total + state;
+            return true;
+        }));
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("CsvReader (mmap)    ", rows, elapsed.count(), checksum, bytes);
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
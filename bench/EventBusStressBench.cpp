@@ -0,0 +1,95 @@
+/**
+ * EventBus Concurrency Stress Benchmark
+ * N threads emit ORDER_PLACED as fast as they can while one thread keeps
+ * subscribing and unsubscribing short-lived listeners. Reports emits/second
+ * per thread count and checks that a removed listener is never called
+ *
+ * Build: g++ -std=c++17 -O2 bench/EventBusStressBench.cpp src/EventSystem.cpp src/Config.cpp src/Logger.cpp src/BinaryLog.cpp -Iinclude -pthread -o eventbus_stress
+ * Run:   ./eventbus_stress [seconds-per-run]
+ *        (add -fsanitize=thread to the build to race-check the bus)
+ */
+
+#include "EventSystem.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+class StressListener : public EventListener {
+public:
+    std::atomic<long> calls{0};
+    std::atomic<bool> removed{false};
+    std::atomic<long> lateCalls{0};   // Calls after unsubscribe() returned
+
+    void onEvent(const Event&) override {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        if (removed.load(std::memory_order_relaxed)) lateCalls.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::string getName() const override { return "StressListener"; }
+};
+
+static void run(int emitterThreads, double seconds) {
+    EventBus& bus = EventBus::getInstance();
+    bus.clear();
+
+    StressListener stable;
+    bus.subscribe(EventType::ORDER_PLACED, &stable);
+
+    Event evt{EventType::ORDER_PLACED, EntityType::ORDER, EventSources::intern("StressBench"), 1, std::time(nullptr), {}};
+    std::atomic<bool> stop{false};
+    std::atomic<long> emits{0};
+    long churnCycles = 0;
+    long lateCalls = 0;
+
+    std::thread churn([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            StressListener transient;
+            bus.subscribe(&transient);
+            bus.subscribe(EventType::ORDER_PLACED, &transient);
+            bus.unsubscribe(&transient);
+            transient.removed.store(true);
+            std::this_thread::yield();
+            lateCalls += transient.lateCalls.load();
+            ++churnCycles;
+        }
+    });
+
+    std::vector<std::thread> emitters;
+    for (int t = 0; t < emitterThreads; ++t) {
+        emitters.emplace_back([&] {
+            long local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                bus.emit(evt);
+                ++local;
+            }
+            emits.fetch_add(local);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop.store(true);
+    for (auto& th : emitters) th.join();
+    churn.join();
+
+    std::cout << emitterThreads << " emitters: " << static_cast<long>(emits.load() / seconds)
+              << " emits/s, " << churnCycles << " subscribe/unsubscribe cycles, "
+              << (stable.calls.load() == emits.load() ? "no lost events" : "LOST EVENTS")
+              << ", " << lateCalls << " calls after unsubscribe\n";
+    bus.unsubscribe(&stable);
+}
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    Logger::setLevel(LogLevel::WARNING);
+
+    std::cout << "=== EventBus emit under concurrent subscription churn ===\n";
+    const int maxThreads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        run(threads, seconds);
+    }
+    return 0;
+}
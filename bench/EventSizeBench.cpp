@@ -0,0 +1,97 @@
+/**
+ * Event Footprint Benchmark
+ * Bytes per event and heap allocations per emit for the old string-based
+ * Event layout vs the compact typed Event, plus a real EventBus emit into
+ * one sync and one async listener
+ *
+ * Build: g++ -std=c++17 -O2 bench/EventSizeBench.cpp src/EventSystem.cpp src/Config.cpp src/Logger.cpp src/BinaryLog.cpp -Iinclude -pthread -o event_size_bench
+ * Run:   ./event_size_bench
+ */
+
+#include "EventSystem.h"
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+static std::atomic<long> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// The Event layout before typed payloads
+struct LegacyEvent {
+    EventType type;
+    int entityId;
+    std::string entityType;
+    std::string details;
+    std::time_t timestamp;
+    std::string sourceAction;
+};
+
+class CountingListener : public EventListener {
+public:
+    std::atomic<long> calls{0};
+    void onEvent(const Event&) override { calls.fetch_add(1, std::memory_order_relaxed); }
+    std::string getName() const override { return "CountingListener"; }
+};
+
+template <typename Fn>
+static void measure(const char* name, int iterations, Fn&& fn) {
+    long before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn(i);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    long allocs = allocations.load() - before;
+    std::cout << name << ": " << static_cast<double>(allocs) / iterations << " allocs/emit, "
+              << elapsed.count() / iterations << " ns/emit\n";
+}
+
+int main() {
+    const int iterations = 1000000;
+    Logger::setLevel(LogLevel::WARNING);
+
+    std::cout << "=== Event footprint ===\n";
+    std::cout << "sizeof(LegacyEvent): " << sizeof(LegacyEvent) << " bytes (+ heap for long strings)\n";
+    std::cout << "sizeof(Event):       " << sizeof(Event) << " bytes (no heap)\n\n";
+
+    std::cout << "=== Build an ORDER_PLACED event and hand a copy to a queue (" << iterations << " emits) ===\n";
+    LegacyEvent legacySlot{};
+    measure("legacy (strings)     ", iterations, [&](int i) {
+        LegacyEvent evt{EventType::ORDER_PLACED, i, "Order",
+                        "Customer #" + std::to_string(101) + " placed order $" + std::to_string(450.0),
+                        std::time(nullptr), "OrderService"};
+        legacySlot = evt;   // By-value handoff, as the async queues do
+    });
+
+    const EventSourceId source = EventSources::intern("OrderService");
+    Event slot{};
+    measure("compact (typed)      ", iterations, [&](int i) {
+        Event evt{EventType::ORDER_PLACED, EntityType::ORDER, source, i, std::time(nullptr),
+                  OrderPayload{101, 450.0}};
+        slot = evt;
+    });
+
+    std::cout << "\n=== EventBus::emit to one SYNC and one ASYNC listener ===\n";
+    EventBus& bus = EventBus::getInstance();
+    CountingListener syncListener, asyncListener;
+    bus.subscribe(&syncListener, DispatchMode::SYNC);
+    bus.subscribe(&asyncListener, DispatchMode::ASYNC, 1 << 16, QueueFullPolicy::BLOCK);
+    measure("compact via EventBus ", iterations, [&](int i) {
+        Event evt{EventType::ORDER_PLACED, EntityType::ORDER, source, i, std::time(nullptr),
+                  OrderPayload{101, 450.0}};
+        bus.emit(evt);
+    });
+    bus.drainAsync();
+    std::cout << "delivered: " << syncListener.calls << " sync, " << asyncListener.calls << " async\n";
+    bus.clear();
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * Idempotency Registry Benchmark
+ * 1M request IDs recorded and then checked from 8 threads (75% repeats,
+ * 25% fresh IDs), against the previous std::map registry behind one
+ * global mutex. Reports throughput per phase
+ *
+ * Build: g++ -std=c++17 -O2 bench/IdempotencyBench.cpp src/IdempotencyService.cpp src/IdempotencyStore.cpp src/MappedFile.cpp src/Logger.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o idempotency_bench
+ * Run:   ./idempotency_bench
+ */
+
+#include "IdempotencyService.h"
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The registry before sharding, made thread-safe the simplest way
+class GlobalMapRegistry {
+    std::map<std::string, IdempotencyRecord> records;
+    std::mutex mutex;
+
+public:
+    bool isDuplicate(const std::string& requestId, std::string& cachedResult) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = records.find(requestId);
+        if (it == records.end()) return false;
+        if (it->second.isExpired()) {
+            records.erase(it);
+            return false;
+        }
+        cachedResult = it->second.resultData;
+        return true;
+    }
+    void recordSuccess(const std::string& requestId, const std::string& operationType,
+                       const std::string& resultData) {
+        std::lock_guard<std::mutex> lock(mutex);
+        records[requestId] = {requestId, operationType, true, resultData, std::time(nullptr), 86400};
+    }
+};
+
+struct ShardedRegistry {
+    bool isDuplicate(const std::string& requestId, std::string& cachedResult) {
+        return IdempotencyService::isDuplicate(requestId, cachedResult);
+    }
+    void recordSuccess(const std::string& requestId, const std::string& operationType,
+                       const std::string& resultData) {
+        IdempotencyService::recordSuccess(requestId, operationType, resultData);
+    }
+};
+
+template <typename Fn>
+static double runThreads(int threads, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back(fn, t);
+    for (auto& w : workers) w.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template <typename Registry>
+static void run(const char* name, Registry& registry, const std::vector<std::string>& ids,
+                int threads) {
+    const std::size_t keys = ids.size();
+    const std::size_t perThread = keys / threads;
+
+    double recordSecs = runThreads(threads, [&](int t) {
+        for (std::size_t i = t * perThread; i < (t + 1) * perThread; ++i) {
+            registry.recordSuccess(ids[i], "place_order", "OrderID=1|Amount=100.00");
+        }
+    });
+
+    std::atomic<long> hits{0};
+    double checkSecs = runThreads(threads, [&](int t) {
+        std::string cached;
+        long localHits = 0;
+        std::uint64_t x = 88172645463325252ull + t;
+        for (std::size_t i = 0; i < perThread; ++i) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            if ((x & 3) == 0) {
+                localHits += registry.isDuplicate("fresh-" + std::to_string(t) + "-" +
+                                                  std::to_string(i), cached);
+            } else {
+                localHits += registry.isDuplicate(ids[x % keys], cached);
+            }
+        }
+        hits.fetch_add(localHits);
+    });
+
+    std::cout << name << ": record " << keys / recordSecs / 1e6 << " M ops/s, check "
+              << keys / checkSecs / 1e6 << " M ops/s (" << hits.load() << " hits)\n";
+}
+
+int main() {
+    Logger::setLevel(LogLevel::WARNING);
+    const std::size_t keys = 1000000;
+    const int threads = 8;
+
+    std::vector<std::string> ids;
+    ids.reserve(keys);
+    for (std::size_t i = 0; i < keys; ++i) ids.push_back("req-" + std::to_string(i * 2654435761u));
+
+    std::cout << "=== " << keys << " request IDs, " << threads << " threads ===\n";
+    GlobalMapRegistry baseline;
+    run("std::map + global mutex", baseline, ids, threads);
+    ShardedRegistry sharded;
+    run("sharded open addressing", sharded, ids, threads);
+    return 0;
+}
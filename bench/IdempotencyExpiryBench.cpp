@@ -0,0 +1,74 @@
+/**
+ * Idempotency Expiry Benchmark
+ * 1,000 short-TTL records expire next to a growing set of 24h records.
+ * Times one cleanupExpired() against the previous full-registry scan
+ * (std::map, isExpired() per record). Each round sleeps ~2s so the
+ * short records are due
+ *
+ * Build: g++ -std=c++17 -O2 bench/IdempotencyExpiryBench.cpp src/IdempotencyService.cpp src/IdempotencyStore.cpp src/MappedFile.cpp src/Logger.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o idempotency_expiry_bench
+ * Run:   ./idempotency_expiry_bench
+ */
+
+#include "IdempotencyService.h"
+#include "Logger.h"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+static double elapsedUs(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main() {
+    Logger::setLevel(LogLevel::WARNING);
+    const int expiring = 1000;
+    const int sizes[] = {10000, 100000, 1000000};
+    int loaded = 0;
+
+    std::cout << "=== cleanup with " << expiring << " expiring records ===\n";
+    for (int size : sizes) {
+        // Previous registry: one map, full scan
+        std::map<std::string, IdempotencyRecord> baseline;
+        const std::time_t now = std::time(nullptr);
+        for (int i = 0; i < size; ++i) {
+            const std::string id = "live-" + std::to_string(i);
+            baseline[id] = {id, "place_order", true, "OrderID=1", now, 86400};
+        }
+        for (int i = 0; i < expiring; ++i) {
+            const std::string id = "short-" + std::to_string(size) + "-" + std::to_string(i);
+            baseline[id] = {id, "place_order", true, "OrderID=1", now, 0};
+        }
+
+        IdempotencyService::setDefaultTTL(86400);
+        for (; loaded < size; ++loaded) {
+            IdempotencyService::recordSuccess("live-" + std::to_string(loaded), "place_order", "OrderID=1");
+        }
+        IdempotencyService::setDefaultTTL(0);
+        for (int i = 0; i < expiring; ++i) {
+            IdempotencyService::recordSuccess("short-" + std::to_string(size) + "-" + std::to_string(i),
+                                              "place_order", "OrderID=1");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+
+        auto start = std::chrono::steady_clock::now();
+        int scanned = 0;
+        for (auto it = baseline.begin(); it != baseline.end();) {
+            ++scanned;
+            it = it->second.isExpired() ? baseline.erase(it) : std::next(it);
+        }
+        const double scanUs = elapsedUs(start);
+
+        const int before = IdempotencyService::getTrackedCount();
+        start = std::chrono::steady_clock::now();
+        IdempotencyService::cleanupExpired();
+        const double wheelUs = elapsedUs(start);
+        const int removed = before - IdempotencyService::getTrackedCount();
+
+        std::cout << size << " live: full scan " << scanUs << " us (" << scanned << " visited), "
+                  << "timing wheel " << wheelUs << " us (" << removed << " reclaimed)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * Disabled-Level Logging Microbenchmark
+ * Counts heap allocations and ns/call for DEBUG logging while the runtime
+ * level is INFO: eager string building vs the LOGF_* macros
+ *
+ * Build: g++ -std=c++17 -O2 bench/LogElisionBench.cpp src/Logger.cpp src/PermissionService.cpp src/EventSystem.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o log_elision_bench
+ * Run:   ./log_elision_bench
+ */
+
+#include "Logger.h"
+#include "PermissionService.h"
+#include "EventSystem.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+static std::atomic<long> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+template <typename Fn>
+static void measure(const char* name, int iterations, Fn&& fn) {
+    long before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn(i);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    long allocs = allocations.load() - before;
+    std::cout << name << ": " << static_cast<double>(allocs) / iterations << " allocs/call, "
+              << elapsed.count() / iterations << " ns/call\n";
+}
+
+int main() {
+    const int iterations = 1000000;
+    Logger::setLevel(LogLevel::INFO);
+    const std::string entityType = "Inventory";
+
+    std::cout << "=== DEBUG logging with runtime level INFO (" << iterations << " calls) ===\n";
+    measure("eager Logger::log   ", iterations, [&](int i) {
+        Logger::log(LogLevel::DEBUG, "EventBus: Emitting INVENTORY_UPDATED (entity:" + entityType +
+                                     "#" + std::to_string(i) + ")");
+    });
+    measure("LOGF_DEBUG          ", iterations, [&](int i) {
+        LOGF_DEBUG("EventBus: Emitting INVENTORY_UPDATED (entity:", entityType, "#", i, ")");
+    });
+    measure("canPerform          ", iterations, [](int) {
+        PermissionService::canPerform(Action::CREATE_ORDER);
+    });
+
+    Event evt{EventType::INVENTORY_UPDATED, EntityType::INVENTORY, EventSources::intern("InventoryService"), 42,
+              std::time(nullptr), InventoryPayload{25, 10}};
+    measure("EventBus::emit      ", iterations, [&](int) {
+        EventBus::getInstance().emit(evt);
+    });
+    return 0;
+}
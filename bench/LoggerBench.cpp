@@ -0,0 +1,56 @@
+/**
+ * Logger Throughput Benchmark
+ * Compares messages/second of the synchronous path against async mode
+ *
+ * Build: g++ -std=c++17 -O2 bench/LoggerBench.cpp src/Logger.cpp src/BinaryLog.cpp -Iinclude -pthread -o logger_bench
+ * Run:   ./logger_bench > /dev/null   (log lines go to stdout, results to stderr)
+ */
+
+#include "Logger.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double runProducers(int threads, int messagesPerThread) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([t, messagesPerThread] {
+            for (int i = 0; i < messagesPerThread; ++i) {
+                Logger::log(LogLevel::INFO, "Order " + std::to_string(i) +
+                                            " transitioned to CONFIRMED (worker " + std::to_string(t) + ")");
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    Logger::flush();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return (threads * static_cast<double>(messagesPerThread)) / elapsed.count();
+}
+
+int main() {
+    const int messages = 200000;
+    Logger::initialize("bench_logger.log");
+
+    std::cerr << "=== Logger Benchmark (" << messages << " msgs/thread) ===\n";
+    for (int threads : {1, 4}) {
+        double rate = runProducers(threads, messages);
+        std::cerr << "sync   threads=" << threads << "  " << static_cast<long>(rate) << " msg/s\n";
+    }
+
+    Logger::enableAsync(1 << 16, LogOverflowPolicy::BLOCK);
+    for (int threads : {1, 4}) {
+        double rate = runProducers(threads, messages);
+        std::cerr << "async  threads=" << threads << "  " << static_cast<long>(rate) << " msg/s (BLOCK)\n";
+    }
+    Logger::shutdown();
+
+    Logger::enableAsync(1 << 12, LogOverflowPolicy::DROP);
+    double rate = runProducers(4, messages);
+    std::cerr << "async  threads=4  " << static_cast<long>(rate) << " msg/s (DROP, dropped="
+              << Logger::getDroppedCount() << ")\n";
+    Logger::shutdown();
+    return 0;
+}
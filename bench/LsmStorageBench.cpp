@@ -0,0 +1,77 @@
+/**
+ * LSM Storage Benchmark
+ * 100k orders, each saved 5 times (status updates), through
+ * CSVStorageStrategy and LSMStorageStrategy. Reports save rate, random
+ * point-load latency and bytes on disk for each
+ *
+ * Build: g++ -std=c++17 -O2 bench/LsmStorageBench.cpp src/CachingStorageStrategy.cpp src/StorageStrategy.cpp src/CsvCompactor.cpp src/LsmTree.cpp src/CsvIndex.cpp src/CsvReader.cpp src/MappedFile.cpp src/Logger.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o lsm_bench
+ * Run:   ./lsm_bench [orders] [dir]
+ */
+
+#include "StorageStrategy.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static std::uintmax_t diskBytes(const std::string& dir) {
+    std::uintmax_t bytes = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file()) bytes += entry.file_size();
+    }
+    return bytes;
+}
+
+static void run(const char* name, StorageStrategy& storage, const std::string& dir, int orders) {
+    const int versions = 5;
+    const std::size_t batchSize = 1000;
+    std::vector<Order> batch;
+    auto start = Clock::now();
+    for (int version = 0; version < versions; ++version) {
+        for (int first = 1; first <= orders; first += static_cast<int>(batchSize)) {
+            batch.clear();
+            for (int id = first; id < first + static_cast<int>(batchSize) && id <= orders; ++id) {
+                batch.push_back(Order{id, id % 5000, 18.4 + version, 2, 1700000000, static_cast<OrderState>(version)});
+            }
+            storage.saveOrders(batch.data(), batch.size());
+        }
+    }
+    storage.flush();
+    const double saveSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::mt19937 rng(3);
+    const int lookups = 100000;
+    double checksum = 0.0;
+    start = Clock::now();
+    for (int i = 0; i < lookups; ++i) checksum += storage.loadOrder(1 + static_cast<int>(rng() % orders)).total;
+    const double lookupUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / lookups;
+
+    std::cout << "  " << name << ": " << static_cast<long>(orders * versions / saveSeconds) << " saves/s, "
+              << lookupUs << " us/load, " << diskBytes(dir) / 1024 << " KB on disk (checksum "
+              << static_cast<long>(checksum) << ")\n";
+}
+
+int main(int argc, char** argv) {
+    Logger::setLevel(LogLevel::ERROR);
+    const int orders = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const std::string dir = argc > 2 ? argv[2] : "lsm_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir + "/csv");
+    std::cout << orders << " orders x 5 versions\n";
+    {
+        CSVStorageStrategy csv(dir + "/csv");
+        run("CSV", csv, dir + "/csv", orders);
+    }
+    {
+        LSMStorageStrategy lsm(dir + "/lsm");
+        run("LSM", lsm, dir + "/lsm", orders);
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
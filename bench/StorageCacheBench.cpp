@@ -0,0 +1,125 @@
+/**
+ * Storage Cache Benchmark
+ * Runs the same workloads against a CSV backend directly and through
+ * CachingStorageStrategy:
+ *   - a skewed mix of order loads and saves (90% loads, 90% of all
+ *     operations on 10% of the IDs) on one thread, periodic flushes
+ *   - durable saves (fdatasync per flush) from several threads, each
+ *     save waiting for the disk, then group commit (SYNC_ON_COMMIT)
+ *
+ * Build: g++ -std=c++17 -O2 bench/StorageCacheBench.cpp src/CachingStorageStrategy.cpp src/StorageStrategy.cpp src/CsvCompactor.cpp src/CsvIndex.cpp src/CsvReader.cpp src/LsmTree.cpp src/MappedFile.cpp src/Logger.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o storage_cache_bench
+ * Run:   ./storage_cache_bench [orders] [operations] [threads] [dir]
+ */
+
+#include "CachingStorageStrategy.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static std::unique_ptr<CSVStorageStrategy> freshCsv(const std::string& dir, int orders, bool durable) {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto csv = std::make_unique<CSVStorageStrategy>(dir);
+    std::vector<Order> batch;
+    for (int id = 1; id <= orders; ++id) {
+        batch.push_back(Order{id, id % 5000, 18.4, 1, 1700000000 + id, OrderState::CREATED});
+    }
+    csv->saveOrders(batch.data(), batch.size());
+    CsvWritePolicy policy;
+    policy.syncOnFlush = durable;
+    csv->setWritePolicy(policy);
+    return csv;
+}
+
+static void mixed(const char* name, StorageStrategy& storage, int orders, int operations) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> hot(1, std::max(1, orders / 10));
+    std::uniform_int_distribution<int> any(1, orders);
+    const auto start = Clock::now();
+    for (int i = 0; i < operations; ++i) {
+        const int id = percent(rng) < 90 ? hot(rng) : any(rng);
+        if (percent(rng) < 90) {
+            storage.loadOrder(id);
+        } else {
+            storage.saveOrder(Order{id, id % 5000, 20.0, 2, 1700000000, OrderState::CONFIRMED});
+        }
+    }
+    storage.flush();
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    std::cout << "  " << name << ": " << static_cast<long>(operations / elapsed.count()) << " ops/s\n";
+}
+
+static void durable(const char* name, StorageStrategy& storage, int threads, int saves) {
+    std::vector<std::vector<double>> micros(threads);
+    std::vector<std::thread> writers;
+    const auto start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < saves; ++i) {
+                const auto begin = Clock::now();
+                storage.saveOrder(Order{t * saves + i + 1, t, 9.5, 3, 1700000000, OrderState::PREPARING});
+                micros[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    std::vector<double> all;
+    for (const auto& m : micros) all.insert(all.end(), m.begin(), m.end());
+    std::sort(all.begin(), all.end());
+    std::cout << "  " << name << ": " << static_cast<long>(all.size() / elapsed.count()) << " saves/s, p50 "
+              << all[all.size() / 2] << " us, p99 " << all[all.size() * 99 / 100] << " us\n";
+}
+
+static void report(const CachingStorageStrategy& cache) {
+    const StorageCacheStats stats = cache.getStats();
+    std::cout << "    hit ratio " << stats.hitRatio() * 100 << "%, " << stats.flushes << " flushes of "
+              << stats.flushedRecords << " records, mean " << stats.meanFlushMs() << " ms, max "
+              << stats.maxFlushMs << " ms\n";
+}
+
+int main(int argc, char** argv) {
+    Logger::setLevel(LogLevel::ERROR);
+    const int orders = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int operations = argc > 2 ? std::atoi(argv[2]) : 500000;
+    const int threads = argc > 3 ? std::atoi(argv[3]) : 8;
+    const std::string dir = argc > 4 ? argv[4] : "storage_cache_bench";
+
+    std::cout << orders << " orders, " << operations << " skewed loads/saves (10% saves)\n";
+    {
+        auto csv = freshCsv(dir, orders, false);
+        mixed("CSV direct        ", *csv, orders, operations);
+    }
+    {
+        CachingStorageStrategy cache(freshCsv(dir, orders, false));
+        mixed("cached, 100 ms    ", cache, orders, operations);
+        report(cache);
+    }
+
+    const int saves = std::max(1, operations / 1000);
+    std::cout << threads << " threads x " << saves << " durable saves\n";
+    {
+        auto csv = freshCsv(dir, orders, true);
+        durable("CSV direct        ", *csv, threads, saves);
+    }
+    {
+        StorageCacheOptions options;
+        options.durability = StorageCacheOptions::Durability::SYNC_ON_COMMIT;
+        CachingStorageStrategy cache(freshCsv(dir, orders, true), options);
+        durable("cached, sync      ", cache, threads, saves);
+        report(cache);
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
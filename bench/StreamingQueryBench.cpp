@@ -0,0 +1,120 @@
+/**
+ * Streaming Query Benchmark
+ * Writes an orders file (5M rows by default) and runs one filtered query
+ * (a customer's orders) two ways, each in a fresh child process so its
+ * peak RSS is measured alone:
+ *   - loadAllOrders() then filter (how OrderQueryService used to work)
+ *   - forEachOrder(predicate, visitor) streaming over the mapped file
+ * Then the same streaming query through LSMStorageStrategy
+ *
+ * Build: g++ -std=c++17 -O2 bench/StreamingQueryBench.cpp src/CachingStorageStrategy.cpp src/StorageStrategy.cpp src/CsvCompactor.cpp src/LsmTree.cpp src/CsvIndex.cpp src/CsvReader.cpp src/MappedFile.cpp src/Logger.cpp src/Config.cpp src/BinaryLog.cpp -Iinclude -pthread -o streaming_query_bench
+ * Run:   ./streaming_query_bench [rows] [dir]
+ */
+
+#include "StorageStrategy.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+// Run body in a child process and return the child's peak RSS in MB
+template <typename Body>
+static long inChild(Body&& body) {
+    std::cout.flush();
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        body();
+        std::cout.flush();
+        std::_Exit(0);
+    }
+    int status = 0;
+    struct rusage usage {};
+    ::wait4(pid, &status, 0, &usage);
+    return usage.ru_maxrss / 1024;
+}
+
+template <typename Query>
+static void measure(const char* name, Query&& query) {
+    const long peakMb = inChild([&] {
+        const auto start = Clock::now();
+        const std::size_t matches = query();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::cout << "  " << name << ": " << matches << " matches, " << elapsed.count() << " s";
+    });
+    std::cout << ", peak RSS " << peakMb << " MB\n";
+}
+
+int main(int argc, char** argv) {
+    Logger::setLevel(LogLevel::ERROR);
+    const int rows = argc > 1 ? std::atoi(argv[1]) : 5000000;
+    const std::string dir = argc > 2 ? argv[2] : "streaming_query_bench";
+    const int customer = 42;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream out(dir + "/orders.txt");
+        for (int id = 1; id <= rows; ++id) {
+            out << id << "," << id % 5000 << ",18.4," << id % 7 << ",2," << 1700000000 + id << "\n";
+        }
+    }
+    std::cout << rows << " orders, " << std::filesystem::file_size(dir + "/orders.txt") / (1024 * 1024)
+              << " MB on disk; orders of customer " << customer << "\n";
+
+    const auto wanted = [customer](const Order& order) { return order.customerId == customer; };
+
+    measure("loadAllOrders + filter", [&] {
+        CSVStorageStrategy storage(dir);
+        std::vector<Order> matches;
+        for (const Order& order : storage.loadAllOrders()) {
+            if (wanted(order)) matches.push_back(order);
+        }
+        return matches.size();
+    });
+
+    measure("forEachOrder (CSV)    ", [&] {
+        CSVStorageStrategy storage(dir);
+        std::vector<Order> matches;
+        storage.forEachOrder(wanted, [&](const Order& order) {
+            matches.push_back(order);
+            return true;
+        });
+        return matches.size();
+    });
+
+    inChild([&] {
+        LSMStorageStrategy lsm(dir + "/lsm");
+        CSVStorageStrategy csv(dir);
+        std::vector<Order> batch;
+        csv.forEachOrder(nullptr, [&](const Order& order) {
+            batch.push_back(order);
+            if (batch.size() == 10000) {
+                lsm.saveOrders(batch.data(), batch.size());
+                batch.clear();
+            }
+            return true;
+        });
+        lsm.saveOrders(batch.data(), batch.size());
+        lsm.compact();
+    });
+    measure("forEachOrder (LSM)    ", [&] {
+        LSMStorageStrategy storage(dir + "/lsm");
+        std::vector<Order> matches;
+        storage.forEachOrder(wanted, [&](const Order& order) {
+            matches.push_back(order);
+            return true;
+        });
+        return matches.size();
+    });
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
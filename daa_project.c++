@@ -51,6 +51,14 @@ WHY SINGLE FILE?
 #include <regex>
 #include <stdexcept>
 #include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -81,16 +89,80 @@ public:
 
 // Logging System
 enum class LogLevel { DEBUG, INFO, WARNING, ERROR };
+enum class LogOverflowPolicy { DROP, BLOCK };  // What a producer does when its ring is full
+
+// Async logging: one SPSC ring per producer thread, drained by a single writer
+struct LogRecord {
+    LogLevel level = LogLevel::INFO;
+    time_t time = 0;
+    string message;  // Capacity reused once the slot has warmed up
+};
+
+class LogRing {
+public:
+    explicit LogRing(size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+    bool tryPush(LogLevel level, time_t when, const string& message) {
+        size_t t = tail.load(memory_order_relaxed);
+        if (t - head.load(memory_order_acquire) == slots.size()) return false;
+        LogRecord& r = slots[t & mask];
+        r.level = level;
+        r.time = when;
+        r.message.assign(message);
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+    template <typename Fn>
+    void drain(Fn&& fn) {
+        size_t h = head.load(memory_order_relaxed);
+        size_t t = tail.load(memory_order_acquire);
+        for (size_t i = h; i != t; ++i) fn(slots[i & mask]);
+        head.store(t, memory_order_release);
+    }
+    bool empty() const {
+        return head.load(memory_order_acquire) == tail.load(memory_order_acquire);
+    }
+
+    atomic<bool> retired{false};  // Owning thread has exited
+    atomic<bool> pushing{false};  // Owner is inside enqueue()
+private:
+    vector<LogRecord> slots;
+    size_t mask;
+    alignas(64) atomic<size_t> head{0};
+    alignas(64) atomic<size_t> tail{0};
+};
+
 class Logger {
 private:
     static ofstream logFile;
+    static string logPath;
     static LogLevel currentLevel;
-public:
-    static void initialize(const string& filename = "restaurant.log") {
-        logFile.open(filename, ios::app);
-    }
-    static void log(LogLevel level, const string& message) {
-        if (level < currentLevel) return;  // Filter by configured level
+
+    // Async backend state
+    static atomic<bool> asyncEnabled;
+    static atomic<unsigned> asyncGeneration;
+    static atomic<size_t> droppedCount;
+    static size_t ringCapacity;
+    static LogOverflowPolicy overflowPolicy;
+    static mutex syncMutex;  // Synchronous writes; producers fall back to them during shutdown()
+    static mutex registryMutex;
+    static vector<shared_ptr<LogRing>> rings;
+    static mutex wakeMutex;
+    static condition_variable wakeCv;
+    static condition_variable flushedCv;
+    static bool stopRequested;
+    static uint64_t flushRequested;
+    static uint64_t flushCompleted;
+    static thread writerThread;
+    static int fileFd;
+
+    struct RingHandle {
+        shared_ptr<LogRing> ring;
+        unsigned generation = 0;
+        ~RingHandle() { if (ring) ring->retired.store(true, memory_order_release); }
+    };
+
+    static void appendLine(string& out, LogLevel level, time_t when, const string& message) {
         const char* levelStr;
         switch (level) {
             case LogLevel::DEBUG: levelStr = "[DEBUG]"; break;
@@ -99,18 +171,264 @@ public:
             case LogLevel::ERROR: levelStr = "[ERROR]"; break;
             default: levelStr = "[UNK]"; break;
         }
+        // strftime/localtime dominate formatting cost; reformat only when the second changes
+        static thread_local time_t cachedTime = -1;
+        static thread_local char timeStr[20];
+        if (when != cachedTime) {
+            cachedTime = when;
+            strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localtime(&when));
+        }
+        out += timeStr;
+        out += ' ';
+        out += levelStr;
+        out += ' ';
+        out += message;
+        out += '\n';
+    }
+
+    static size_t pieceSize(const string& s) { return s.size(); }
+    static size_t pieceSize(const char* s) { return strlen(s); }
+    template <typename T, typename = enable_if_t<is_arithmetic<T>::value>>
+    static size_t pieceSize(T) { return 24; }
+    static void appendPiece(string& out, const string& s) { out += s; }
+    static void appendPiece(string& out, const char* s) { out += s; }
+    template <typename T, typename = enable_if_t<is_arithmetic<T>::value>>
+    static void appendPiece(string& out, T value) { out += to_string(value); }
+
+    static LogRing& threadRing() {
+        static thread_local RingHandle local;
+        unsigned gen = asyncGeneration.load(memory_order_acquire);
+        if (!local.ring || local.generation != gen) {
+            if (local.ring) local.ring->retired.store(true, memory_order_release);
+            local.ring = make_shared<LogRing>(ringCapacity);
+            local.generation = gen;
+            lock_guard<mutex> lock(registryMutex);
+            rings.push_back(local.ring);
+        }
+        return *local.ring;
+    }
+
+    // False once shutdown() has begun (the caller writes synchronously); the
+    // seq_cst pair pushing/asyncEnabled lets shutdown() wait for pushes in flight
+    static bool enqueue(LogLevel level, time_t when, const string& message) {
+        LogRing& ring = threadRing();
+        ring.pushing.store(true);
+        if (!asyncEnabled.load()) {
+            ring.pushing.store(false, memory_order_release);
+            return false;
+        }
+        while (!ring.tryPush(level, when, message)) {
+            if (overflowPolicy == LogOverflowPolicy::DROP) {
+                droppedCount.fetch_add(1, memory_order_relaxed);
+                break;
+            }
+            wakeCv.notify_one();
+            this_thread::yield();
+        }
+        ring.pushing.store(false, memory_order_release);
+        return true;
+    }
+
+    static void writeAll(int fd, const string& data) {
+        size_t off = 0;
+        while (off < data.size()) {
+            auto n = ::write(fd, data.data() + off, data.size() - off);
+            if (n <= 0) return;
+            off += static_cast<size_t>(n);
+        }
+    }
+
+    static void writerLoop() {
+        string batch;
+        unique_lock<mutex> lock(wakeMutex);
+        for (;;) {
+            wakeCv.wait_for(lock, chrono::milliseconds(5),
+                            [] { return stopRequested || flushRequested != flushCompleted; });
+            bool stopping = stopRequested;
+            uint64_t target = flushRequested;
+            lock.unlock();
+
+            batch.clear();
+            {
+                lock_guard<mutex> reg(registryMutex);
+                for (auto it = rings.begin(); it != rings.end();) {
+                    (*it)->drain([&batch](const LogRecord& r) { appendLine(batch, r.level, r.time, r.message); });
+                    if ((*it)->retired.load(memory_order_acquire) && (*it)->empty()) it = rings.erase(it);
+                    else ++it;
+                }
+            }
+            if (!batch.empty()) {
+                writeAll(STDOUT_FILENO, batch);       // One write() per batch per sink
+                if (fileFd >= 0) writeAll(fileFd, batch);
+            }
+
+            lock.lock();
+            flushCompleted = target;
+            flushedCv.notify_all();
+            if (stopping) break;
+        }
+    }
+
+public:
+    static bool isEnabled(LogLevel level) { return level >= currentLevel; }
+
+    // Build a message from pieces with one allocation (strings, C strings, numbers)
+    template <typename... Args>
+    static string concat(const Args&... args) {
+        string out;
+        out.reserve((size_t{0} + ... + pieceSize(args)));
+        (appendPiece(out, args), ...);
+        return out;
+    }
+
+    static void initialize(const string& filename = "restaurant.log") {
+        logPath = filename;
+        logFile.open(filename, ios::app);
+    }
+    static void log(LogLevel level, const string& message) {
+        if (level < currentLevel) return;  // Filter by configured level
         time_t now = time(nullptr);
-        char timeStr[20];
-        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localtime(&now));
-        cout << timeStr << ' ' << levelStr << " " << message << "\n";
+        if (asyncEnabled.load(memory_order_acquire) && enqueue(level, now, message)) return;
+        string line;
+        appendLine(line, level, now, message);
+        lock_guard<mutex> lock(syncMutex);
+        cout << line;
         if (logFile.is_open()) {
-            logFile << timeStr << ' ' << levelStr << " " << message << "\n";
+            logFile << line;
             logFile.flush();
         }
     }
+
+    // Producers push into per-thread rings; a background thread batches the I/O
+    static void enableAsync(size_t capacity = 4096, LogOverflowPolicy policy = LogOverflowPolicy::DROP) {
+        if (asyncEnabled.load()) return;
+        size_t rounded = 2;
+        while (rounded < capacity) rounded <<= 1;
+        ringCapacity = rounded;
+        overflowPolicy = policy;
+        cout.flush();
+        if (logFile.is_open()) logFile.flush();
+        fileFd = ::open(logPath.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+        {
+            lock_guard<mutex> lock(wakeMutex);
+            stopRequested = false;
+        }
+        asyncGeneration.fetch_add(1, memory_order_release);
+        writerThread = thread(writerLoop);
+        asyncEnabled.store(true, memory_order_release);
+    }
+
+    // Async settings from a KEY=VALUE file, with the keys and defaults of
+    // config/config.txt (LOG_ASYNC, LOG_RING_CAPACITY, LOG_OVERFLOW_POLICY).
+    // Without the file or LOG_ASYNC=true, logging stays synchronous
+    static void configureFromFile(const string& path) {
+        ifstream file(path);
+        map<string, string> settings;
+        string line;
+        while (getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            size_t eq = line.find('=');
+            if (eq == string::npos) continue;
+            string key = line.substr(0, eq), value = line.substr(eq + 1);
+            key.erase(key.find_last_not_of(" \t") + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t\r") + 1);
+            settings[key] = value;
+        }
+        string async = settings["LOG_ASYNC"];
+        transform(async.begin(), async.end(), async.begin(), ::tolower);
+        if (async != "true" && async != "yes" && async != "1") return;
+        unsigned long capacity = strtoul(settings["LOG_RING_CAPACITY"].c_str(), nullptr, 10);
+        enableAsync(capacity > 0 ? capacity : 4096,
+                    settings["LOG_OVERFLOW_POLICY"] == "BLOCK" ? LogOverflowPolicy::BLOCK : LogOverflowPolicy::DROP);
+    }
+
+    // Block until everything queued before the call is written
+    static void flush() {
+        if (!asyncEnabled.load(memory_order_acquire)) {
+            cout.flush();
+            if (logFile.is_open()) logFile.flush();
+            return;
+        }
+        unique_lock<mutex> lock(wakeMutex);
+        uint64_t target = ++flushRequested;
+        wakeCv.notify_one();
+        flushedCv.wait(lock, [target] { return flushCompleted >= target || stopRequested; });
+    }
+
+    // Drain the rings, stop the writer and return to synchronous logging
+    static void shutdown() {
+        if (!asyncEnabled.exchange(false)) return;
+        // Later messages go out synchronously; pushes under way finish while
+        // the writer still drains, so its final pass sees all of them
+        vector<shared_ptr<LogRing>> live;
+        {
+            lock_guard<mutex> lock(registryMutex);
+            live = rings;
+        }
+        for (const auto& ring : live) {
+            while (ring->pushing.load()) this_thread::yield();
+        }
+        {
+            lock_guard<mutex> lock(wakeMutex);
+            stopRequested = true;
+        }
+        wakeCv.notify_all();
+        if (writerThread.joinable()) writerThread.join();
+        {
+            lock_guard<mutex> lock(registryMutex);
+            rings.clear();
+        }
+        if (fileFd >= 0) {
+            ::close(fileFd);
+            fileFd = -1;
+        }
+        size_t dropped = droppedCount.load();
+        if (dropped > 0) {
+            log(LogLevel::WARNING, to_string(dropped) + " log messages dropped while async");
+        }
+    }
+
+    static size_t getDroppedCount() { return droppedCount.load(memory_order_relaxed); }
 };
+// Level-checked logging: arguments are evaluated only when the level is enabled.
+// CORE_LOG_MIN_LEVEL (0=DEBUG..3=ERROR) removes lower levels at compile time;
+// release builds (-DNDEBUG) drop DEBUG by default.
+#ifndef CORE_LOG_MIN_LEVEL
+#  ifdef NDEBUG
+#    define CORE_LOG_MIN_LEVEL 1
+#  else
+#    define CORE_LOG_MIN_LEVEL 0
+#  endif
+#endif
+#define CORE_LOGF(level, ...)                                                   \
+    do {                                                                        \
+        if constexpr (static_cast<int>(level) >= CORE_LOG_MIN_LEVEL) {          \
+            if (Core::Logger::isEnabled(level)) {                               \
+                Core::Logger::log(level, Core::Logger::concat(__VA_ARGS__));    \
+            }                                                                   \
+        }                                                                       \
+    } while (0)
+
 ofstream Logger::logFile;
+string Logger::logPath = "restaurant.log";
 LogLevel Logger::currentLevel = LogLevel::INFO;
+atomic<bool> Logger::asyncEnabled{false};
+atomic<unsigned> Logger::asyncGeneration{0};
+atomic<size_t> Logger::droppedCount{0};
+size_t Logger::ringCapacity = 4096;
+LogOverflowPolicy Logger::overflowPolicy = LogOverflowPolicy::DROP;
+mutex Logger::syncMutex;
+mutex Logger::registryMutex;
+vector<shared_ptr<LogRing>> Logger::rings;
+mutex Logger::wakeMutex;
+condition_variable Logger::wakeCv;
+condition_variable Logger::flushedCv;
+bool Logger::stopRequested = false;
+uint64_t Logger::flushRequested = 0;
+uint64_t Logger::flushCompleted = 0;
+thread Logger::writerThread;
+int Logger::fileFd = -1;
 
 // Validation utilities
 class Validator {
@@ -218,11 +536,15 @@ public:
         }
     }
     
-    static string stateToString(OrderState s) {
-        const string names[] = {"Created", "Confirmed", "Preparing", "Ready", "Served", "Cancelled", "Refunded"};
+    static const char* stateName(OrderState s) {
+        static const char* const names[] = {"Created", "Confirmed", "Preparing", "Ready", "Served", "Cancelled", "Refunded"};
         return names[static_cast<int>(s)];
     }
     
+    static string stateToString(OrderState s) {
+        return stateName(s);
+    }
+    
     static OrderState stringToState(const string& s) {
         if (s == "Created") return Domain::OrderState::CREATED;
         if (s == "Confirmed") return Domain::OrderState::CONFIRMED;
@@ -275,13 +597,13 @@ struct Order
     bool tryUpdateStatus(OrderState newState) {
         if (Domain::OrderFlowManager::canTransition(this->status, newState)) {
             this->status = newState;
-            Core::Logger::log(Core::LogLevel::INFO, "Order " + to_string(orderId) + 
-                " transitioned to " + Domain::OrderFlowManager::stateToString(newState));
+            CORE_LOGF(Core::LogLevel::INFO, "Order ", orderId,
+                " transitioned to ", Domain::OrderFlowManager::stateName(newState));
             return true;
         }
-        Core::Logger::log(Core::LogLevel::WARNING, "Invalid state transition for order " + 
-            to_string(orderId) + ": " + Domain::OrderFlowManager::stateToString(this->status) + 
-            " -> " + Domain::OrderFlowManager::stateToString(newState));
+        CORE_LOGF(Core::LogLevel::WARNING, "Invalid state transition for order ",
+            orderId, ": ", Domain::OrderFlowManager::stateName(this->status),
+            " -> ", Domain::OrderFlowManager::stateName(newState));
         return false;
     }
     
@@ -2907,6 +3229,9 @@ public:
         kitchenTail = nullptr;
         
         Core::Logger::log(Core::LogLevel::INFO, "System cleanup completed successfully.");
+        
+        // Drain async log rings before the process exits
+        Core::Logger::shutdown();
     }
     
 private:
@@ -2926,6 +3251,7 @@ private:
 
 int main() {
     Core::Logger::initialize();
+    Core::Logger::configureFromFile("config/config.txt");   // Optional async logging
     
     // Display system banner
     cout << "\n";
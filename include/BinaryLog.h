@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include "Common.h"
+
+/**
+ * Binary Structured Log Format
+ * Call sites register a format string once ("Order {} transitioned to {}");
+ * at runtime only the format ID, a timestamp and the raw arguments are written.
+ * tools/logdecode turns a binary log back into the Logger text format.
+ *
+ * File layout (host byte order, varints are LEB128):
+ *   header  : "RMSBLOG1"
+ *   FORMAT  : u8 kind=1, u16 id, u8 level, u16 len, len bytes
+ *   RECORD  : u8 kind=2, u16 id, varint nanos-since-previous-record, u8 argc, args...
+ *   arg     : u8 'i' + zigzag varint | u8 'd' + f64 | u8 's' + varint len + bytes
+ * Each session appends a fresh header, which restarts the format IDs and
+ * the timestamp deltas; decode() handles one mid-stream the same way
+ */
+namespace BinaryLog {
+
+constexpr char MAGIC[8] = {'R', 'M', 'S', 'B', 'L', 'O', 'G', '1'};
+
+enum RecordKind : std::uint8_t { FORMAT_DEF = 1, RECORD = 2 };
+enum ArgType : std::uint8_t { ARG_INT = 'i', ARG_DOUBLE = 'd', ARG_STRING = 's' };
+
+template <typename T>
+inline void put(std::string& out, T value) {
+    char raw[sizeof(T)];
+    std::memcpy(raw, &value, sizeof(T));
+    out.append(raw, sizeof(T));
+}
+
+inline void putVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline bool getVarint(const char* data, std::size_t size, std::size_t& pos, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        const auto byte = static_cast<std::uint8_t>(data[pos++]);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline std::uint64_t zigzag(std::int64_t v) {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t v) {
+    return static_cast<std::int64_t>((v >> 1) ^ (~(v & 1) + 1));
+}
+
+// FNV-1a over a record body; catches torn writes in the mmap'd logs
+inline std::uint32_t checksum(const char* data, std::size_t size) {
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<std::uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Checksummed record framing shared by the mmap'd logs
+ *   frame : u32 body length, u32 checksum of body, body
+ * The length is written last, so a torn frame reads as length 0 or fails its checksum
+ */
+constexpr std::size_t FRAME_HEADER = 2 * sizeof(std::uint32_t);
+
+inline void writeFrame(char* base, std::size_t& offset, const std::string& body) {
+    char* frame = base + offset;
+    const auto len = static_cast<std::uint32_t>(body.size());
+    const std::uint32_t sum = checksum(body.data(), body.size());
+    std::memcpy(frame + FRAME_HEADER, body.data(), body.size());
+    std::memcpy(frame + sizeof(len), &sum, sizeof(sum));
+    std::memcpy(frame, &len, sizeof(len));
+    offset += FRAME_HEADER + body.size();
+}
+
+// Same frame built in a buffer, for logs written with write() instead of a mapping
+inline void appendFrame(std::string& out, const std::string& body) {
+    put<std::uint32_t>(out, static_cast<std::uint32_t>(body.size()));
+    put<std::uint32_t>(out, checksum(body.data(), body.size()));
+    out += body;
+}
+
+/**
+ * Walk intact frames in [pos, limit); calls fn(body, len) until it returns false
+ * Returns the offset just past the last intact frame
+ */
+template <typename Fn>
+std::size_t scanFrames(const char* data, std::size_t pos, std::size_t limit, Fn&& fn) {
+    while (pos + FRAME_HEADER <= limit) {
+        std::uint32_t len, sum;
+        std::memcpy(&len, data + pos, sizeof(len));
+        std::memcpy(&sum, data + pos + sizeof(len), sizeof(sum));
+        if (len == 0 || pos + FRAME_HEADER + len > limit) break;
+        const char* body = data + pos + FRAME_HEADER;
+        if (checksum(body, len) != sum) break;   // Torn write
+        if (!fn(body, len)) break;
+        pos += FRAME_HEADER + len;
+    }
+    return pos;
+}
+
+inline void encodeString(std::string& out, const char* s, std::size_t len) {
+    out += static_cast<char>(ARG_STRING);
+    putVarint(out, len);
+    out.append(s, len);
+}
+
+inline void encodeArg(std::string& out, const std::string& s) { encodeString(out, s.data(), s.size()); }
+inline void encodeArg(std::string& out, const char* s) { encodeString(out, s, std::strlen(s)); }
+
+template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+inline void encodeArg(std::string& out, T value) {
+    if constexpr (std::is_floating_point<T>::value) {
+        out += static_cast<char>(ARG_DOUBLE);
+        put<double>(out, static_cast<double>(value));
+    } else {
+        const auto v = static_cast<std::int64_t>(value);
+        out += static_cast<char>(ARG_INT);
+        putVarint(out, zigzag(v));
+    }
+}
+
+/**
+ * Substitute encoded args into `{}` placeholders (text rendering of a record)
+ * Returns false if the payload is truncated or malformed
+ */
+bool render(const std::string& format, const char* payload, std::size_t size,
+            std::uint8_t argc, std::string& out, std::size_t* consumed = nullptr);
+
+/**
+ * Decode a whole binary log into Logger's text layout
+ * Returns the number of records written, or -1 on a bad header
+ */
+long decode(std::istream& in, std::ostream& out);
+
+} // namespace BinaryLog
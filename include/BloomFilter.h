@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Blocked Counting Bloom Filter
+ * Keyed by a 64-bit hash, re-mixed here so callers may reuse bits they
+ * already spent elsewhere (e.g. shard selection). Each key maps to one 64-byte block
+ * of 8-bit counters and sets k counters inside it, so a lookup reads a
+ * single cache line. Counters make remove() possible, so the filter
+ * follows expiry instead of filling up
+ *
+ * mayContain() is lock-free and may run next to writers; add() and
+ * remove() must be serialized by the owner. A counter that reaches 255
+ * sticks there (it can only cost false positives, never false negatives)
+ */
+class CountingBloomFilter {
+public:
+    static constexpr std::size_t BLOCK_COUNTERS = 64;
+
+private:
+    struct alignas(64) Block {
+        std::atomic<std::uint8_t> counters[BLOCK_COUNTERS];
+    };
+
+    std::unique_ptr<Block[]> blocks;
+    std::size_t blockCount;
+    unsigned hashCount;
+
+    static std::uint64_t mix(std::uint64_t h) {
+        h ^= h >> 31;
+        h *= 0xbf58476d1ce4e5b9ull;
+        return h ^ (h >> 29);
+    }
+    Block& blockFor(std::uint64_t mixed) const {
+        // Multiply-shift range reduction on the high half
+        return blocks[static_cast<std::size_t>(((mixed >> 32) * blockCount) >> 32)];
+    }
+    // Probe bits come from a second multiply so they are independent of the block
+    static unsigned position(std::uint64_t bits, unsigned i) {
+        return static_cast<unsigned>((bits >> (6 * i)) & (BLOCK_COUNTERS - 1));
+    }
+
+public:
+    /**
+     * Size for `expectedKeys` live keys at roughly `falsePositiveRate`
+     */
+    CountingBloomFilter(std::size_t expectedKeys, double falsePositiveRate) {
+        if (expectedKeys == 0) expectedKeys = 1;
+        if (falsePositiveRate <= 0.0 || falsePositiveRate >= 1.0) falsePositiveRate = 0.01;
+        const double ln2 = std::log(2.0);
+        const double counters = -static_cast<double>(expectedKeys) * std::log(falsePositiveRate) / (ln2 * ln2);
+        // Blocking skews load across blocks; 25% headroom brings it back to the target rate
+        blockCount = static_cast<std::size_t>(std::ceil(1.25 * counters / BLOCK_COUNTERS));
+        if (blockCount == 0) blockCount = 1;
+        const double k = std::round(-std::log2(falsePositiveRate));
+        hashCount = static_cast<unsigned>(k < 1 ? 1 : (k > 6 ? 6 : k));   // 6 bits per probe
+        blocks.reset(new Block[blockCount]);
+        for (std::size_t b = 0; b < blockCount; ++b) {
+            for (auto& c : blocks[b].counters) c.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(std::uint64_t hash) {
+        hash = mix(hash);
+        Block& block = blockFor(hash);
+        const std::uint64_t bits = hash * 0x9e3779b97f4a7c15ull;
+        for (unsigned i = 0; i < hashCount; ++i) {
+            std::atomic<std::uint8_t>& c = block.counters[position(bits, i)];
+            const std::uint8_t v = c.load(std::memory_order_relaxed);
+            if (v != 0xFF) c.store(v + 1, std::memory_order_relaxed);
+        }
+    }
+
+    void remove(std::uint64_t hash) {
+        hash = mix(hash);
+        Block& block = blockFor(hash);
+        const std::uint64_t bits = hash * 0x9e3779b97f4a7c15ull;
+        for (unsigned i = 0; i < hashCount; ++i) {
+            std::atomic<std::uint8_t>& c = block.counters[position(bits, i)];
+            const std::uint8_t v = c.load(std::memory_order_relaxed);
+            if (v != 0 && v != 0xFF) c.store(v - 1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * false means the key was definitely never added (or has been removed)
+     */
+    bool mayContain(std::uint64_t hash) const {
+        hash = mix(hash);
+        const Block& block = blockFor(hash);
+        const std::uint64_t bits = hash * 0x9e3779b97f4a7c15ull;
+        for (unsigned i = 0; i < hashCount; ++i) {
+            if (block.counters[position(bits, i)].load(std::memory_order_relaxed) == 0) return false;
+        }
+        return true;
+    }
+
+    std::size_t memoryBytes() const { return blockCount * sizeof(Block); }
+    unsigned probes() const { return hashCount; }
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "StorageStrategy.h"
+
+struct StorageCacheOptions {
+    enum class Durability {
+        SYNC_ON_COMMIT,   // A save returns once its batch reached the backend (group commit)
+        PERIODIC          // A save returns at once; batches go out every flushInterval
+    };
+
+    Durability durability = Durability::PERIODIC;
+    std::chrono::milliseconds flushInterval{100};
+    std::size_t capacity = 100000;   // Records per table; clean ones beyond this are evicted (LRU)
+    std::size_t maxDirty = 10000;    // PERIODIC: flush early at this many, writers wait past twice it
+};
+
+struct StorageCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t flushes = 0;
+    std::uint64_t flushedRecords = 0;
+    std::uint64_t flushFailures = 0;
+    double lastFlushMs = 0.0;
+    double maxFlushMs = 0.0;
+    double totalFlushMs = 0.0;
+    std::size_t cachedRecords = 0;
+    std::size_t dirtyRecords = 0;
+
+    double hitRatio() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+    double meanFlushMs() const { return flushes ? totalFlushMs / flushes : 0.0; }
+};
+
+/**
+ * @class CachingStorageStrategy
+ * @brief Write-behind cache around any StorageStrategy (Decorator)
+ *
+ * Point loads are served from a per-table hash map (LRU beyond capacity;
+ * misses, including "not found", are filled from the backend). Saves only
+ * update the map and mark the ID dirty; one background thread writes the
+ * dirty records out with the backend's batch save and then flushes the
+ * backend. Each ID is written once per batch with its latest state, and
+ * stays pinned in memory until that write lands, so a load never sees the
+ * backend's older version.
+ *
+ * Durability is either group commit (saves wait for their batch) or a
+ * flush every flushInterval. Deletes, bulk loads and scans flush first,
+ * then go to the backend. A failed batch stays dirty and is retried
+ */
+class CachingStorageStrategy : public StorageStrategy {
+public:
+    explicit CachingStorageStrategy(std::unique_ptr<StorageStrategy> backend,
+                                    const StorageCacheOptions& options = StorageCacheOptions());
+    ~CachingStorageStrategy() override;
+
+    // Customers
+    bool saveCustomer(const CustomerRecord& customer) override;
+    CustomerRecord loadCustomer(int id) override;
+    std::vector<CustomerRecord> loadAllCustomers() override;
+    bool deleteCustomer(int id) override;
+
+    // Menu Items
+    bool saveMenuItem(const MenuItem& item) override;
+    MenuItem loadMenuItem(int id) override;
+    std::vector<MenuItem> loadAllMenuItems() override;
+    bool deleteMenuItem(int id) override;
+
+    // Orders
+    bool saveOrder(const Order& order) override;
+    Order loadOrder(int id) override;
+    std::vector<Order> loadAllOrders() override;
+    bool deleteOrder(int id) override;
+
+    bool saveCustomers(const CustomerRecord* customers, std::size_t count) override;
+    bool saveMenuItems(const MenuItem* items, std::size_t count) override;
+    bool saveOrders(const Order* orders, std::size_t count) override;
+
+    std::size_t forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                const RecordVisitor<CustomerRecord>& visitor) override;
+    std::size_t forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                const RecordVisitor<MenuItem>& visitor) override;
+    std::size_t forEachOrder(const RecordPredicate<Order>& predicate,
+                             const RecordVisitor<Order>& visitor) override;
+
+    // Write every dirty record to the backend now and wait for it
+    bool flush() override;
+
+    // Diagnostic
+    std::string getName() const override { return backend->getName() + " (cached)"; }
+    bool isHealthy() override;
+
+    StorageCacheStats getStats() const;
+    StorageStrategy& getBackend() { return *backend; }
+
+private:
+    template <typename Record>
+    struct Table {
+        struct Slot {
+            Record record{};
+            bool missing = false;    // Not in the backend either
+            bool dirty = false;      // Not yet written to the backend
+            bool queued = false;     // Listed in dirtyIds
+            std::uint64_t version = 0;
+            std::list<int>::iterator recent;
+        };
+        std::unordered_map<int, Slot> slots;
+        std::list<int> lru;          // Most recent first
+        std::vector<int> dirtyIds;
+        std::uint64_t evictions = 0;
+    };
+
+    // One table's dirty records, copied out for a batch write
+    template <typename Record>
+    struct Batch {
+        std::vector<Record> saves;
+        std::vector<std::pair<int, std::uint64_t>> versions;
+    };
+
+    template <typename Record>
+    bool put(Table<Record>& table, const Record* records, std::size_t count);
+    template <typename Record>
+    bool erase(Table<Record>& table, int id);
+    template <typename Record, typename Load>
+    Record get(Table<Record>& table, int id, Load&& load);
+    template <typename Record>
+    typename Table<Record>::Slot& slotFor(Table<Record>& table, int id);
+    template <typename Record>
+    void markDirty(Table<Record>& table, int id, typename Table<Record>::Slot& slot, std::uint64_t seq);
+    template <typename Record>
+    void evict(Table<Record>& table);
+    template <typename Record>
+    void collect(Table<Record>& table, Batch<Record>& batch);
+    template <typename Record>
+    void settle(Table<Record>& table, const Batch<Record>& batch, bool ok);
+    template <typename Record>
+    bool writeBatch(const Batch<Record>& batch);
+
+    std::uint64_t admit(std::unique_lock<std::mutex>& lock);
+    bool commit(std::unique_lock<std::mutex>& lock, std::uint64_t seq);
+    bool flushOnce();
+    void backgroundLoop();
+    std::size_t dirtyCount() const;
+
+    std::unique_ptr<StorageStrategy> backend;
+    StorageCacheOptions options;
+
+    mutable std::mutex mutex;
+    std::condition_variable workCv;    // Flusher: dirty records or stop
+    std::condition_variable doneCv;    // Writers: a batch finished
+    Table<CustomerRecord> customers;
+    Table<MenuItem> menuItems;
+    Table<Order> orders;
+    std::uint64_t writeSeq = 0;        // Writes absorbed so far
+    std::uint64_t flushedSeq = 0;      // Writes known to be in the backend
+    std::uint64_t failedSeq = 0;       // Writes whose batch last failed
+    bool flushRequested = false;
+    bool stopping = false;
+    StorageCacheStats stats;
+
+    std::mutex flushMutex;             // One batch at a time
+    std::thread background;
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CsvIndex.h"
+#include "CsvReader.h"
+
+struct CsvCompactionOptions {
+    std::chrono::milliseconds interval{60000};   // How often the background thread checks the files
+    std::uint64_t minBytes = 1024 * 1024;        // Smaller files are left alone
+    double growthFactor = 2.0;                   // Rewrite once a file is this much larger than after its last rewrite
+    std::uint64_t bytesPerSecond = 16 * 1024 * 1024;   // Read + write budget; 0 = unlimited
+    std::time_t retentionSeconds = 30 * 24 * 3600;     // Keep soft-deleted rows this long
+};
+
+struct CsvCompactionStats {
+    std::uint64_t compactions = 0;
+    std::uint64_t rowsKept = 0;
+    std::uint64_t rowsDropped = 0;    // Older versions, expired soft deletes, rows without an ID
+    std::uint64_t bytesReclaimed = 0;
+};
+
+/**
+ * Background Compaction for append-only CSV data files
+ * Every save appends a row, so a file holds every version of every ID.
+ * A rewrite keeps only the latest row per ID, in file order, and drops
+ * rows the file's `expired` rule reports as soft-deleted past the
+ * retention horizon, then CsvIndex::replaceData swaps it in with a
+ * rename (rows saved meanwhile are carried over).
+ *
+ * The rewrite reads the file twice (latest offset per ID, then the copy)
+ * through CsvReader::streamRows and paces reads and writes to
+ * bytesPerSecond, so foreground loads and saves keep the disk. The
+ * background thread rewrites one file per wake-up, and only files that
+ * passed minBytes and grew by growthFactor since their last rewrite
+ */
+class CsvCompactor {
+public:
+    // true if a row is a soft-deleted record older than `horizon`
+    using ExpiredFn = std::function<bool(const CsvRow& row, std::time_t horizon)>;
+
+    explicit CsvCompactor(const CsvCompactionOptions& options = CsvCompactionOptions());
+    ~CsvCompactor();
+    CsvCompactor(const CsvCompactor&) = delete;
+    CsvCompactor& operator=(const CsvCompactor&) = delete;
+
+    // Register a data file (through its index, which owns its writes); before start()
+    void addFile(CsvIndex& index, ExpiredFn expired = nullptr);
+
+    void start();
+    // Stop the background thread, abandoning a rewrite in progress
+    void stop();
+
+    /**
+     * Rewrite every registered file now, whatever its size, on the
+     * calling thread (still paced)
+     */
+    bool compactAll();
+
+    CsvCompactionStats getStats() const;
+
+private:
+    struct File {
+        CsvIndex* index;
+        ExpiredFn expired;
+        std::uint64_t compactedBytes = 0;   // Size right after the last rewrite
+    };
+
+    bool compact(File& file);
+    bool pace(std::uint64_t bytes);   // false once stop() was called
+    void backgroundLoop();
+
+    CsvCompactionOptions options;
+    std::vector<File> files;
+    std::size_t nextFile = 0;
+
+    std::mutex compactionMutex;   // One rewrite at a time
+    std::chrono::steady_clock::time_point paceStart;
+    std::uint64_t pacedBytes = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeCv;
+    bool stopping = false;
+    std::thread background;
+    CsvCompactionStats stats;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.h"
+
+class CsvReader;
+
+/**
+ * When buffered CSV rows reach the data file (see CsvIndex::append)
+ */
+struct CsvWritePolicy {
+    std::size_t bufferBytes = 64 * 1024;   // Flush once this much is pending
+    bool flushEachCall = true;             // Storage flushes at the end of every save call
+    bool syncOnFlush = false;              // fdatasync data and index after each flush
+};
+
+/**
+ * Sidecar Primary-Key Index for a CSV data file
+ * Maps the numeric ID in column 0 to the byte range of its latest row, so
+ * a point load is one pread plus one line parse instead of a file scan.
+ * Stored next to the data file as "<data>.idx" (host byte order):
+ *   header : "RMSIDX01", u64 data bytes covered, u64 sorted entry count
+ *   entry  : i32 id, u32 row length, u64 row offset
+ * Entries [0, sorted) are sorted by ID with one entry per ID and are read
+ * through a read-only mapping (binary search). Rows appended since then
+ * follow unsorted and are also held in memory; once that tail passes
+ * max(MERGE_MIN, sorted / 8) entries it is merged into a new sorted file.
+ *
+ * The covered size is stored at merges, synced flushes and close; after
+ * a crash the rows past it are simply indexed again.
+ * Every call first compares the data file size with the covered size:
+ * rows appended by someone else are indexed incrementally, and a shrunken
+ * or replaced file (or an entry that no longer points at its ID) triggers
+ * a full rebuild.
+ *
+ * The index is also the file's writer: append() buffers rows on a data
+ * handle kept open across calls, and a flush writes them with one write()
+ * and their entries with one pwrite(). Lookups flush first. Thread-safe
+ */
+class CsvIndex {
+public:
+    static constexpr std::size_t MERGE_MIN = 4096;
+
+    explicit CsvIndex(std::string dataPath);
+    ~CsvIndex();
+    CsvIndex(const CsvIndex&) = delete;
+    CsvIndex& operator=(const CsvIndex&) = delete;
+
+    void setWritePolicy(const CsvWritePolicy& policy);
+
+    /**
+     * Buffer `line` (no trailing newline) for the data file under `id`;
+     * flushes once the buffer passes policy.bufferBytes
+     */
+    bool append(int id, std::string_view line);
+
+    // Write buffered rows and their entries (fdatasync per policy); rows
+    // that do not reach the data file stay buffered for the next flush
+    bool flush();
+
+    // Flush, and report the data file's size once every row is in it
+    bool flush(std::uint64_t& dataBytes);
+
+    /**
+     * Latest row stored for `id`; false if there is none
+     */
+    bool find(int id, std::string& line);
+
+    /**
+     * Open `reader` on the data file and list where each ID's latest row
+     * starts in it (ascending), both under the lock so they describe the
+     * same file; false if nothing is stored
+     */
+    bool openLatest(CsvReader& reader, std::vector<std::uint64_t>& offsets);
+
+    /**
+     * Re-index the whole data file
+     */
+    bool rebuild();
+
+    /**
+     * Swap in `replacementPath`, a rewrite of the data file's first
+     * `rewrittenBytes` bytes: rows written since then are copied onto its
+     * end, it is synced and renamed over the data file, and the index is
+     * switched to it. Most rows are copied and indexed before the lock
+     * is taken, so writers wait only for the last few rows and the index
+     * write. The replacement is removed if the swap fails
+     */
+    bool replaceData(const std::string& replacementPath, std::uint64_t rewrittenBytes);
+
+    std::size_t getEntryCount() const;
+    const std::string& getIndexPath() const { return indexPath; }
+    const std::string& getDataPath() const { return dataPath; }
+
+private:
+    struct Entry {
+        std::int32_t id;
+        std::uint32_t length;   // Bytes up to the next row, newline included
+        std::uint64_t offset;
+    };
+
+    static void keepLatest(std::vector<Entry>& entries);
+    static void scanEntries(const std::string& path, std::vector<Entry>& entries, std::uint64_t& dataBytes);
+    bool ensureOpen();
+    bool load();
+    bool reindex();
+    bool reconcile(std::uint64_t dataBytes);
+    bool catchUp(std::uint64_t dataBytes);
+    bool addEntries(const Entry* entries, std::size_t count);
+    bool openData(std::uint64_t& dataBytes);
+    bool saveCovered();
+    bool flushPending();
+    void dropWritten(std::uint64_t base, std::size_t written);
+    bool writeIndex(std::vector<Entry>& entries, std::uint64_t coveredBytes);
+    bool mergeTail();
+    const Entry* lookup(int id) const;
+    bool readRow(const Entry& entry, int id, std::string& line) const;
+    void closeIndex();
+
+    const std::string dataPath;
+    const std::string indexPath;
+
+    mutable std::mutex mutex;
+    bool ready = false;
+    int fd = -1;                 // Index file, for appends and header updates
+    MappedFile sorted;           // Read-only view of the sorted section
+    std::uint64_t sortedCount = 0;
+    std::uint64_t entryCount = 0;
+    std::uint64_t covered = 0;   // Data file bytes reflected in the index
+    std::unordered_map<int, Entry> tail;
+
+    CsvWritePolicy policy;
+    int dataFd = -1;
+    std::string pending;                  // Rows not yet written
+    std::vector<Entry> pendingEntries;    // Offsets relative to `pending`
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include "MappedFile.h"
+
+/**
+ * One parsed CSV line; fields point into the reader's mapping and are
+ * only valid while the reader stays open
+ */
+struct CsvRow {
+    static constexpr std::size_t MAX_FIELDS = 16;   // Extra fields are dropped
+
+    std::string_view fields[MAX_FIELDS];
+    std::size_t count = 0;
+    std::size_t offset = 0;   // Byte offset of the line in the file
+
+    std::string_view operator[](std::size_t i) const {
+        return i < count ? fields[i] : std::string_view();
+    }
+
+    std::string str(std::size_t i) const { return std::string((*this)[i]); }
+
+    /**
+     * Parse field i as a number (std::from_chars); leaves `out` untouched
+     * and returns false if the field is missing or malformed
+     */
+    template <typename T>
+    bool get(std::size_t i, T& out) const {
+        const std::string_view field = (*this)[i];
+        if (field.empty()) return false;
+        T value;
+        const auto res = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (res.ec != std::errc() || res.ptr != field.data() + field.size()) return false;
+        out = value;
+        return true;
+    }
+};
+
+/**
+ * Zero-Copy CSV Reader
+ * Maps a storage data file read-only and splits it into string_view
+ * fields without copying; ',' and '\n' are located 16 bytes at a time
+ * (SSE2) with a scalar tail. Values are never quoted in these files.
+ * Empty lines are skipped and a trailing '\r' is dropped
+ */
+class CsvReader {
+public:
+    static constexpr std::size_t STREAM_WINDOW = 8 * 1024 * 1024;   // streamRows releases pages this often
+
+    /**
+     * Map `path`; false (without logging) if it is missing or empty
+     */
+    bool open(const std::string& path);
+    void close() { file.close(); }
+    bool isOpen() const { return file.isOpen(); }
+    std::size_t size() const { return file.size(); }
+    const char* data() const { return file.data(); }
+
+    /**
+     * Call fn(const CsvRow&) for each line starting at byte `from`;
+     * fn returns false to stop. Returns the number of rows visited
+     */
+    template <typename Fn>
+    std::size_t forEachRow(Fn&& fn, std::size_t from = 0) const {
+        if (!file.isOpen() || from >= file.size()) return 0;
+        const char* const begin = file.data();
+        const char* const end = begin + file.size();
+        const char* line = begin + from;
+        CsvRow row;
+        std::size_t rows = 0;
+        while (line < end) {
+            const char* next = splitLine(line, end, row);
+            row.offset = static_cast<std::size_t>(line - begin);
+            line = next;
+            if (row.count == 1 && row[0].empty()) continue;   // Blank line
+            ++rows;
+            if (!fn(static_cast<const CsvRow&>(row))) break;
+        }
+        return rows;
+    }
+
+    /**
+     * forEachRow for one pass over files of any size: reads ahead
+     * sequentially and drops the pages behind the cursor every
+     * STREAM_WINDOW bytes, so resident memory stays flat
+     */
+    template <typename Fn>
+    std::size_t streamRows(Fn&& fn, std::size_t from = 0) const {
+        file.adviseSequential();
+        std::size_t released = from;
+        return forEachRow([&](const CsvRow& row) {
+            if (row.offset - released >= STREAM_WINDOW) {
+                file.release(released, row.offset - released);
+                released = row.offset;
+            }
+            return fn(row);
+        }, from);
+    }
+
+    /**
+     * Parse the single line starting at `offset`
+     */
+    bool readRow(std::size_t offset, CsvRow& row) const;
+
+    /**
+     * Split one line in [line, end) into row; returns the start of the next line
+     */
+    static const char* splitLine(const char* line, const char* end, CsvRow& row);
+
+private:
+    MappedFile file;
+};
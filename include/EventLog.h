@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EventSystem.h"
+#include "MappedFile.h"
+
+/**
+ * Persistent Event Log
+ * Optional durable sink for the EventBus: every emitted Event is appended,
+ * in emit order and with a sequence number, to memory-mapped segment files.
+ * A committer thread msyncs whatever was appended since the last commit
+ * (group commit), so emit() never waits for the disk.
+ * replay() streams events from any sequence number back into the bus to
+ * rebuild read models after a restart.
+ *
+ * Segment layout (data/eventlog/events-<first seq>.log, host byte order):
+ *   header : "RMSEVT01", u64 first sequence
+ *   record : u32 body length, u32 FNV-1a of body, body
+ *   event  : u8 type, u8 entityType, varint source, zigzag varint entityId,
+ *            zigzag varint timestamp, u8 payload index, payload fields
+ *   source : u8 0xFF, u16 source ID, name bytes (precedes the first event
+ *            of the segment that uses that ID; not sequenced)
+ * A zero length marks the end of written data; a record whose checksum
+ * does not match (torn write) ends recovery for that segment.
+ * Each open() starts a new segment after the last intact event
+ */
+class EventLog : public EventListener {
+public:
+    static EventLog& getInstance();
+
+    /**
+     * Open (or recover) the log in `directory`; sequence numbers continue
+     * after the last intact event. groupCommitMs is the longest an appended event
+     * waits before it is synced
+     */
+    bool open(const std::string& directory,
+              std::size_t segmentBytes = 16 * 1024 * 1024,
+              int groupCommitMs = 5);
+
+    // Sync everything, stop the committer and unmap
+    void close();
+    bool isOpen() const;
+
+    // EventBus sink (subscribe SYNC so log order is emit order)
+    void onEvent(const Event& event) override;
+    std::string getName() const override { return "EventLog"; }
+
+    /**
+     * Append one event; returns its sequence number (0 if the log is closed)
+     */
+    std::uint64_t append(const Event& event);
+
+    /**
+     * Block until every event appended before the call is on disk
+     */
+    void sync();
+
+    std::uint64_t getLastSequence() const;
+    std::uint64_t getDurableSequence() const;
+
+    /**
+     * Stream events with sequence >= fromSequence, oldest first
+     * Returns the number of events delivered. Events replayed into the bus
+     * are not appended to the log again
+     */
+    std::size_t replay(std::uint64_t fromSequence, EventBus& bus);
+    std::size_t replay(std::uint64_t fromSequence,
+                       const std::function<void(std::uint64_t, const Event&)>& visitor);
+
+private:
+    EventLog() = default;
+    ~EventLog() override;
+
+    bool openSegment(std::uint64_t firstSequence);
+    bool recoverSegment(const std::string& path);
+    void committerLoop();
+
+    mutable std::mutex appendMutex;
+    std::string directory;
+    std::size_t segmentBytes = 0;
+    int groupCommitMs = 5;
+
+    // Part of a segment the committer still has to msync
+    struct SyncRange {
+        std::shared_ptr<MappedFile> file;
+        std::size_t from;
+        std::size_t to;
+    };
+
+    std::shared_ptr<MappedFile> active;   // Shared with an in-flight commit
+    std::size_t writeOffset = 0;
+    std::size_t syncedOffset = 0;
+    std::vector<SyncRange> sealed;        // Unsynced tails of rolled-over segments
+    std::uint64_t nextSequence = 1;
+    std::vector<bool> sourcesDefined;     // Source IDs already defined in the active segment
+
+    std::atomic<std::uint64_t> durableSequence{0};
+    std::condition_variable commitCv;     // Wakes the committer
+    std::condition_variable durableCv;    // Wakes sync() callers
+    bool commitRequested = false;
+    bool stopping = false;
+    std::thread committer;
+};
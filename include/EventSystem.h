@@ -1,5 +1,17 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <variant>
 #include <vector>
 #include <ctime>
 
@@ -9,7 +21,7 @@
  * Decouples order service from logging, analytics, audit trail
  */
 
-enum class EventType {
+enum class EventType : std::uint8_t {
     ORDER_PLACED,
     ORDER_CONFIRMED,
     ORDER_PREPARING,
@@ -25,15 +37,114 @@ enum class EventType {
     REFUND_ISSUED
 };
 
+constexpr std::size_t EVENT_TYPE_COUNT = static_cast<std::size_t>(EventType::REFUND_ISSUED) + 1;
+
+// Indexed by EventType; keep in enum order
+constexpr const char* EVENT_TYPE_NAMES[EVENT_TYPE_COUNT] = {
+    "ORDER_PLACED",
+    "ORDER_CONFIRMED",
+    "ORDER_PREPARING",
+    "ORDER_READY",
+    "ORDER_SERVED",
+    "ORDER_CANCELLED",
+    "ORDER_REFUNDED",
+    "INVENTORY_UPDATED",
+    "INVENTORY_LOW",
+    "CUSTOMER_CREATED",
+    "CUSTOMER_DELETED",
+    "PAYMENT_PROCESSED",
+    "REFUND_ISSUED"
+};
+
+constexpr const char* eventTypeName(EventType type) {
+    return static_cast<std::size_t>(type) < EVENT_TYPE_COUNT
+        ? EVENT_TYPE_NAMES[static_cast<std::size_t>(type)] : "UNKNOWN";
+}
+
+/**
+ * What kind of entity an event is about
+ */
+enum class EntityType : std::uint8_t {
+    NONE,
+    ORDER,
+    CUSTOMER,
+    INVENTORY,
+    PAYMENT,
+    MENU_ITEM
+};
+
+constexpr std::size_t ENTITY_TYPE_COUNT = static_cast<std::size_t>(EntityType::MENU_ITEM) + 1;
+
+// Indexed by EntityType; keep in enum order
+constexpr const char* ENTITY_TYPE_NAMES[ENTITY_TYPE_COUNT] = {
+    "None",
+    "Order",
+    "Customer",
+    "Inventory",
+    "Payment",
+    "MenuItem"
+};
+
+constexpr const char* entityTypeName(EntityType type) {
+    return static_cast<std::size_t>(type) < ENTITY_TYPE_COUNT
+        ? ENTITY_TYPE_NAMES[static_cast<std::size_t>(type)] : "Unknown";
+}
+
+/**
+ * Interned names of the services that emit events
+ * Intern once per call site (static local) and store the 16-bit ID in the
+ * event; ID 0 is "unspecified". name() is lock-free
+ */
+using EventSourceId = std::uint16_t;
+
+class EventSources {
+public:
+    static constexpr std::size_t MAX_SOURCES = 256;
+    static EventSourceId intern(const std::string& name);
+    static const char* name(EventSourceId id);
+};
+
+/**
+ * Typed payloads (replace the old free-form details string)
+ */
+struct OrderPayload {
+    int customerId = 0;
+    double amount = 0.0;
+};
+
+struct InventoryPayload {
+    int quantity = 0;
+    int reorderLevel = 0;
+};
+
+struct PaymentPayload {
+    int orderId = 0;
+    double amount = 0.0;
+};
+
+using EventPayload = std::variant<std::monostate, OrderPayload, InventoryPayload, PaymentPayload>;
+
+/**
+ * Fixed-size, trivially copyable event: emitting and queueing never
+ * touch the heap
+ *
+ *   Event evt{EventType::ORDER_PLACED, EntityType::ORDER, source, orderId,
+ *             std::time(nullptr), OrderPayload{customerId, total}};
+ */
 struct Event {
-    EventType type;
-    int entityId;          // orderId, customerId, itemId, etc.
-    std::string entityType; // "Order", "Customer", "Inventory", etc.
-    std::string details;   // JSON-like or freeform context
-    std::time_t timestamp;
-    std::string sourceAction; // Which service emitted this
+    EventType type = EventType::ORDER_PLACED;
+    EntityType entityType = EntityType::NONE;
+    EventSourceId source = 0;     // Which service emitted this (EventSources)
+    int entityId = 0;             // orderId, customerId, itemId, etc.
+    std::time_t timestamp = 0;
+    EventPayload payload;
 };
 
+static_assert(std::is_trivially_copyable<Event>::value, "Event must stay copyable without allocation");
+
+// Human-readable one-line summary (for logging listeners)
+std::string describeEvent(const Event& event);
+
 /**
  * Event listener interface
  * Implement to react to events
@@ -43,29 +154,230 @@ public:
     virtual ~EventListener() = default;
     virtual void onEvent(const Event& event) = 0;
     virtual std::string getName() const = 0;
+    
+    /**
+     * Batch delivery for coalesced event types (see EventBus::setCoalescing)
+     * Return true to get one span per flush instead of a call per event;
+     * checked when the listener subscribes
+     */
+    virtual bool acceptsBatches() const { return false; }
+    virtual void onEventBatch(const Event* events, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) onEvent(events[i]);
+    }
+};
+
+/**
+ * How the bus delivers events to a listener
+ * SYNC  - inline on the emitting thread (audit paths that must stay in lockstep)
+ * ASYNC - through the listener's own bounded queue and worker thread
+ */
+enum class DispatchMode { SYNC, ASYNC };
+
+// What emit() does when an async listener's queue is full
+enum class QueueFullPolicy { BLOCK, DROP };
+
+/**
+ * Backpressure metrics for one async listener
+ */
+struct ListenerQueueStats {
+    std::string listenerName;
+    std::size_t capacity = 0;
+    std::size_t depth = 0;           // Events waiting right now
+    std::size_t highWaterMark = 0;   // Deepest the queue has been
+    std::uint64_t enqueued = 0;
+    std::uint64_t processed = 0;
+    std::uint64_t dropped = 0;       // Rejected under QueueFullPolicy::DROP
+    std::uint64_t blocked = 0;       // Emits that had to wait for space
+};
+
+/**
+ * Async delivery adapter
+ * Wraps a listener with a bounded lock-free MPSC queue and one worker
+ * thread, so events reach the listener in emit order without running on
+ * the emitter's thread
+ */
+class AsyncListenerQueue : public EventListener {
+public:
+    AsyncListenerQueue(EventListener* target, std::size_t capacity, QueueFullPolicy policy);
+    ~AsyncListenerQueue() override;
+    
+    void onEvent(const Event& event) override;   // Enqueue (called by the bus)
+    std::string getName() const override { return target->getName(); }
+    
+    // Coalesced spans are enqueued event by event; the worker still calls onEvent
+    bool acceptsBatches() const override { return target->acceptsBatches(); }
+    
+    EventListener* getTarget() const { return target; }
+    void drain();   // Block until everything enqueued so far is processed
+    void stop();    // Drain, then join the worker
+    ListenerQueueStats getStats() const;
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        Event event;
+    };
+    
+    bool tryEnqueue(const Event& event);
+    bool tryDequeue(Event& out);
+    void workerLoop();
+    
+    EventListener* target;
+    QueueFullPolicy policy;
+    std::unique_ptr<Cell[]> cells;
+    std::size_t capacity;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> tail{0};   // Producers claim here
+    alignas(64) std::size_t head = 0;               // Worker only
+    
+    std::atomic<std::uint64_t> enqueued{0};
+    std::atomic<std::uint64_t> processed{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> blocked{0};
+    std::atomic<std::size_t> highWater{0};
+    
+    std::atomic<bool> workerSleeping{false};
+    std::atomic<bool> stopping{false};
+    mutable std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    std::condition_variable drainedCv;
+    std::thread worker;
 };
 
 /**
  * Event bus - central dispatcher
  * Loosely couples services via publish-subscribe
+ * Listeners subscribe to every event or to specific EventTypes; emit only
+ * walks the wildcard list plus the list for the emitted type
+ *
+ * Thread safety: the listener lists live in an immutable table that writers
+ * copy, edit and publish under a mutex (copy-on-write). emit() reads the
+ * current table without taking any lock; a replaced table is freed only
+ * after every emit that could still be reading it has returned, so once
+ * unsubscribe() returns the listener will not be called again
  */
 class EventBus {
 private:
-    static EventBus* instance;
-    std::vector<EventListener*> listeners;
+    struct ListenerTable {
+        std::vector<EventListener*> all;   // Receive every event
+        std::array<std::vector<EventListener*>, EVENT_TYPE_COUNT> byType;
+        
+        // Coalesced types only: who gets each event vs who gets batches
+        std::array<bool, EVENT_TYPE_COUNT> coalesced{};
+        std::array<std::vector<EventListener*>, EVENT_TYPE_COUNT> immediate;
+        std::array<std::vector<EventListener*>, EVENT_TYPE_COUNT> batched;
+    };
+    
+    // Pending events of one coalesced type (created once, never freed)
+    struct CoalesceBuffer;
+    
+    // Read-side critical section around one walk of the current table
+    class ReadGuard;
+    
+    struct alignas(64) ReaderCount {
+        std::atomic<long> value{0};
+    };
+    
+    std::atomic<const ListenerTable*> table;
+    mutable std::atomic<unsigned> readerEpoch{0};
+    mutable ReaderCount activeReaders[2];
+    
+    // Writers only (subscribe / unsubscribe / clear)
+    mutable std::mutex writeMutex;
+    std::mutex graceMutex;
+    std::vector<std::shared_ptr<AsyncListenerQueue>> asyncQueues;
+    std::vector<std::unique_ptr<const ListenerTable>> retiredTables;
+    std::vector<std::shared_ptr<AsyncListenerQueue>> retiredQueues;
+    
+    EventBus();
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+    
+    std::array<std::atomic<CoalesceBuffer*>, EVENT_TYPE_COUNT> coalesceBuffers{};
+    std::atomic<int> openBatchScopes{0};
+    std::atomic<long> flushTickMs{0};   // 0 until the flusher thread starts
+    
+    bool modify(const std::function<bool(ListenerTable&)>& mutate);
+    static void splitBatchListeners(ListenerTable& table);
+    void coalesce(std::size_t typeIndex, const Event& event);
+    void deliverBatch(std::size_t typeIndex, bool wait);
+    void flusherLoop();
+    void waitForReaders();
+    AsyncListenerQueue* asyncAdapterFor(EventListener* listener) const;
+    EventListener* adapterOrCreate(EventListener* listener, std::size_t capacity, QueueFullPolicy policy);
+    void detachAdapter(AsyncListenerQueue* adapter);
 
 public:
     static EventBus& getInstance();
     
-    // Register a listener
+    // Register a listener for all events
+    // (safe to call from any thread, including from inside onEvent)
     void subscribe(EventListener* listener);
     
-    // Unregister a listener
+    // Register a listener for one event type (call once per type of interest)
+    void subscribe(EventType type, EventListener* listener);
+    
+    // Register with an explicit dispatch mode; ASYNC listeners share one
+    // queue across all their subscriptions so their events stay ordered
+    void subscribe(EventListener* listener, DispatchMode mode,
+                   std::size_t queueCapacity = 1024,
+                   QueueFullPolicy policy = QueueFullPolicy::BLOCK);
+    void subscribe(EventType type, EventListener* listener, DispatchMode mode,
+                   std::size_t queueCapacity = 1024,
+                   QueueFullPolicy policy = QueueFullPolicy::BLOCK);
+    
+    // Unregister a listener from everything it subscribed to
+    // (an async listener's queue is drained first). Blocks until in-flight
+    // emits are done with it, except when called from inside a callback,
+    // where the wait and the queue shutdown are left to the next writer
     void unsubscribe(EventListener* listener);
     
+    // Unregister a listener from one event type
+    void unsubscribe(EventType type, EventListener* listener);
+    
+    // Number of listeners an event of this type is delivered to
+    std::size_t getListenerCount(EventType type) const;
+    
     // Emit an event to all listeners
     void emit(const Event& event);
     
-    // Cleanup
+    // Block until every async queue has delivered what was emitted so far
+    void drainAsync();
+    
+    // Backpressure metrics for async listeners
+    std::vector<ListenerQueueStats> getQueueStats() const;
+    std::size_t getQueuedEventCount() const;
+    
+    /**
+     * Coalesce a high-frequency event type for batch-capable listeners
+     * Pending events are collapsed per entityId (latest wins) and delivered
+     * as one span once maxBatch entities are pending or `window` has passed
+     * since the first one. Other listeners still see every event
+     */
+    void setCoalescing(EventType type, std::size_t maxBatch, std::chrono::milliseconds window);
+    
+    // Pending events of the type go to the batch listeners before it stops coalescing
+    void disableCoalescing(EventType type);
+    
+    // Deliver every pending coalesced event now
+    void flushBatches();
+    
+    /**
+     * Holds coalesced events (up to maxBatch) until the outermost scope on
+     * any thread ends, then flushes: wrap bulk updates in one
+     *
+     *   { EventBus::BatchScope batch(bus); for (...) bus.emit(updated); }
+     */
+    class BatchScope {
+    public:
+        explicit BatchScope(EventBus& bus);
+        ~BatchScope();
+        BatchScope(const BatchScope&) = delete;
+        BatchScope& operator=(const BatchScope&) = delete;
+    private:
+        EventBus& bus;
+    };
+    
+    // Cleanup (drains and stops async workers)
     void clear();
 };
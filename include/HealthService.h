@@ -27,6 +27,15 @@ struct SystemHealth {
     size_t estimatedMemoryMB = 0;
     size_t snapshotCount = 0;
     size_t eventQueueSize = 0;
+    double idempotencyFilterFalsePositiveRate = 0.0;
+    double lockWaitP99Ms = 0.0;
+    size_t lockDeadlocks = 0;
+    bool storageCacheEnabled = false;
+    double storageCacheHitRatio = 0.0;
+    double storageFlushMeanMs = 0.0;
+    double storageFlushMaxMs = 0.0;
+    size_t storageDirtyRecords = 0;
+    size_t storageFlushFailures = 0;
 };
 
 /**
@@ -38,6 +47,7 @@ struct SystemHealth {
  * - Snapshot integrity
  * - Event system status
  * - Memory estimates
+ * - Storage cache hit ratio and flush latency
  * - Service availability
  */
 class HealthService {
@@ -1,7 +1,10 @@
 #pragma once
 #include <string>
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
+#include <future>
+#include "IdempotencyStore.h"
 
 /**
  * Idempotent Operations System
@@ -17,58 +20,171 @@ struct IdempotencyRecord {
     std::string resultData;     // Serialized result to return
     std::time_t createdAt;
     int ttlSeconds = 86400;     // 24 hours default
-    
-    bool isExpired() const {
-        std::time_t now = std::time(nullptr);
+
+    bool isExpired(std::time_t now) const {
         return (now - createdAt) > ttlSeconds;
     }
+    bool isExpired() const {
+        return isExpired(std::time(nullptr));
+    }
+};
+
+/**
+ * Outcome handed to callers that waited on a request ID
+ */
+struct IdempotencyOutcome {
+    enum class Status { SUCCEEDED, FAILED, ABANDONED };
+    Status status;
+    std::string resultData;
+};
+
+/**
+ * Result of IdempotencyService::claim
+ * owner: this caller runs the operation and must finish it with
+ *        recordSuccess, recordFailure or abandonRequest
+ * otherwise `result` resolves to the first caller's outcome (at once if it
+ * already finished); get() blocks, wait_for() lets the caller poll
+ */
+struct IdempotencyClaim {
+    bool owner = false;
+    std::shared_future<IdempotencyOutcome> result;
+};
+
+/**
+ * Counters for the fast-negative filter in front of the registry
+ */
+struct IdempotencyFilterStats {
+    std::uint64_t definitelyNew = 0;    // Answered by the filter alone
+    std::uint64_t falsePositives = 0;   // Filter said maybe, registry had no record
+    std::size_t memoryBytes = 0;
+
+    double falsePositiveRate() const {
+        const std::uint64_t negatives = definitelyNew + falsePositives;
+        return negatives ? static_cast<double>(falsePositives) / negatives : 0.0;
+    }
 };
 
 /**
  * Idempotency Service
  * Track request IDs and their outcomes
  * Return cached result if duplicate request detected
+ *
+ * Thread-safe. The registry is split into SHARD_COUNT shards, each an
+ * open-addressing table keyed by the 64-bit hash of the request ID and
+ * guarded by its own reader-writer lock; records live in per-shard slabs
+ * so their addresses stay fixed while they are tracked
+ *
+ * Expiry runs off a per-shard TimingWheel: every write first reclaims the
+ * records that fell due in its shard, so expired entries drain away
+ * incrementally instead of in one full sweep
+ *
+ * Each shard also keeps a counting Bloom filter of its live keys;
+ * isDuplicate() answers "new" from the filter without taking the lock,
+ * and expiry removes keys from it again
+ *
+ * claim() adds an in-flight state: while the first caller for a request
+ * ID is still working, later callers wait on its outcome instead of
+ * running the operation again (single flight)
+ *
+ * With persistence enabled every recorded outcome is also appended to an
+ * IdempotencyStore, and the registry is rebuilt from it on the next start
  */
 class IdempotencyService {
+public:
+    static constexpr std::size_t SHARD_COUNT = 64;
+
 private:
-    static std::map<std::string, IdempotencyRecord> registry;
+    struct Shard;
+    static Shard shards[SHARD_COUNT];
     static int defaultTTLSeconds;
+    static IdempotencyStore durableStore;
+
+    static Shard& shardFor(std::uint64_t hash);
+    static void store(const std::string& requestId, const std::string& operationType,
+                      bool succeeded, const std::string& resultData);
 
 public:
+    /**
+     * Hash used as the registry key (FNV-1a, never 0)
+     */
+    static std::uint64_t hashRequestId(const std::string& requestId);
+
     /**
      * Check if request was already processed
      * Returns cached result if found and not expired
      */
     static bool isDuplicate(const std::string& requestId, std::string& cachedResult);
-    
+
+    /**
+     * Claim a request ID before running the operation
+     * The first caller becomes the owner; callers arriving while it runs,
+     * or after it succeeded, get its outcome through the claim's future.
+     * After a recorded failure the next caller becomes the owner again
+     */
+    static IdempotencyClaim claim(const std::string& requestId);
+
+    /**
+     * Give up an owned claim without recording an outcome (e.g. on an
+     * exception); waiters see ABANDONED and may claim again
+     */
+    static void abandonRequest(const std::string& requestId);
+
     /**
      * Record a successful operation result
+     * Resolves any callers waiting on the request ID
      */
-    static void recordSuccess(const std::string& requestId, 
+    static void recordSuccess(const std::string& requestId,
                             const std::string& operationType,
                             const std::string& resultData);
-    
+
     /**
      * Record a failed operation
+     * Resolves any callers waiting on the request ID
      */
-    static void recordFailure(const std::string& requestId, 
+    static void recordFailure(const std::string& requestId,
                             const std::string& operationType);
-    
+
     /**
      * Get operation record (for audit/replay)
+     * The pointer is valid until the record expires or is overwritten;
+     * do not hold it across concurrent writes to the same request ID
      */
     static IdempotencyRecord* getRecord(const std::string& requestId);
-    
+
     /**
      * Clear expired records (call periodically)
+     * Touches only records that are due, not the whole registry
      */
     static void cleanupExpired();
-    
+
     /**
      * Get count of tracked requests
      */
     static int getTrackedCount();
-    
+
+    /**
+     * Back the registry with the record log at `path` and load what it holds
+     * (startup, before traffic; writes made during the load are not logged)
+     */
+    static bool enablePersistence(const std::string& path,
+                                  std::size_t initialBytes = 64 * 1024 * 1024);
+
+    // Sync and close the record log
+    static void disablePersistence();
+
+    // Make every recorded outcome durable against power loss (msync)
+    static void syncPersistence();
+
+    /**
+     * Resize the fast-negative filter (startup; rebuilds from live keys)
+     */
+    static void configureFilter(std::size_t expectedKeys, double falsePositiveRate);
+
+    /**
+     * Filter hit counts and observed false-positive rate
+     */
+    static IdempotencyFilterStats getFilterStats();
+
     /**
      * Set default TTL for new records
      */
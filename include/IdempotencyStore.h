@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "MappedFile.h"
+
+struct IdempotencyRecord;
+
+/**
+ * Durable Idempotency Store
+ * Append-only, memory-mapped record log behind IdempotencyService so a
+ * restart in the middle of a retry storm still recognises request IDs.
+ * A write lands in the page cache through the mapping, so it survives a
+ * process crash at once; sync() and close() make it survive power loss.
+ *
+ * File layout (host byte order, varints are LEB128):
+ *   header : "RMSIDM01", u64 reserved
+ *   record : u32 body length, u32 FNV-1a of body, body
+ *   body   : u8 succeeded, zigzag varint createdAt, zigzag varint ttl,
+ *            then requestId, operationType, resultData as varint length + bytes
+ * The last record for a request ID wins. A zero length marks the end of
+ * written data; a record whose checksum fails (torn write) ends recovery
+ *
+ * compact() rewrites only the latest, unexpired record per request ID into
+ * a temporary file and renames it over the log
+ */
+class IdempotencyStore {
+public:
+    struct RecordView {
+        std::string_view requestId;
+        std::string_view operationType;
+        std::string_view resultData;
+        bool succeeded;
+        std::time_t createdAt;
+        int ttlSeconds;
+    };
+
+    IdempotencyStore() = default;
+    ~IdempotencyStore();
+    IdempotencyStore(const IdempotencyStore&) = delete;
+    IdempotencyStore& operator=(const IdempotencyStore&) = delete;
+
+    /**
+     * Map the log at `path` (created if missing) and hand every intact
+     * record to `visitor` in one sequential pass, oldest first
+     * Appends are accepted once the pass is done
+     */
+    bool open(const std::string& path, std::size_t initialBytes,
+              const std::function<void(const RecordView&)>& visitor);
+
+    // Sync and unmap
+    void close();
+    bool isOpen() const { return accepting.load(std::memory_order_acquire); }
+
+    /**
+     * Append one record, remapping the file larger when it is full (never
+     * compacting); false if the store is closed or cannot grow
+     */
+    bool append(const IdempotencyRecord& record);
+
+    /**
+     * Drop superseded and expired records; returns bytes reclaimed
+     */
+    std::size_t compact(std::time_t now);
+
+    /**
+     * compact() once the log has doubled since the last compaction
+     */
+    bool compactIfGrown(std::time_t now);
+
+    /**
+     * msync everything appended so far
+     */
+    void sync();
+
+    std::size_t getUsedBytes() const;
+
+private:
+    bool map(std::size_t bytes);
+    bool grow(std::size_t need);
+    std::size_t compactLocked(std::time_t now);
+
+    mutable std::mutex mutex;
+    std::atomic<bool> accepting{false};
+    std::string path;
+    MappedFile file;
+    std::size_t writeOffset = 0;
+    std::size_t compactedBytes = 0;   // Log size right after the last compaction
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "EventSystem.h"
+
+enum class LockMode : std::uint8_t { SHARED, EXCLUSIVE };
+enum class LockResult : std::uint8_t { GRANTED, DEADLOCK, TIMEOUT };
+
+/**
+ * Lock wait-time histogram (only requests that had to wait are counted)
+ * Bucket i holds waits below BUCKET_LIMIT_US[i]; the last is unbounded
+ */
+struct LockWaitStats {
+    static constexpr std::size_t BUCKETS = 7;
+    static constexpr std::uint64_t BUCKET_LIMIT_US[BUCKETS - 1] = {10, 100, 1000, 10000, 100000, 1000000};
+
+    std::array<std::uint64_t, BUCKETS> buckets{};
+    std::uint64_t waits = 0;
+    std::uint64_t deadlocks = 0;   // Victims aborted
+    std::uint64_t timeouts = 0;
+
+    static const char* bucketLabel(std::size_t bucket);
+    // Upper bound of the bucket holding the given percentile (0 if no waits)
+    double percentileMs(double percentile) const;
+};
+
+/**
+ * Entity Lock Manager
+ * Pessimistic shared/exclusive locks keyed by (EntityType, id) for work
+ * that cannot be retried optimistically (refunds, cancellations).
+ * Transactions take locks through Transaction::lock and hold them until
+ * commit or rollback (strict two-phase locking). Waiters queue FIFO per
+ * entity; a holder upgrading SHARED -> EXCLUSIVE goes first.
+ *
+ * detectDeadlocks() builds the wait-for graph (waiter -> each holder or
+ * earlier waiter it conflicts with) and, per cycle, aborts the youngest
+ * transaction (highest ID): its acquire() returns DEADLOCK. A background
+ * detector runs it every interval
+ */
+class LockManager {
+public:
+    static LockManager& instance();
+
+    /**
+     * Lock (type, id) for transaction txId, waiting up to `timeout`
+     * Re-acquiring a held lock (or SHARED under EXCLUSIVE) returns at once
+     */
+    LockResult acquire(std::uint64_t txId, EntityType type, int id, LockMode mode,
+                       std::chrono::milliseconds timeout);
+
+    // Release every lock txId holds and wake the waiters behind it
+    void releaseAll(std::uint64_t txId);
+
+    /**
+     * One detection pass; returns the number of victims chosen
+     */
+    std::size_t detectDeadlocks();
+
+    void startDeadlockDetector(std::chrono::milliseconds interval);
+    void stopDeadlockDetector();
+
+    LockWaitStats getWaitStats() const;
+    std::size_t getLockedEntityCount() const;
+
+private:
+    LockManager() = default;
+
+    struct Request {
+        std::uint64_t txId;
+        LockMode mode;
+    };
+
+    struct Entry {
+        std::vector<Request> holders;
+        std::deque<Request> waiters;
+        std::condition_variable cv;
+    };
+
+    struct TxLocks {
+        std::vector<std::uint64_t> held;   // Lock keys
+        std::uint64_t waitingOn = 0;
+        bool waiting = false;
+        bool victim = false;
+    };
+
+    static std::uint64_t keyOf(EntityType type, int id) {
+        return (static_cast<std::uint64_t>(type) << 32) | static_cast<std::uint32_t>(id);
+    }
+
+    // Transactions that must release or be granted before `request` can be
+    void blockers(const Entry& entry, const Request& request, std::vector<std::uint64_t>& out) const;
+    void grant(Entry& entry, std::uint64_t key, const Request& request);
+    void dequeue(Entry& entry, std::uint64_t txId);
+    void recordWait(std::chrono::steady_clock::duration waited);
+    void detectorLoop(std::chrono::milliseconds interval);
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::uint64_t, std::unique_ptr<Entry>> table;
+    std::unordered_map<std::uint64_t, TxLocks> transactions;
+
+    std::array<std::atomic<std::uint64_t>, LockWaitStats::BUCKETS> waitBuckets{};
+    std::atomic<std::uint64_t> deadlockCount{0};
+    std::atomic<std::uint64_t> timeoutCount{0};
+
+    std::mutex detectorMutex;
+    std::condition_variable detectorCv;
+    bool detectorStopping = false;
+    std::thread detector;
+};
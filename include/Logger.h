@@ -1,9 +1,182 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <charconv>
+#include <type_traits>
 #include "Common.h"
+#include "BinaryLog.h"
+
+/**
+ * Compile-time minimum log level (0=DEBUG, 1=INFO, 2=WARNING, 3=ERROR)
+ * LOGF_* calls below this level are removed entirely; release builds
+ * (-DNDEBUG) drop DEBUG unless overridden with -DLOG_COMPILE_MIN_LEVEL=0
+ */
+#ifndef LOG_COMPILE_MIN_LEVEL
+#  ifdef NDEBUG
+#    define LOG_COMPILE_MIN_LEVEL 1
+#  else
+#    define LOG_COMPILE_MIN_LEVEL 0
+#  endif
+#endif
+
+/**
+ * What a producer does when its async ring buffer is full
+ * DROP  - discard the message and count it (never stalls the caller)
+ * BLOCK - spin until the writer thread frees a slot
+ */
+enum class LogOverflowPolicy { DROP, BLOCK };
 
 class Logger {
 public:
     static void initialize(const std::string& file = "restaurant.log");
     static void log(LogLevel level, const std::string& message);
+
+    /**
+     * Runtime level filter (cheap inline check used by the LOGF_* macros)
+     */
+    static bool isEnabled(LogLevel level) { return level >= minLevel; }
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+
+    /**
+     * Build a message from pieces with a single allocation
+     * Accepts strings, C strings, chars and arithmetic values
+     */
+    template <typename... Args>
+    static std::string concat(const Args&... args);
+
+    /**
+     * Switch to asynchronous mode
+     * Each producer thread pushes into its own lock-free ring buffer;
+     * a background thread formats and writes batches (one write() per batch)
+     */
+    static void enableAsync(std::size_t ringCapacity = 4096,
+                            LogOverflowPolicy policy = LogOverflowPolicy::DROP);
+
+    /**
+     * Block until every message queued before the call has been written
+     */
+    static void flush();
+
+    /**
+     * Drain all rings and the binary buffer, stop the writer thread and
+     * fall back to sync mode
+     */
+    static void shutdown();
+
+    static bool isAsync();
+    static std::size_t getDroppedCount();
+
+    /**
+     * Binary structured mode (see BinaryLog.h)
+     * LOGB call sites then write format ID + raw args instead of text;
+     * decode the file with tools/logdecode
+     */
+    static void enableBinary(const std::string& file = "restaurant.blog");
+    static void disableBinary();
+    static bool isBinary();
+
+    /**
+     * Register a "{}"-placeholder format once per call site; returns its ID
+     */
+    static std::uint16_t registerFormat(LogLevel level, const char* format);
+
+    template <typename... Args>
+    static void logBinary(std::uint16_t formatId, const Args&... args);
+
+    /**
+     * Text line layout shared by the text path and logdecode
+     */
+    static void formatLine(std::string& out, LogLevel level, std::time_t when, const std::string& msg);
+
+private:
+    static LogLevel minLevel;
+    static void writeBinary(std::uint16_t formatId, std::uint8_t argc, const std::string& payload);
 };
+
+namespace LogFormat {
+
+inline std::size_t pieceSize(const std::string& s) { return s.size(); }
+inline std::size_t pieceSize(std::string_view s) { return s.size(); }
+inline std::size_t pieceSize(const char* s) { return std::char_traits<char>::length(s); }
+inline std::size_t pieceSize(char) { return 1; }
+template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+inline std::size_t pieceSize(T) { return 24; }
+
+inline void append(std::string& out, const std::string& s) { out += s; }
+inline void append(std::string& out, std::string_view s) { out += s; }
+inline void append(std::string& out, const char* s) { out += s; }
+inline void append(std::string& out, char c) { out += c; }
+inline void append(std::string& out, bool b) { out += b ? "true" : "false"; }
+
+template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+inline void append(std::string& out, T value) {
+    char buf[32];
+    if constexpr (std::is_integral<T>::value) {
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, res.ptr);
+    } else {
+        // Same rendering as std::to_string(double) used at the old call sites
+        int n = std::snprintf(buf, sizeof(buf), "%f", static_cast<double>(value));
+        out.append(buf, n > 0 ? static_cast<std::size_t>(n) : 0);
+    }
+}
+
+} // namespace LogFormat
+
+template <typename... Args>
+std::string Logger::concat(const Args&... args) {
+    std::string out;
+    out.reserve((std::size_t{0} + ... + LogFormat::pieceSize(args)));
+    (LogFormat::append(out, args), ...);
+    return out;
+}
+
+template <typename... Args>
+void Logger::logBinary(std::uint16_t formatId, const Args&... args) {
+    static_assert(sizeof...(Args) < 256, "too many log arguments");
+    thread_local std::string payload;
+    payload.clear();
+    (BinaryLog::encodeArg(payload, args), ...);
+    writeBinary(formatId, static_cast<std::uint8_t>(sizeof...(Args)), payload);
+}
+
+/**
+ * Level-checked logging: arguments are only evaluated (and the message only
+ * built) when the level passes both the compile-time and runtime filters
+ *
+ *   LOGF_DEBUG("EventBus: Emitting ", name, " #", event.entityId);
+ */
+#define LOGF(level, ...)                                                    \
+    do {                                                                    \
+        if constexpr (static_cast<int>(level) >= LOG_COMPILE_MIN_LEVEL) {   \
+            if (Logger::isEnabled(level)) {                                 \
+                Logger::log(level, Logger::concat(__VA_ARGS__));            \
+            }                                                               \
+        }                                                                   \
+    } while (0)
+
+#define LOGF_DEBUG(...) LOGF(LogLevel::DEBUG, __VA_ARGS__)
+#define LOGF_INFO(...)  LOGF(LogLevel::INFO, __VA_ARGS__)
+#define LOGF_WARN(...)  LOGF(LogLevel::WARNING, __VA_ARGS__)
+#define LOGF_ERROR(...) LOGF(LogLevel::ERROR, __VA_ARGS__)
+
+/**
+ * Structured logging: the format is registered once per call site and
+ * only the ID + raw args are recorded in binary mode (text otherwise)
+ *
+ *   LOGB(LogLevel::INFO, "Order {} transitioned to {}", orderId, OrderFSM::name(next));
+ */
+#define LOGB(level, format, ...)                                                        \
+    do {                                                                                \
+        if constexpr (static_cast<int>(level) >= LOG_COMPILE_MIN_LEVEL) {               \
+            if (Logger::isEnabled(level)) {                                             \
+                static const std::uint16_t logFormatId = Logger::registerFormat(level, format); \
+                Logger::logBinary(logFormatId, __VA_ARGS__);                            \
+            }                                                                           \
+        }                                                                               \
+    } while (0)
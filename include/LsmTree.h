@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+struct LsmOptions {
+    std::size_t memtableBytes = 4 * 1024 * 1024;   // Rotate the memtable past this size
+    std::size_t blockBytes = 4096;                 // Target data block size in run files
+    std::size_t compactionTrigger = 4;             // Merge the runs once this many exist
+    double bloomFalsePositiveRate = 0.01;
+    bool syncWrites = false;                       // fdatasync the log on every write
+};
+
+struct LsmStats {
+    std::size_t memtableEntries = 0;
+    std::size_t immutableMemtables = 0;
+    std::size_t runs = 0;
+    std::uint64_t flushes = 0;
+    std::uint64_t compactions = 0;
+    std::uint64_t bloomSkips = 0;   // Run lookups answered by the Bloom filter alone
+    std::uint64_t blockReads = 0;
+};
+
+/**
+ * Log-Structured Merge Tree (int key -> byte string value)
+ * Writes go to a log file (framed like the other logs) and a sorted
+ * in-memory memtable. A full memtable becomes immutable and a background
+ * thread writes it out as a sorted run file; once compactionTrigger runs
+ * exist they are merged into one, keeping the newest value per key and
+ * dropping deletions. Writers stall while two memtables wait to be written.
+ *
+ * Run file (host byte order):
+ *   blocks : entries of i32 key, u8 flags (1 = deleted), varint length, bytes
+ *   index  : per block i32 first key, u32 size, u64 offset
+ *   bloom  : 64-byte blocks of bits, one block per key
+ *   footer : u64 index offset, u64 block count, u64 bloom offset, u64 bloom
+ *            blocks, u32 probes, u32 checksum (index + bloom), "RMSSST01"
+ * Runs are mapped read-only. A lookup checks the memtables, then each run
+ * newest first: Bloom filter, binary search of the block index, one block.
+ * MANIFEST lists the live runs and the oldest live log; both it and run
+ * files are written to a temporary name and renamed into place
+ */
+class LsmTree {
+public:
+    LsmTree() = default;
+    ~LsmTree();
+    LsmTree(const LsmTree&) = delete;
+    LsmTree& operator=(const LsmTree&) = delete;
+
+    /**
+     * Open (or create) the tree in `dir`, replaying any unflushed logs
+     */
+    bool open(const std::string& dir, const LsmOptions& options = LsmOptions());
+    void close();
+    bool isOpen() const { return logFd >= 0; }
+
+    bool put(int key, std::string_view value);
+    bool remove(int key);
+
+    /**
+     * Latest value for `key`; false if it was never written or is deleted
+     */
+    bool get(int key, std::string& value) const;
+
+    /**
+     * Visit every live key in ascending order with its latest value;
+     * fn returns false to stop. Run pages are dropped from memory behind
+     * the scan, so a full pass does not pull whole runs into memory
+     */
+    void forEach(const std::function<bool(int key, std::string_view value)>& fn) const;
+
+    // Write the memtable out now and wait for it
+    bool flush();
+    // Merge every run into one now and wait for it
+    bool compact();
+
+    LsmStats getStats() const;
+
+    class Run;   // Mapped sorted run file (LsmTree.cpp)
+
+private:
+    struct Slot {
+        std::string value;
+        bool deleted = false;
+    };
+
+    struct Memtable {
+        std::map<int, Slot> entries;
+        std::size_t bytes = 0;
+        std::uint64_t logNumber = 0;
+    };
+
+    using RunList = std::vector<std::shared_ptr<const Run>>;   // Newest first
+
+    bool write(int key, std::string_view value, bool deleted);
+    bool openLog(std::uint64_t number);
+    bool replayLog(const std::string& path, Memtable& into);
+    bool rotateLocked();
+    bool writeRun(const Memtable& memtable, std::shared_ptr<const Run>& out);
+    bool mergeRuns(const RunList& inputs, std::shared_ptr<const Run>& out);
+    bool writeManifestLocked();
+    std::string fileName(const char* prefix, std::uint64_t number, const char* suffix) const;
+    void backgroundLoop();
+    bool flushOldestImmutable();
+    bool compactOnce();
+
+    std::string directory;
+    LsmOptions options;
+
+    mutable std::mutex mutex;
+    std::condition_variable workCv;   // Background thread: work arrived or stop
+    std::condition_variable doneCv;   // Writers and flush(): background work finished
+    std::shared_ptr<Memtable> active;
+    std::deque<std::shared_ptr<const Memtable>> immutables;   // Newest first
+    std::shared_ptr<const RunList> runs;
+    std::uint64_t nextFileNumber = 1;
+    int logFd = -1;
+    bool stopping = false;
+    bool compactRequested = false;
+    bool backgroundFailed = false;
+    std::thread background;
+    std::mutex compactionMutex;       // One run merge at a time
+
+    std::uint64_t flushCount = 0;
+    std::uint64_t compactionCount = 0;
+    mutable std::atomic<std::uint64_t> bloomSkipCount{0};
+    mutable std::atomic<std::uint64_t> blockReadCount{0};
+};
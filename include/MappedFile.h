@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * Memory-Mapped File (POSIX mmap)
+ * Append-only logs size a file up front and write through the mapping;
+ * sync() makes a byte range durable (msync) without a write() per record
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Map read-write, creating the file or growing it to `size` bytes
+     * (new bytes read as zero); an existing larger file is mapped whole
+     */
+    bool open(const std::string& path, std::size_t size);
+
+    // Map an existing file read-only
+    bool openReadOnly(const std::string& path);
+
+    void close();
+
+    /**
+     * Flush [offset, offset + length) to disk and wait for it
+     */
+    bool sync(std::size_t offset, std::size_t length);
+
+    // Tell the kernel the mapping will be read front to back (madvise)
+    void adviseSequential() const;
+
+    /**
+     * Drop the pages of [offset, offset + length) from this process's
+     * resident set (a partial last page is kept); the data stays in the
+     * page cache and is faulted back in if touched again
+     */
+    void release(std::size_t offset, std::size_t length) const;
+
+    bool isOpen() const { return base != nullptr; }
+    char* data() { return base; }
+    const char* data() const { return base; }
+    std::size_t size() const { return length; }
+    const std::string& path() const { return filePath; }
+
+private:
+    bool map(int prot, std::size_t size, bool writable);
+
+    int fd = -1;
+    char* base = nullptr;
+    std::size_t length = 0;
+    std::string filePath;
+};
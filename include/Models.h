@@ -2,6 +2,7 @@
 #include <string>
 #include <ctime>
 #include "OrderFSM.h"
+#include "Logger.h"
 
 struct Customer {
     int id;
@@ -29,8 +30,11 @@ struct Order {
     bool updateState(OrderState next) {
         if (OrderFSM::canTransition(state, next)) {
             state = next;
+            LOGB(LogLevel::INFO, "Order {} transitioned to {}", orderId, OrderFSM::name(next));
             return true;
         }
+        LOGB(LogLevel::WARNING, "Invalid state transition for order {}: {} -> {}",
+             orderId, OrderFSM::name(state), OrderFSM::name(next));
         return false;
     }
 };
@@ -2,6 +2,8 @@
 #define ORDER_COMMAND_SERVICE_H
 
 #include "Models.h"
+#include "EventSystem.h"
+#include "WriteAheadLog.h"
 #include <string>
 #include <vector>
 
@@ -17,25 +19,39 @@
  * - Mark as served
  * 
  * Enforces business rules and maintains consistency.
+ * Orders are written through StorageManager's current strategy; every
+ * transition goes through OrderFSM and emits its event.
+ * Each write runs in a Transaction that logs the order's before/after
+ * image, so with the write-ahead log enabled redoChange/undoChange are
+ * its recovery handlers.
  */
 class OrderCommandService {
 public:
     static OrderCommandService& instance();
     
     // Commands (state-changing operations)
-    Order createOrder(const std::string& customerId, 
+    // With a requestId, concurrent retries wait for and share the first attempt's order;
+    // a failed create returns an order with orderId 0
+    Order createOrder(int customerId, 
                       const std::vector<MenuItem>& items,
                       const std::string& requestId = "");
     
-    void confirmOrder(const std::string& orderId);
-    void markAsServing(const std::string& orderId);
-    void markAsReady(const std::string& orderId);
-    void markAsServed(const std::string& orderId);
-    void cancelOrder(const std::string& orderId);
-    void issueRefund(const std::string& orderId, const std::string& reason);
+    bool confirmOrder(int orderId);
+    bool markAsServing(int orderId);
+    bool markAsReady(int orderId);
+    bool markAsServed(int orderId);
+    bool cancelOrder(int orderId);
+    bool issueRefund(int orderId, const std::string& reason);
+    
+    // Write-ahead log recovery; true once the logged order image is stored and flushed
+    static bool redoChange(const WalChange& change);
+    static bool undoChange(const WalChange& change);
     
 private:
     OrderCommandService() = default;
+    
+    Order buildOrder(int customerId, const std::vector<MenuItem>& items);
+    bool transition(int orderId, OrderState next, EventType type);
 };
 
 #endif
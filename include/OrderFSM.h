@@ -15,6 +15,7 @@ class OrderFSM {
 public:
     static bool canTransition(OrderState from, OrderState to);
     static std::string toString(OrderState s);
+    static const char* name(OrderState s);  // Allocation-free variant for log arguments
 };
 
 // Implementation (still in header OR separate cpp if you want)
@@ -35,10 +36,14 @@ inline bool OrderFSM::canTransition(OrderState from, OrderState to) {
     }
 }
 
-inline std::string OrderFSM::toString(OrderState s) {
+inline const char* OrderFSM::name(OrderState s) {
     static const char* names[] = {
         "CREATED","CONFIRMED","PREPARING","READY",
         "SERVED","CANCELLED","REFUNDED"
     };
     return names[(int)s];
 }
+
+inline std::string OrderFSM::toString(OrderState s) {
+    return name(s);
+}
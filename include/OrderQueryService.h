@@ -2,7 +2,9 @@
 #define ORDER_QUERY_SERVICE_H
 
 #include "Models.h"
-#include <string>
+#include "OrderFSM.h"
+#include "StorageStrategy.h"
+#include <cstddef>
 #include <vector>
 
 /**
@@ -16,6 +18,9 @@
  * - Get order history
  * - Get orders by customer
  * 
+ * Queries run against StorageManager's current strategy. Filtered
+ * queries stream the orders (forEachOrder) and keep only the matches,
+ * so their memory use follows the result, not the order history.
  * No side effects, safe to call from UI.
  */
 class OrderQueryService {
@@ -23,15 +28,20 @@ public:
     static OrderQueryService& instance();
     
     // Queries (read-only operations, no side effects)
-    Order getOrder(const std::string& orderId);
+    Order getOrder(int orderId);
     std::vector<Order> getAllOrders();
     std::vector<Order> getActiveOrders();
-    std::vector<Order> getOrdersByCustomer(const std::string& customerId);
-    std::vector<Order> getOrdersByStatus(OrderStatus status);
+    std::vector<Order> getOrdersByCustomer(int customerId);
+    std::vector<Order> getOrdersByStatus(OrderState state);
     Order getLastOrder();
     
+    // Matching orders, counted without collecting them
+    std::size_t countOrders(const RecordPredicate<Order>& predicate);
+    
 private:
     OrderQueryService() = default;
+    
+    std::vector<Order> collect(const RecordPredicate<Order>& predicate);
 };
 
 #endif
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Small-Buffer Callable
+ * Move-only std::function replacement: callables up to Capacity bytes
+ * (lambdas capturing a few references or values) live inline, larger
+ * ones fall back to the heap. Empty std::function / null pointers stay empty
+ */
+template <typename Signature, std::size_t Capacity = 48>
+class SmallFunction;
+
+template <typename R, typename... Args, std::size_t Capacity>
+class SmallFunction<R(Args...), Capacity> {
+    struct Ops {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*move)(void* dst, void* src) noexcept;   // Move-construct dst from src, destroy src
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename F>
+    static constexpr bool fitsInline = sizeof(F) <= Capacity &&
+                                       alignof(F) <= alignof(std::max_align_t) &&
+                                       std::is_nothrow_move_constructible<F>::value;
+
+    template <typename F>
+    static const Ops* inlineOps() {
+        static const Ops ops = {
+            [](void* s, Args&&... args) -> R {
+                return (*static_cast<F*>(s))(std::forward<Args>(args)...);
+            },
+            [](void* dst, void* src) noexcept {
+                new (dst) F(std::move(*static_cast<F*>(src)));
+                static_cast<F*>(src)->~F();
+            },
+            [](void* s) noexcept { static_cast<F*>(s)->~F(); },
+        };
+        return &ops;
+    }
+
+    template <typename F>
+    static const Ops* heapOps() {
+        static const Ops ops = {
+            [](void* s, Args&&... args) -> R {
+                return (**static_cast<F**>(s))(std::forward<Args>(args)...);
+            },
+            [](void* dst, void* src) noexcept {
+                *static_cast<F**>(dst) = *static_cast<F**>(src);
+            },
+            [](void* s) noexcept { delete *static_cast<F**>(s); },
+        };
+        return &ops;
+    }
+
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    const Ops* ops = nullptr;
+
+public:
+    SmallFunction() noexcept = default;
+    SmallFunction(std::nullptr_t) noexcept {}
+
+    template <typename F, typename D = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same<D, SmallFunction>::value &&
+                                          std::is_invocable_r<R, D&, Args...>::value>>
+    SmallFunction(F&& f) {
+        if constexpr (std::is_constructible<bool, const D&>::value) {
+            if (!static_cast<bool>(f)) return;   // Empty std::function or null pointer
+        }
+        if constexpr (fitsInline<D>) {
+            new (storage) D(std::forward<F>(f));
+            ops = inlineOps<D>();
+        } else {
+            *reinterpret_cast<D**>(storage) = new D(std::forward<F>(f));
+            ops = heapOps<D>();
+        }
+    }
+
+    SmallFunction(SmallFunction&& other) noexcept : ops(other.ops) {
+        if (ops) {
+            ops->move(storage, other.storage);
+            other.ops = nullptr;
+        }
+    }
+
+    SmallFunction& operator=(SmallFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops) {
+                other.ops->move(storage, other.storage);
+                ops = other.ops;
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    SmallFunction(const SmallFunction&) = delete;
+    SmallFunction& operator=(const SmallFunction&) = delete;
+
+    ~SmallFunction() { reset(); }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    R operator()(Args... args) {
+        return ops->invoke(storage, std::forward<Args>(args)...);
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Small Vector
+ * The first N elements are stored inline; growing past that moves them to
+ * the heap. clear() keeps whatever capacity was reached, so a pooled owner
+ * stops allocating once warmed up. Non-copyable and non-movable: owners
+ * stay in place (pooled Transactions) and reuse it through clear()
+ */
+template <typename T, std::size_t N>
+class SmallVector {
+    alignas(T) unsigned char inlineStorage[N * sizeof(T)];
+    T* items = reinterpret_cast<T*>(inlineStorage);
+    std::size_t count = 0;
+    std::size_t capacity = N;
+
+    bool isInline() const { return items == reinterpret_cast<const T*>(inlineStorage); }
+
+    void grow() {
+        const std::size_t next = capacity * 2;
+        T* moved = static_cast<T*>(::operator new(next * sizeof(T)));
+        for (std::size_t i = 0; i < count; ++i) {
+            new (moved + i) T(std::move(items[i]));
+            items[i].~T();
+        }
+        if (!isInline()) ::operator delete(items);
+        items = moved;
+        capacity = next;
+    }
+
+public:
+    static_assert(N > 0, "SmallVector needs inline capacity");
+
+    SmallVector() = default;
+    SmallVector(const SmallVector&) = delete;
+    SmallVector& operator=(const SmallVector&) = delete;
+
+    ~SmallVector() {
+        clear();
+        if (!isInline()) ::operator delete(items);
+    }
+
+    template <typename... A>
+    T& emplace_back(A&&... args) {
+        if (count == capacity) grow();
+        T* slot = new (items + count) T(std::forward<A>(args)...);
+        ++count;
+        return *slot;
+    }
+
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void clear() noexcept {
+        for (std::size_t i = 0; i < count; ++i) items[i].~T();
+        count = 0;
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T& operator[](std::size_t i) { return items[i]; }
+    const T& operator[](std::size_t i) const { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+};
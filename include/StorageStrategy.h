@@ -2,10 +2,23 @@
 #define STORAGE_STRATEGY_H
 
 #include "Models.h"
+#include "SoftDelete.h"
+#include "CsvCompactor.h"
+#include "CsvIndex.h"
+#include "LsmTree.h"
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
 
+// Streaming scan callbacks: a predicate filters records inside the scan,
+// a visitor receives the matches and returns false to stop
+template <typename Record>
+using RecordPredicate = std::function<bool(const Record&)>;
+template <typename Record>
+using RecordVisitor = std::function<bool(const Record&)>;
+
 /**
  * @class StorageStrategy
  * @brief Abstract storage interface (Strategy Pattern)
@@ -15,7 +28,7 @@
  * 
  * Current implementations:
  * - CSVStorage (CSV files)
- * - TXTStorage (Text files)
+ * - LSMStorage (embedded log-structured merge trees)
  * 
  * Future implementations:
  * - SQLiteStorage
@@ -27,21 +40,43 @@ public:
     
     // Customers
     virtual bool saveCustomer(const CustomerRecord& customer) = 0;
-    virtual CustomerRecord loadCustomer(const std::string& id) = 0;
+    virtual CustomerRecord loadCustomer(int id) = 0;
     virtual std::vector<CustomerRecord> loadAllCustomers() = 0;
-    virtual bool deleteCustomer(const std::string& id) = 0;
+    virtual bool deleteCustomer(int id) = 0;
     
     // Menu Items
     virtual bool saveMenuItem(const MenuItem& item) = 0;
-    virtual MenuItem loadMenuItem(const std::string& id) = 0;
+    virtual MenuItem loadMenuItem(int id) = 0;
     virtual std::vector<MenuItem> loadAllMenuItems() = 0;
-    virtual bool deleteMenuItem(const std::string& id) = 0;
+    virtual bool deleteMenuItem(int id) = 0;
     
     // Orders
     virtual bool saveOrder(const Order& order) = 0;
-    virtual Order loadOrder(const std::string& id) = 0;
+    virtual Order loadOrder(int id) = 0;
     virtual std::vector<Order> loadAllOrders() = 0;
-    virtual bool deleteOrder(const std::string& id) = 0;
+    virtual bool deleteOrder(int id) = 0;
+    
+    // Batch saves (pointer + count); the defaults save row by row
+    virtual bool saveCustomers(const CustomerRecord* customers, std::size_t count);
+    virtual bool saveMenuItems(const MenuItem* items, std::size_t count);
+    virtual bool saveOrders(const Order* orders, std::size_t count);
+    
+    /**
+     * Streaming scans over the same records the loadAll calls return, in
+     * the same order, without building a vector: `predicate` (empty for
+     * all) runs on each record as it is decoded and only matches reach
+     * `visitor`. Returns the number of records visited. The defaults
+     * filter loadAll's result; the built-in backends stream
+     */
+    virtual std::size_t forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                        const RecordVisitor<CustomerRecord>& visitor);
+    virtual std::size_t forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                        const RecordVisitor<MenuItem>& visitor);
+    virtual std::size_t forEachOrder(const RecordPredicate<Order>& predicate,
+                                     const RecordVisitor<Order>& visitor);
+    
+    // Push buffered writes to the backing store
+    virtual bool flush() { return true; }
     
     // Diagnostic
     virtual std::string getName() const = 0;
@@ -51,37 +86,156 @@ public:
 /**
  * @class CSVStorageStrategy
  * @brief CSV file-based storage implementation
+ * 
+ * One append-only file per entity under the data directory:
+ *   customers.txt  : id,name,phone,email,loyaltyPoints,active,deletedAt
+ *   menu_items.txt : id,name,category,price
+ *   orders.txt     : orderId,customerId,total,state,priority,timestamp
+ * Each file has a sidecar ID index (CsvIndex) kept current by the saves,
+ * so a point load reads one row: the latest one saved under that ID.
+ * Bulk loads and scans parse the memory-mapped file in place (CsvReader)
+ * and return only those latest rows, matched by the offsets the index
+ * holds; rows that do not parse (headers, damaged lines) are skipped. The
+ * forEach scans decode into one reused record and release mapped pages
+ * as they go, so their memory use follows the number of IDs (8 bytes
+ * each), not the file.
+ * Rows go through each index's long-lived buffered writer; the write
+ * policy decides whether every save call flushes and whether flushes sync.
+ * Deleting a customer appends an inactive version stamped with deletedAt.
+ * Compaction (CsvCompactor) rewrites the files down to the latest row per
+ * ID and drops customers deleted longer ago than the retention period
  */
 class CSVStorageStrategy : public StorageStrategy {
 public:
+    explicit CSVStorageStrategy(std::string dataDirectory = "data");
+    
     // Customers
     bool saveCustomer(const CustomerRecord& customer) override;
-    CustomerRecord loadCustomer(const std::string& id) override;
+    CustomerRecord loadCustomer(int id) override;
     std::vector<CustomerRecord> loadAllCustomers() override;
-    bool deleteCustomer(const std::string& id) override;
+    bool deleteCustomer(int id) override;
     
     // Menu Items
     bool saveMenuItem(const MenuItem& item) override;
-    MenuItem loadMenuItem(const std::string& id) override;
+    MenuItem loadMenuItem(int id) override;
     std::vector<MenuItem> loadAllMenuItems() override;
-    bool deleteMenuItem(const std::string& id) override;
+    bool deleteMenuItem(int id) override;
     
     // Orders
     bool saveOrder(const Order& order) override;
-    Order loadOrder(const std::string& id) override;
+    Order loadOrder(int id) override;
     std::vector<Order> loadAllOrders() override;
-    bool deleteOrder(const std::string& id) override;
+    bool deleteOrder(int id) override;
+    
+    // Batch saves: one log line and at most one flush per call
+    bool saveCustomers(const CustomerRecord* customers, std::size_t count) override;
+    bool saveMenuItems(const MenuItem* items, std::size_t count) override;
+    bool saveOrders(const Order* orders, std::size_t count) override;
+    bool flush() override;
+    
+    std::size_t forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                const RecordVisitor<CustomerRecord>& visitor) override;
+    std::size_t forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                const RecordVisitor<MenuItem>& visitor) override;
+    std::size_t forEachOrder(const RecordPredicate<Order>& predicate,
+                             const RecordVisitor<Order>& visitor) override;
+    
+    void setWritePolicy(const CsvWritePolicy& policy);
     
     // Diagnostic
     std::string getName() const override { return "CSV Storage"; }
     bool isHealthy() override;
+    
+    // Re-index every data file (after editing them by hand)
+    bool rebuildIndexes();
+    
+    // Compact the data files in the background from now on
+    void startCompaction(const CsvCompactionOptions& options);
+    void stopCompaction();
+    // Compact every data file now, on the calling thread
+    bool compact();
+    CsvCompactionStats getCompactionStats() const;
+    
+private:
+    std::string filePath(const char* name) const;
+    CsvCompactor& getCompactor(const CsvCompactionOptions& options = CsvCompactionOptions());
+    
+    std::string dataDirectory;
+    CsvIndex customerIndex;
+    CsvIndex menuItemIndex;
+    CsvIndex orderIndex;
+    bool flushEachCall = true;
+    std::unique_ptr<CsvCompactor> compactor;   // Declared last: stops before the indexes go
+};
+
+/**
+ * @class LSMStorageStrategy
+ * @brief Embedded log-structured storage (no external service)
+ * 
+ * One LsmTree per entity under the data directory (customers/,
+ * menu_items/, orders/), keyed by ID with the CSV row as the value.
+ * Saves replace the previous version instead of appending a duplicate,
+ * deletes remove the record, and point loads cost a memtable probe plus
+ * at most one block per run (Bloom filters skip the rest)
+ */
+class LSMStorageStrategy : public StorageStrategy {
+public:
+    explicit LSMStorageStrategy(std::string dataDirectory = "data/lsm", const LsmOptions& options = LsmOptions());
+    
+    // Customers
+    bool saveCustomer(const CustomerRecord& customer) override;
+    CustomerRecord loadCustomer(int id) override;
+    std::vector<CustomerRecord> loadAllCustomers() override;
+    bool deleteCustomer(int id) override;
+    
+    // Menu Items
+    bool saveMenuItem(const MenuItem& item) override;
+    MenuItem loadMenuItem(int id) override;
+    std::vector<MenuItem> loadAllMenuItems() override;
+    bool deleteMenuItem(int id) override;
+    
+    // Orders
+    bool saveOrder(const Order& order) override;
+    Order loadOrder(int id) override;
+    std::vector<Order> loadAllOrders() override;
+    bool deleteOrder(int id) override;
+    
+    bool saveCustomers(const CustomerRecord* customers, std::size_t count) override;
+    bool saveMenuItems(const MenuItem* items, std::size_t count) override;
+    bool saveOrders(const Order* orders, std::size_t count) override;
+    
+    std::size_t forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                const RecordVisitor<CustomerRecord>& visitor) override;
+    std::size_t forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                const RecordVisitor<MenuItem>& visitor) override;
+    std::size_t forEachOrder(const RecordPredicate<Order>& predicate,
+                             const RecordVisitor<Order>& visitor) override;
+    
+    // Diagnostic
+    std::string getName() const override { return "LSM Storage"; }
+    bool isHealthy() override;
+    
+    // Merge every table's runs now
+    bool compact();
+    LsmStats getOrderStats() const { return orders.getStats(); }
+    
+private:
+    std::string dataDirectory;
+    LsmTree customers;
+    LsmTree menuItems;
+    LsmTree orders;
 };
 
+struct StorageCacheOptions;
+struct StorageCacheStats;
+
 /**
  * @class StorageManager
  * @brief Global storage coordinator
  * 
  * Provides single point to configure storage strategy.
+ * With STORAGE_CACHE_ENABLED the configured backend is wrapped in a
+ * write-behind cache (CachingStorageStrategy).
  */
 class StorageManager {
 public:
@@ -91,6 +245,11 @@ public:
     StorageStrategy& getStrategy();
     std::string getStorageType() const;
     
+    // Wrap the current strategy in a write-behind cache
+    void enableCache(const StorageCacheOptions& options);
+    // false if the current strategy is not cached
+    bool getCacheStats(StorageCacheStats& stats) const;
+    
 private:
     StorageManager();
     std::unique_ptr<StorageStrategy> strategy;
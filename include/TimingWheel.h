@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+/**
+ * Hierarchical Timing Wheel
+ * Schedules integer IDs against a deadline in whole seconds
+ * Four levels of 64 slots: 1s, 64s, ~68min and ~3 day granularity
+ * advance() touches only the slots whose time has come, so firing cost
+ * follows the number of due entries, not the number scheduled
+ *
+ * Entries are never cancelled; the owner checks on fire whether the
+ * deadline it gets back is still current and ignores stale ones
+ * The clock starts at the first advance(), so call it before schedule()
+ * Not thread-safe: callers hold their own lock
+ */
+class TimingWheel {
+public:
+    static constexpr unsigned LEVELS = 4;
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr std::size_t SLOTS = std::size_t(1) << SLOT_BITS;
+
+    struct Entry {
+        std::uint32_t id;
+        std::time_t deadline;
+    };
+
+private:
+    std::vector<Entry> slots[LEVELS][SLOTS];
+    std::vector<Entry> overdue;   // Scheduled at or before the current tick
+    std::vector<Entry> firing;    // Scratch; swapped with a due slot so capacity is reused
+    std::time_t current = 0;      // Last second processed; 0 until first use
+    std::size_t pending = 0;
+
+    static constexpr std::size_t MASK = SLOTS - 1;
+
+    void place(const Entry& entry) {
+        const std::time_t delta = entry.deadline - current;
+        if (delta <= 0) {
+            overdue.push_back(entry);
+            return;
+        }
+        for (unsigned level = 0; level < LEVELS; ++level) {
+            const unsigned shift = level * SLOT_BITS;
+            if (delta < (std::time_t(1) << (shift + SLOT_BITS)) || level == LEVELS - 1) {
+                // Past the top level's range: park in its furthest slot and re-place on cascade
+                const std::time_t at = level == LEVELS - 1 && (delta >> (shift + SLOT_BITS)) != 0
+                                           ? current + (std::time_t(MASK) << shift)
+                                           : entry.deadline;
+                slots[level][(at >> shift) & MASK].push_back(entry);
+                return;
+            }
+        }
+    }
+
+    // Move one higher-level slot down now that its span has started
+    void cascade(unsigned level) {
+        std::vector<Entry> moving;
+        moving.swap(slots[level][(current >> (level * SLOT_BITS)) & MASK]);
+        for (const Entry& entry : moving) place(entry);
+    }
+
+public:
+    /**
+     * Schedule an ID to fire once `deadline` (seconds) is reached
+     */
+    void schedule(std::uint32_t id, std::time_t deadline) {
+        ++pending;
+        place({id, deadline});
+    }
+
+    /**
+     * Process every second up to `now`, calling onDue(id, deadline)
+     * for each entry whose deadline has passed. Returns entries fired
+     */
+    template <typename Fn>
+    std::size_t advance(std::time_t now, Fn&& onDue) {
+        std::size_t fired = 0;
+        auto fire = [&](std::vector<Entry>& due) {
+            if (due.empty()) return;
+            firing.swap(due);
+            for (const Entry& entry : firing) onDue(entry.id, entry.deadline);
+            fired += firing.size();
+            pending -= firing.size();
+            firing.clear();
+        };
+
+        if (pending == 0 && now > current) {
+            // Nothing scheduled across the gap; jump straight there
+            current = now;
+        }
+        fire(overdue);
+        while (current < now && pending > 0) {
+            ++current;
+            for (unsigned level = LEVELS - 1; level > 0; --level) {
+                const std::time_t below = (std::time_t(1) << (level * SLOT_BITS)) - 1;
+                if ((current & below) == 0) cascade(level);
+            }
+            fire(slots[0][current & MASK]);
+            fire(overdue);
+        }
+        if (current < now) current = now;
+        return fired;
+    }
+
+    /**
+     * Entries scheduled and not yet fired (including stale ones)
+     */
+    std::size_t size() const { return pending; }
+
+    /**
+     * Last second processed by advance()
+     */
+    std::time_t now() const { return current; }
+};
@@ -2,9 +2,16 @@
 #define TRANSACTION_MANAGER_H
 
 #include "Common.h"
+#include "SmallFunction.h"
+#include "SmallVector.h"
+#include "LockManager.h"
+#include "VersionedTable.h"
+#include "WriteAheadLog.h"
 #include <string>
 #include <vector>
-#include <functional>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <chrono>
 
 /**
@@ -16,6 +23,17 @@
  * - Refund + payment reversal
  * - Snapshot restore + state update
  * 
+ * With the write-ahead log enabled, logChange() records each step's
+ * redo/undo pair and commit() returns once the commit record is durable
+ * 
+ * read()/write() on VersionedTables are optimistic: writes are buffered,
+ * and commit() installs them only if nothing the transaction read has
+ * changed since; otherwise it fails with hasConflict() and the caller
+ * retries (TransactionManager::runOptimistic)
+ * 
+ * lock() takes a pessimistic entity lock held until commit or rollback;
+ * a deadlock victim fails with hasConflict() as well
+ * 
  * Usage:
  *   Transaction tx;
  *   tx.begin();
@@ -29,45 +47,163 @@ public:
     enum class State { READY, ACTIVE, COMMITTED, ROLLED_BACK, FAILED };
     
     Transaction();
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
     
     // Transaction lifecycle
     void begin();
     void commit();
     void rollback();
     
-    // Register work to do
-    void execute(std::function<void()> operation, std::function<void()> rollbackOp = nullptr);
+    // Register work to do: runs the operation now and keeps only its
+    // rollback, stored inline when the callable is small
+    template <typename Op, typename Rb = std::nullptr_t>
+    void execute(Op&& operation, Rb&& rollbackOp = nullptr) {
+        requireActive();
+        try {
+            operation();
+        } catch (const std::exception& e) {
+            fail(e.what());
+            throw;
+        }
+        recordOperation(Rollback(std::forward<Rb>(rollbackOp)));
+    }
+    
+    // Write-ahead record for the next step (no-op while the WAL is disabled)
+    void logChange(std::string_view resource, std::string_view redo, std::string_view undo);
+    
+    // Optimistic record access; reads see this transaction's own writes
+    template <typename T>
+    bool read(VersionedTable<T>& table, int id, T& out);
+    template <typename T>
+    void write(VersionedTable<T>& table, int id, T value);
+    
+    /**
+     * Lock (type, entityId) until commit/rollback; on deadlock or timeout
+     * the transaction fails and false is returned
+     */
+    bool lock(EntityType type, int entityId, LockMode mode,
+              std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
     
     // Query transaction state
     State getState() const;
     std::string getStateString() const;
     bool isSuccessful() const;
+    bool hasConflict() const;   // Failed validation or deadlock victim; safe to retry
     const std::string& getErrorMessage() const;
     std::chrono::system_clock::time_point getStartTime() const;
+    std::uint64_t getId() const;   // Assigned by begin()
     
     // Diagnostic info
     size_t getOperationCount() const;
     
 private:
+    friend class TransactionManager;
+    
+    using Rollback = SmallFunction<void(), 48>;
+    
     struct Operation {
-        std::function<void()> execute;
-        std::function<void()> rollback;
+        Rollback rollback;
         bool completed = false;
     };
     
+    struct PendingWrite {
+        virtual ~PendingWrite() = default;
+        virtual void install() = 0;   // Called with the record locked
+    };
+    
+    template <typename T>
+    struct PendingValue : PendingWrite {
+        VersionedRecord<T>* record;
+        T value;
+        PendingValue(VersionedRecord<T>* rec, T v) : record(rec), value(std::move(v)) {}
+        void install() override {
+            record->value = std::move(value);
+            record->exists = true;
+        }
+    };
+    
+    struct ReadEntry {
+        VersionedRecordBase* record;
+        std::uint64_t version;   // Version when first read
+    };
+    
+    struct WriteEntry {
+        VersionedRecordBase* record;
+        std::unique_ptr<PendingWrite> value;
+    };
+    
+    enum class CommitResult { OK, CONFLICT, LOG_FAILED };
+    
     State state;
-    std::vector<Operation> operations;
+    std::uint64_t id = 0;
+    bool logged = false;   // Has records in the write-ahead log
+    SmallVector<Operation, 4> operations;   // Most transactions touch <= 4 services
+    SmallVector<ReadEntry, 8> readSet;
+    SmallVector<WriteEntry, 4> writeSet;
+    bool conflict = false;
+    bool holdsLocks = false;
     std::string errorMessage;
     std::chrono::system_clock::time_point startTime;
     
+    // Intrusive links for TransactionManager's active list / free list
+    Transaction* prevActive = nullptr;
+    Transaction* nextActive = nullptr;
+    
+    void requireActive() const;
+    void fail(const char* what);
+    void recordOperation(Rollback&& rollbackOp);
+    void reset();
     void applyRollbacks();
+    void logOutcome();
+    bool logCommit();
+    void trackRead(VersionedRecordBase* record, std::uint64_t version);
+    WriteEntry* findWrite(const VersionedRecordBase* record);
+    CommitResult validateAndInstall();
+    void failCommit(const char* reason);
+    void releaseLocks();
 };
 
+template <typename T>
+bool Transaction::read(VersionedTable<T>& table, int id, T& out) {
+    requireActive();
+    VersionedRecord<T>* rec = table.record(id);
+    if (WriteEntry* pending = findWrite(rec)) {
+        out = static_cast<PendingValue<T>*>(pending->value.get())->value;
+        return true;
+    }
+    
+    std::uint64_t version;
+    bool exists;
+    {
+        std::lock_guard<std::mutex> lock(rec->mutex);
+        version = rec->version;
+        exists = rec->exists;
+        if (exists) out = rec->value;
+    }
+    trackRead(rec, version);
+    return exists;
+}
+
+template <typename T>
+void Transaction::write(VersionedTable<T>& table, int id, T value) {
+    requireActive();
+    VersionedRecord<T>* rec = table.record(id);
+    if (WriteEntry* pending = findWrite(rec)) {
+        static_cast<PendingValue<T>*>(pending->value.get())->value = std::move(value);
+        return;
+    }
+    writeSet.emplace_back(WriteEntry{rec, std::make_unique<PendingValue<T>>(rec, std::move(value))});
+}
+
 /**
  * @class TransactionManager
  * @brief Global transaction coordinator
  * 
  * Tracks active transactions and provides diagnostics.
+ * Transactions come from a free-list pool allocated in chunks and are
+ * reused after removeTransaction; the active set is an intrusive list
+ * so removal is O(1).
  */
 class TransactionManager {
 public:
@@ -81,13 +217,68 @@ public:
     size_t getActiveTransactionCount() const;
     size_t getTotalCommittedTransactions() const;
     size_t getTotalFailedTransactions() const;
+    size_t getTotalConflicts() const;   // Optimistic commits that failed validation
+    
+    /**
+     * Run body(Transaction&) in a fresh transaction and commit it; on a
+     * conflict the body runs again from the start (so it must only act
+     * through the transaction), with backoff, up to maxAttempts times
+     * Returns whether an attempt committed. Exceptions from the body roll
+     * back and propagate
+     */
+    template <typename Body>
+    bool runOptimistic(Body&& body, int maxAttempts = 16);
+    
+    /**
+     * Recover and then use the write-ahead log at `path`; see WriteAheadLog
+     */
+    bool enableWriteAheadLog(const std::string& path,
+                             std::chrono::microseconds groupCommitWindow,
+                             const WriteAheadLog::ChangeHandler& redo,
+                             const WriteAheadLog::ChangeHandler& undo,
+                             WalRecoveryStats* stats = nullptr);
+    void disableWriteAheadLog();
+    WriteAheadLog& getWriteAheadLog() { return wal; }
     
 private:
     TransactionManager() = default;
     
-    std::vector<Transaction*> activeTransactions;
+    static constexpr size_t POOL_CHUNK = 64;
+    
+    static void backoff(int attempt);
+    
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Transaction[]>> chunks;   // Owns every pooled Transaction
+    Transaction* freeList = nullptr;                      // Linked through nextActive
+    Transaction* activeHead = nullptr;
+    size_t activeCount = 0;
+    WriteAheadLog wal;
     size_t totalCommitted = 0;
     size_t totalFailed = 0;
+    size_t totalConflicts = 0;
 };
 
+template <typename Body>
+bool TransactionManager::runOptimistic(Body&& body, int maxAttempts) {
+    for (int attempt = 1;; ++attempt) {
+        Transaction* tx = createTransaction();
+        tx->begin();
+        try {
+            body(*tx);
+        } catch (...) {
+            tx->rollback();
+            removeTransaction(tx);
+            throw;
+        }
+        tx->commit();
+        const bool committed = tx->isSuccessful();
+        const bool retry = tx->hasConflict();
+        removeTransaction(tx);
+        
+        if (committed) return true;
+        if (!retry || attempt >= maxAttempts) return false;
+        backoff(attempt);
+    }
+}
+
 #endif
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Version-Stamped Records
+ * Shared state that Transactions access optimistically: every committed
+ * write bumps the record's version, and a transaction commits only if the
+ * versions it read are unchanged (see Transaction::read / write).
+ * The record mutex is held just long enough to copy or install a value,
+ * never across a whole transaction. Records are never removed, so
+ * pointers stay valid for the table's lifetime
+ */
+struct VersionedRecordBase {
+    std::mutex mutex;
+    std::uint64_t version = 0;   // Guarded by mutex
+};
+
+template <typename T>
+struct VersionedRecord : VersionedRecordBase {
+    T value{};
+    bool exists = false;         // A read of a missing ID still pins its version
+};
+
+template <typename T>
+class VersionedTable {
+public:
+    VersionedTable() = default;
+    VersionedTable(const VersionedTable&) = delete;
+    VersionedTable& operator=(const VersionedTable&) = delete;
+
+    /**
+     * Non-transactional upsert (initial load); bumps the version
+     */
+    void put(int id, T value) {
+        VersionedRecord<T>* rec = record(id);
+        std::lock_guard<std::mutex> lock(rec->mutex);
+        rec->value = std::move(value);
+        rec->exists = true;
+        rec->version++;
+    }
+
+    /**
+     * Latest committed value; false if the ID was never written
+     */
+    bool get(int id, T& out) const {
+        VersionedRecord<T>* rec = find(id);
+        if (!rec) return false;
+        std::lock_guard<std::mutex> lock(rec->mutex);
+        if (!rec->exists) return false;
+        out = rec->value;
+        return true;
+    }
+
+    std::uint64_t getVersion(int id) const {
+        VersionedRecord<T>* rec = find(id);
+        if (!rec) return 0;
+        std::lock_guard<std::mutex> lock(rec->mutex);
+        return rec->version;
+    }
+
+    // Stable record for `id`, created (as missing) on first use
+    VersionedRecord<T>* record(int id) {
+        if (VersionedRecord<T>* rec = find(id)) return rec;
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto& slot = records[id];
+        if (!slot) slot = std::make_unique<VersionedRecord<T>>();
+        return slot.get();
+    }
+
+    std::size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return records.size();
+    }
+
+private:
+    VersionedRecord<T>* find(int id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = records.find(id);
+        return it == records.end() ? nullptr : it->second.get();
+    }
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<int, std::unique_ptr<VersionedRecord<T>>> records;
+};
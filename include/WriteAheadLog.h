@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/**
+ * Transaction Write-Ahead Log
+ * Transactions append a redo/undo pair per step and one commit record;
+ * commit() returns once that record is on disk. Concurrent commits share
+ * one write() + fdatasync (group commit): the first committer becomes the
+ * leader, optionally waits groupCommitWindow for others to join, then
+ * flushes everything appended so far while the rest wait.
+ *
+ * File layout (host byte order, varints are LEB128):
+ *   header : "RMSWAL01"
+ *   record : u32 body length, u32 FNV-1a of body, body
+ *   body   : u8 kind, varint transaction ID, then for CHANGE the resource,
+ *            redo and undo payloads as varint length + bytes
+ * A record whose checksum fails (torn write) ends recovery.
+ *
+ * open() replays the log: redo for committed transactions in log order,
+ * undo (newest first) for ones that never committed or aborted. A handler
+ * returns true once its change is durable, because the log is then
+ * truncated back to its header; if one returns false, open() fails and
+ * leaves the log as it was for the next attempt. A null handler discards
+ * that side of the log
+ */
+struct WalChange {
+    std::uint64_t transactionId;
+    std::string_view resource;
+    std::string_view redo;
+    std::string_view undo;
+};
+
+struct WalRecoveryStats {
+    std::size_t redone = 0;      // Changes re-applied from committed transactions
+    std::size_t undone = 0;      // Changes reversed from incomplete transactions
+    std::size_t committed = 0;
+    std::size_t incomplete = 0;
+};
+
+class WriteAheadLog {
+public:
+    using ChangeHandler = std::function<bool(const WalChange&)>;
+
+    WriteAheadLog() = default;
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * Recover `path` through redo/undo (either may be empty), then start
+     * a fresh log there. False, with the log untouched, if a handler failed
+     */
+    bool open(const std::string& path, const ChangeHandler& redo, const ChangeHandler& undo,
+              WalRecoveryStats* stats = nullptr);
+
+    // Flush pending records and close the file
+    void close();
+    bool isOpen() const { return accepting.load(std::memory_order_acquire); }
+
+    /**
+     * Longest a commit leader waits for others before flushing (0 = flush at once)
+     */
+    void setGroupCommitWindow(std::chrono::microseconds window);
+
+    /**
+     * Buffer one step's redo/undo pair; not durable until a later commit or flush
+     * Returns the log position after the record (0 if the log is closed)
+     */
+    std::uint64_t appendChange(std::uint64_t transactionId, std::string_view resource,
+                               std::string_view redo, std::string_view undo);
+
+    /**
+     * Append the commit record and wait until it is on disk
+     * False if the log is closed or the write failed
+     */
+    bool commit(std::uint64_t transactionId);
+
+    // Record that a transaction rolled back (not waited for)
+    void abort(std::uint64_t transactionId);
+
+    /**
+     * Block until everything up to `position` is on disk
+     */
+    bool flush(std::uint64_t position);
+
+    std::uint64_t getCommitCount() const { return commits.load(std::memory_order_relaxed); }
+    std::uint64_t getSyncCount() const { return syncs.load(std::memory_order_relaxed); }
+
+private:
+    enum Kind : std::uint8_t { CHANGE = 1, COMMIT = 2, ABORT = 3 };
+
+    std::uint64_t appendRecord(const std::string& body);
+    bool recover(const std::string& path, const ChangeHandler& redo, const ChangeHandler& undo,
+                 WalRecoveryStats& stats);
+
+    mutable std::mutex mutex;
+    std::condition_variable durableCv;   // Wakes commits waiting on the leader
+    std::atomic<bool> accepting{false};
+    std::string path;
+    int fd = -1;
+    std::chrono::microseconds groupCommitWindow{0};
+
+    std::string pending;                 // Appended, not yet written
+    std::string writing;                 // Leader's batch (buffer reused between flushes)
+    std::uint64_t appendedPosition = 0;  // Logical file size including pending
+    std::uint64_t durablePosition = 0;
+    bool flushing = false;               // A leader is writing
+    bool failed = false;                 // A write or fdatasync failed; no more commits
+
+    std::atomic<std::uint64_t> commits{0};
+    std::atomic<std::uint64_t> syncs{0};
+};
@@ -5,6 +5,7 @@
 #include "ServiceLocator.h"
 #include "BusinessRules.h"
 #include "EventSystem.h"
+#include "EventLog.h"
 #include "SoftDelete.h"
 #include "IdempotencyService.h"
 #include "SnapshotManager.h"
@@ -29,6 +30,45 @@ int main() {
     Config::initialize("config/config.txt");
     Config::logConfiguration();
     
+    const std::string logLevel = Config::getString("LOG_LEVEL", "INFO");
+    Logger::setLevel(logLevel == "DEBUG"   ? LogLevel::DEBUG :
+                     logLevel == "WARNING" ? LogLevel::WARNING :
+                     logLevel == "ERROR"   ? LogLevel::ERROR : LogLevel::INFO);
+    
+    // Optional binary structured log for LOGB call sites (decode with logdecode)
+    if (Config::getBool("LOG_BINARY")) {
+        Logger::enableBinary(Config::getString("LOG_BINARY_FILE", "restaurant.blog"));
+    }
+    
+    // Optional async logging (moves log I/O off the request path)
+    if (Config::getBool("LOG_ASYNC")) {
+        Logger::enableAsync(Config::getInt("LOG_RING_CAPACITY", 4096),
+                            Config::getString("LOG_OVERFLOW_POLICY", "DROP") == "BLOCK"
+                                ? LogOverflowPolicy::BLOCK : LogOverflowPolicy::DROP);
+    }
+    
+    // Size the idempotency fast-negative filter for the expected live keys
+    IdempotencyService::configureFilter(
+        static_cast<std::size_t>(Config::getInt("IDEMPOTENCY_FILTER_EXPECTED_KEYS", 1000000)),
+        Config::getDouble("IDEMPOTENCY_FILTER_FP_RATE", 0.01));
+    
+    // Optional durable idempotency log (request IDs survive a restart)
+    if (Config::getBool("IDEMPOTENCY_STORE_ENABLED")) {
+        IdempotencyService::enablePersistence(
+            Config::getString("IDEMPOTENCY_STORE_PATH", "data/idempotency.log"),
+            static_cast<std::size_t>(Config::getInt("IDEMPOTENCY_STORE_MB", 64)) * 1024 * 1024);
+    }
+    
+    // Optional transaction write-ahead log; recovery runs before any new transaction
+    if (Config::getBool("TRANSACTION_WAL_ENABLED")) {
+        TransactionManager::instance().enableWriteAheadLog(
+            Config::getString("TRANSACTION_WAL_PATH", "data/transactions.wal"),
+            std::chrono::microseconds(Config::getInt("TRANSACTION_WAL_GROUP_COMMIT_US", 0)),
+            OrderCommandService::redoChange, OrderCommandService::undoChange);
+    }
+    LockManager::instance().startDeadlockDetector(
+        std::chrono::milliseconds(Config::getInt("LOCK_DEADLOCK_CHECK_MS", 100)));
+    
     // Initialize service registry
     ServiceLocator::initialize();
     
@@ -36,6 +76,16 @@ int main() {
     extern void initializeEventListeners();
     initializeEventListeners();
     
+    // Optional durable event log (replayable into the bus after a restart)
+    if (Config::getBool("EVENT_LOG_ENABLED")) {
+        EventLog& eventLog = EventLog::getInstance();
+        if (eventLog.open(Config::getString("EVENT_LOG_DIR", "data/eventlog"),
+                          static_cast<std::size_t>(Config::getInt("EVENT_LOG_SEGMENT_MB", 16)) * 1024 * 1024,
+                          Config::getInt("EVENT_LOG_GROUP_COMMIT_MS", 5))) {
+            EventBus::getInstance().subscribe(&eventLog, DispatchMode::SYNC);
+        }
+    }
+    
     // ========================================================================
     // DEMONSTRATION: CONFIGURATION SYSTEM
     // ========================================================================
@@ -135,21 +185,23 @@ int main() {
     std::cout << "────────────────────────────────────────────────\n";
     
     EventBus& eventBus = EventBus::getInstance();
+    const EventSourceId orderService = EventSources::intern("OrderService");
+    const EventSourceId inventoryService = EventSources::intern("InventoryService");
     
     std::cout << "Emitting ORDER_PLACED event...\n";
-    Event e1 {EventType::ORDER_PLACED, 1, "Order", "Customer #101 placed order $450.00", time(nullptr), "OrderService"};
+    Event e1 {EventType::ORDER_PLACED, EntityType::ORDER, orderService, 1, time(nullptr), OrderPayload{101, 450.00}};
     eventBus.emit(e1);
     
     std::cout << "\nEmitting ORDER_CONFIRMED event...\n";
-    Event e2 {EventType::ORDER_CONFIRMED, 1, "Order", "Order confirmed by staff", time(nullptr), "OrderService"};
+    Event e2 {EventType::ORDER_CONFIRMED, EntityType::ORDER, orderService, 1, time(nullptr), OrderPayload{101, 450.00}};
     eventBus.emit(e2);
     
     std::cout << "\nEmitting INVENTORY_LOW event...\n";
-    Event e3 {EventType::INVENTORY_LOW, 42, "Inventory", "Rice inventory below reorder level", time(nullptr), "InventoryService"};
+    Event e3 {EventType::INVENTORY_LOW, EntityType::INVENTORY, inventoryService, 42, time(nullptr), InventoryPayload{3, 10}};
     eventBus.emit(e3);
     
     std::cout << "\nEmitting ORDER_SERVED event...\n";
-    Event e4 {EventType::ORDER_SERVED, 1, "Order", "Order ready and served to customer", time(nullptr), "OrderService"};
+    Event e4 {EventType::ORDER_SERVED, EntityType::ORDER, orderService, 1, time(nullptr), OrderPayload{101, 450.00}};
     eventBus.emit(e4);
     
     // ========================================================================
@@ -219,6 +271,9 @@ int main() {
     
     std::cout << "\nIdempotency status: " << IdempotencyService::getTrackedCount() 
               << " request(s) tracked\n";
+    const IdempotencyFilterStats filterStats = IdempotencyService::getFilterStats();
+    std::cout << "Filter: " << filterStats.definitelyNew << " answered without the registry, "
+              << filterStats.falsePositives << " false positive(s)\n";
     
     // ========================================================================
     // DEMONSTRATION: SNAPSHOT-BASED RECOVERY (TIER-3 Feature #8)
@@ -426,19 +481,21 @@ int main() {
         std::cout << "  WRITE: Creating order via command service...\n";
         std::vector<MenuItem> items;
         MenuItem item1;
-        item1.id = "BURGER";
+        item1.id = 1;
         item1.name = "Burger";
+        item1.category = "Mains";
         item1.price = 12.99;
         items.push_back(item1);
         
-        Order newOrder = commandSvc.createOrder("CUST-001", items, "REQ-12345");
-        std::cout << "  ✓ Order created: " << newOrder.id << " (Total: $" 
+        Order newOrder = commandSvc.createOrder(1, items, "REQ-12345");
+        std::cout << "  ✓ Order created: " << newOrder.orderId << " (Total: $" 
                   << std::fixed << std::setprecision(2) << newOrder.total << ")\n";
         
         // WRITE: Confirm order via command service
         std::cout << "  WRITE: Confirming order...\n";
-        commandSvc.confirmOrder(newOrder.id);
-        std::cout << "  ✓ Order confirmed\n";
+        if (commandSvc.confirmOrder(newOrder.orderId)) {
+            std::cout << "  ✓ Order confirmed\n";
+        }
         
         // READ: Query orders via query service (no side effects)
         std::cout << "  READ: Querying active orders...\n";
@@ -446,12 +503,12 @@ int main() {
         std::cout << "  ✓ Active orders count: " << activeOrders.size() << "\n";
         
         std::cout << "  READ: Querying customer orders...\n";
-        auto customerOrders = querySvc.getOrdersByCustomer("CUST-001");
+        auto customerOrders = querySvc.getOrdersByCustomer(1);
         std::cout << "  ✓ Customer orders: " << customerOrders.size() << "\n";
         
         std::cout << "  READ: Getting last order...\n";
         Order lastOrder = querySvc.getLastOrder();
-        std::cout << "  ✓ Last order: " << lastOrder.id << "\n";
+        std::cout << "  ✓ Last order: " << lastOrder.orderId << "\n";
     }
     std::cout << "  🎯 CQRS Benefits:\n";
     std::cout << "     - Writes optimized for consistency\n";
@@ -476,17 +533,17 @@ int main() {
         
         // Create and save a menu item
         MenuItem burger;
-        burger.id = "BURGER";
+        burger.id = 901;
         burger.name = "Gourmet Burger";
+        burger.category = "Mains";
         burger.price = 14.99;
-        burger.quantityAvailable = 25;
         
         if (storage.saveMenuItem(burger)) {
             std::cout << "    ✓ Saved menu item via abstract interface\n";
         }
         
         // Load it back
-        MenuItem loaded = storage.loadMenuItem("BURGER");
+        MenuItem loaded = storage.loadMenuItem(901);
         std::cout << "    ✓ Loaded: " << loaded.name << " ($" 
                   << std::fixed << std::setprecision(2) << loaded.price << ")\n";
         
@@ -497,6 +554,12 @@ int main() {
         std::cout << "    - Zero business logic changes\n";
     }
 
+    // Make logged events durable, then drain async log rings before exit
+    EventLog::getInstance().close();
+    IdempotencyService::disablePersistence();
+    LockManager::instance().stopDeadlockDetector();
+    TransactionManager::instance().disableWriteAheadLog();
+    Logger::shutdown();
     return 0;
 }
 
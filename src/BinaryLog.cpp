@@ -0,0 +1,129 @@
+#include "BinaryLog.h"
+#include "Logger.h"
+#include <cstdio>
+#include <ctime>
+#include <iterator>
+#include <vector>
+
+namespace BinaryLog {
+
+template <typename T>
+static bool get(const char* data, std::size_t size, std::size_t& pos, T& value) {
+    if (pos + sizeof(T) > size) return false;
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+static bool appendArg(const char* data, std::size_t size, std::size_t& pos, std::string& out) {
+    std::uint8_t type;
+    if (!get(data, size, pos, type)) return false;
+    switch (type) {
+        case ARG_INT: {
+            std::uint64_t zz;
+            if (!getVarint(data, size, pos, zz)) return false;
+            out += std::to_string(unzigzag(zz));
+            return true;
+        }
+        case ARG_DOUBLE: {
+            double v;
+            if (!get(data, size, pos, v)) return false;
+            out += std::to_string(v);
+            return true;
+        }
+        case ARG_STRING: {
+            std::uint64_t len;
+            if (!getVarint(data, size, pos, len) || pos + len > size) return false;
+            out.append(data + pos, len);
+            pos += len;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool render(const std::string& format, const char* payload, std::size_t size,
+            std::uint8_t argc, std::string& out, std::size_t* consumed) {
+    std::size_t pos = 0;
+    std::uint8_t used = 0;
+    for (std::size_t i = 0; i < format.size(); ++i) {
+        if (format[i] == '{' && i + 1 < format.size() && format[i + 1] == '}' && used < argc) {
+            if (!appendArg(payload, size, pos, out)) return false;
+            ++used;
+            ++i;
+        } else {
+            out += format[i];
+        }
+    }
+    // Extra args without a placeholder are appended so nothing is silently lost
+    for (; used < argc; ++used) {
+        out += ' ';
+        if (!appendArg(payload, size, pos, out)) return false;
+    }
+    if (consumed) *consumed = pos;
+    return true;
+}
+
+long decode(std::istream& in, std::ostream& out) {
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return -1;
+    }
+
+    struct FormatDef { LogLevel level = LogLevel::INFO; std::string text; };
+    std::vector<FormatDef> formats;
+
+    const char* p = data.data();
+    const std::size_t size = data.size();
+    std::size_t pos = sizeof(MAGIC);
+    long records = 0;
+    std::uint64_t nanos = 0;
+    std::string message, line;
+
+    while (pos < size) {
+        // Every session appends its own header: new format table, timestamps from zero
+        if (size - pos >= sizeof(MAGIC) && std::memcmp(p + pos, MAGIC, sizeof(MAGIC)) == 0) {
+            formats.clear();
+            nanos = 0;
+            pos += sizeof(MAGIC);
+            continue;
+        }
+        std::uint8_t kind;
+        std::uint16_t id;
+        if (!get(p, size, pos, kind) || !get(p, size, pos, id)) break;
+
+        if (kind == FORMAT_DEF) {
+            std::uint8_t level;
+            std::uint16_t len;
+            if (!get(p, size, pos, level) || !get(p, size, pos, len) || pos + len > size) break;
+            if (formats.size() <= id) formats.resize(id + 1);
+            formats[id].level = static_cast<LogLevel>(level);
+            formats[id].text.assign(p + pos, len);
+            pos += len;
+        } else if (kind == RECORD) {
+            std::uint64_t delta;
+            std::uint8_t argc;
+            if (!getVarint(p, size, pos, delta) || !get(p, size, pos, argc)) break;
+            nanos += delta;
+
+            const FormatDef unknown{LogLevel::INFO, "<unknown format " + std::to_string(id) + ">"};
+            const FormatDef& fmt = id < formats.size() && !formats[id].text.empty() ? formats[id] : unknown;
+
+            message.clear();
+            std::size_t used = 0;
+            if (!render(fmt.text, p + pos, size - pos, argc, message, &used)) break;
+            pos += used;
+
+            line.clear();
+            Logger::formatLine(line, fmt.level, static_cast<std::time_t>(nanos / 1000000000), message);
+            out << line;
+            ++records;
+        } else {
+            break;  // Corrupt or truncated tail
+        }
+    }
+    return records;
+}
+
+} // namespace BinaryLog
@@ -0,0 +1,380 @@
+#include "CachingStorageStrategy.h"
+#include "Logger.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+int keyOf(const CustomerRecord& customer) { return customer.id; }
+int keyOf(const MenuItem& item) { return item.id; }
+int keyOf(const Order& order) { return order.orderId; }
+
+bool saveAll(StorageStrategy& backend, const CustomerRecord* records, std::size_t count) {
+    return backend.saveCustomers(records, count);
+}
+bool saveAll(StorageStrategy& backend, const MenuItem* records, std::size_t count) {
+    return backend.saveMenuItems(records, count);
+}
+bool saveAll(StorageStrategy& backend, const Order* records, std::size_t count) {
+    return backend.saveOrders(records, count);
+}
+
+bool removeOne(StorageStrategy& backend, int id, const CustomerRecord*) { return backend.deleteCustomer(id); }
+bool removeOne(StorageStrategy& backend, int id, const MenuItem*) { return backend.deleteMenuItem(id); }
+bool removeOne(StorageStrategy& backend, int id, const Order*) { return backend.deleteOrder(id); }
+
+} // namespace
+
+CachingStorageStrategy::CachingStorageStrategy(std::unique_ptr<StorageStrategy> inner,
+                                               const StorageCacheOptions& cacheOptions)
+    : backend(std::move(inner)), options(cacheOptions) {
+    background = std::thread(&CachingStorageStrategy::backgroundLoop, this);
+}
+
+CachingStorageStrategy::~CachingStorageStrategy() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workCv.notify_all();
+    doneCv.notify_all();
+    if (background.joinable()) background.join();
+    if (!flushOnce()) {
+        Logger::log(LogLevel::ERROR, "STORAGE: Cache closed with unwritten records (" + backend->getName() + ")");
+    }
+}
+
+// ============ Table operations (mutex held) ============
+
+template <typename Record>
+typename CachingStorageStrategy::Table<Record>::Slot& CachingStorageStrategy::slotFor(Table<Record>& table, int id) {
+    auto [it, inserted] = table.slots.try_emplace(id);
+    if (inserted) {
+        table.lru.push_front(id);
+        it->second.recent = table.lru.begin();
+    } else {
+        table.lru.splice(table.lru.begin(), table.lru, it->second.recent);
+    }
+    return it->second;
+}
+
+template <typename Record>
+void CachingStorageStrategy::markDirty(Table<Record>& table, int id, typename Table<Record>::Slot& slot,
+                                       std::uint64_t seq) {
+    slot.dirty = true;
+    slot.version = seq;
+    if (!slot.queued) {
+        slot.queued = true;
+        table.dirtyIds.push_back(id);
+    }
+}
+
+template <typename Record>
+void CachingStorageStrategy::evict(Table<Record>& table) {
+    // Least recently used clean slots go first; dirty ones stay until written
+    auto it = table.lru.end();
+    while (table.slots.size() > options.capacity && it != table.lru.begin()) {
+        --it;
+        const auto slot = table.slots.find(*it);
+        if (slot->second.dirty) continue;
+        table.slots.erase(slot);
+        it = table.lru.erase(it);
+        table.evictions++;
+    }
+}
+
+template <typename Record>
+void CachingStorageStrategy::collect(Table<Record>& table, Batch<Record>& batch) {
+    for (int id : table.dirtyIds) {
+        auto& slot = table.slots.at(id);   // Dirty slots are never evicted
+        slot.queued = false;
+        batch.saves.push_back(slot.record);
+        batch.versions.emplace_back(id, slot.version);
+    }
+    table.dirtyIds.clear();
+}
+
+template <typename Record>
+void CachingStorageStrategy::settle(Table<Record>& table, const Batch<Record>& batch, bool ok) {
+    for (const auto& [id, version] : batch.versions) {
+        auto& slot = table.slots.at(id);
+        if (ok && slot.version == version) {
+            slot.dirty = false;   // Written; a newer version is already queued otherwise
+        } else if (!ok && !slot.queued) {
+            slot.queued = true;   // Retry with the next batch
+            table.dirtyIds.push_back(id);
+        }
+    }
+    if (ok) evict(table);
+}
+
+// ============ Reads and writes ============
+
+std::uint64_t CachingStorageStrategy::admit(std::unique_lock<std::mutex>& lock) {
+    if (options.durability == StorageCacheOptions::Durability::PERIODIC) {
+        // Backpressure: writers outrunning the backend wait for a batch to land
+        while (!stopping && dirtyCount() >= 2 * options.maxDirty) {
+            flushRequested = true;
+            workCv.notify_one();
+            doneCv.wait(lock);
+        }
+    }
+    return ++writeSeq;
+}
+
+bool CachingStorageStrategy::commit(std::unique_lock<std::mutex>& lock, std::uint64_t seq) {
+    if (options.durability == StorageCacheOptions::Durability::PERIODIC) {
+        if (dirtyCount() >= options.maxDirty) {
+            flushRequested = true;
+            workCv.notify_one();
+        }
+        return true;
+    }
+    // Group commit: whoever is waiting when the flusher wakes shares its batch
+    flushRequested = true;
+    workCv.notify_one();
+    doneCv.wait(lock, [&] { return stopping || flushedSeq >= seq || failedSeq >= seq; });
+    return flushedSeq >= seq;
+}
+
+template <typename Record>
+bool CachingStorageStrategy::put(Table<Record>& table, const Record* records, std::size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const std::uint64_t seq = admit(lock);
+    for (std::size_t i = 0; i < count; ++i) {
+        const int id = keyOf(records[i]);
+        auto& slot = slotFor(table, id);
+        slot.record = records[i];
+        slot.missing = false;
+        markDirty(table, id, slot, seq);
+    }
+    evict(table);
+    return commit(lock, seq);
+}
+
+template <typename Record>
+bool CachingStorageStrategy::erase(Table<Record>& table, int id) {
+    // What a delete leaves behind is the backend's business (CSV customers
+    // are soft-deleted), so it goes straight through once earlier saves landed
+    flush();
+    std::lock_guard<std::mutex> flushLock(flushMutex);
+    const bool ok = removeOne(*backend, id, static_cast<const Record*>(nullptr));
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = table.slots.find(id);
+    if (it != table.slots.end() && !it->second.dirty) {   // A dirty slot was saved again meanwhile
+        table.lru.erase(it->second.recent);
+        table.slots.erase(it);
+    }
+    table.evictions++;   // Loads already under way must not cache what they read
+    return ok;
+}
+
+template <typename Record, typename Load>
+Record CachingStorageStrategy::get(Table<Record>& table, int id, Load&& load) {
+    std::uint64_t evictions;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = table.slots.find(id);
+        if (it != table.slots.end()) {
+            stats.hits++;
+            table.lru.splice(table.lru.begin(), table.lru, it->second.recent);
+            return it->second.missing ? Record{} : it->second.record;
+        }
+        stats.misses++;
+        evictions = table.evictions;
+    }
+
+    Record record = load(id);
+    std::lock_guard<std::mutex> lock(mutex);
+    // A slot that appeared meanwhile is newer; without evictions in
+    // between, a missing slot means nobody wrote this ID meanwhile
+    const auto it = table.slots.find(id);
+    if (it != table.slots.end()) return it->second.missing ? Record{} : it->second.record;
+    if (table.evictions != evictions) return record;
+    auto& slot = slotFor(table, id);
+    slot.missing = keyOf(record) != id;   // Remember "not found" too
+    if (!slot.missing) slot.record = record;
+    evict(table);
+    return record;
+}
+
+std::size_t CachingStorageStrategy::dirtyCount() const {
+    return customers.dirtyIds.size() + menuItems.dirtyIds.size() + orders.dirtyIds.size();
+}
+
+// ============ Flushing ============
+
+template <typename Record>
+bool CachingStorageStrategy::writeBatch(const Batch<Record>& batch) {
+    return batch.saves.empty() || saveAll(*backend, batch.saves.data(), batch.saves.size());
+}
+
+bool CachingStorageStrategy::flushOnce() {
+    std::lock_guard<std::mutex> flushLock(flushMutex);
+    Batch<CustomerRecord> customerBatch;
+    Batch<MenuItem> menuItemBatch;
+    Batch<Order> orderBatch;
+    std::uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        collect(customers, customerBatch);
+        collect(menuItems, menuItemBatch);
+        collect(orders, orderBatch);
+        seq = writeSeq;
+        flushRequested = false;
+    }
+    const std::size_t records = customerBatch.versions.size() + menuItemBatch.versions.size() +
+                                orderBatch.versions.size();
+    if (records == 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        flushedSeq = seq;   // Earlier batches have landed (or were re-queued)
+        doneCv.notify_all();
+        return true;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool customersOk = writeBatch(customerBatch);
+    const bool menuItemsOk = writeBatch(menuItemBatch);
+    const bool ordersOk = writeBatch(orderBatch);
+    const bool ok = backend->flush() && customersOk && menuItemsOk && ordersOk;
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    settle(customers, customerBatch, ok);
+    settle(menuItems, menuItemBatch, ok);
+    settle(orders, orderBatch, ok);
+    stats.flushes++;
+    stats.lastFlushMs = ms;
+    stats.maxFlushMs = std::max(stats.maxFlushMs, ms);
+    stats.totalFlushMs += ms;
+    if (ok) {
+        stats.flushedRecords += records;
+        flushedSeq = seq;
+    } else {
+        stats.flushFailures++;
+        failedSeq = seq;
+        Logger::log(LogLevel::ERROR, "STORAGE: Cache flush of " + std::to_string(records) + " records to " +
+                                     backend->getName() + " failed, will retry");
+    }
+    doneCv.notify_all();
+    return ok;
+}
+
+void CachingStorageStrategy::backgroundLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        if (options.durability == StorageCacheOptions::Durability::SYNC_ON_COMMIT) {
+            workCv.wait(lock, [this] { return stopping || flushRequested; });
+        } else {
+            workCv.wait_for(lock, options.flushInterval, [this] { return stopping || flushRequested; });
+        }
+        if (stopping) return;   // The destructor writes what is left
+        if (dirtyCount() == 0 && !flushRequested) continue;
+        lock.unlock();
+        flushOnce();
+        lock.lock();
+    }
+}
+
+bool CachingStorageStrategy::flush() {
+    return flushOnce();
+}
+
+// ============ StorageStrategy interface ============
+
+bool CachingStorageStrategy::saveCustomer(const CustomerRecord& customer) {
+    return put(customers, &customer, 1);
+}
+
+CustomerRecord CachingStorageStrategy::loadCustomer(int id) {
+    return get(customers, id, [this](int key) { return backend->loadCustomer(key); });
+}
+
+std::vector<CustomerRecord> CachingStorageStrategy::loadAllCustomers() {
+    flush();
+    return backend->loadAllCustomers();
+}
+
+bool CachingStorageStrategy::deleteCustomer(int id) {
+    return erase(customers, id);
+}
+
+bool CachingStorageStrategy::saveMenuItem(const MenuItem& item) {
+    return put(menuItems, &item, 1);
+}
+
+MenuItem CachingStorageStrategy::loadMenuItem(int id) {
+    return get(menuItems, id, [this](int key) { return backend->loadMenuItem(key); });
+}
+
+std::vector<MenuItem> CachingStorageStrategy::loadAllMenuItems() {
+    flush();
+    return backend->loadAllMenuItems();
+}
+
+bool CachingStorageStrategy::deleteMenuItem(int id) {
+    return erase(menuItems, id);
+}
+
+bool CachingStorageStrategy::saveOrder(const Order& order) {
+    return put(orders, &order, 1);
+}
+
+Order CachingStorageStrategy::loadOrder(int id) {
+    return get(orders, id, [this](int key) { return backend->loadOrder(key); });
+}
+
+std::vector<Order> CachingStorageStrategy::loadAllOrders() {
+    flush();
+    return backend->loadAllOrders();
+}
+
+bool CachingStorageStrategy::deleteOrder(int id) {
+    return erase(orders, id);
+}
+
+bool CachingStorageStrategy::saveCustomers(const CustomerRecord* records, std::size_t count) {
+    return put(customers, records, count);
+}
+
+bool CachingStorageStrategy::saveMenuItems(const MenuItem* items, std::size_t count) {
+    return put(menuItems, items, count);
+}
+
+bool CachingStorageStrategy::saveOrders(const Order* records, std::size_t count) {
+    return put(orders, records, count);
+}
+
+std::size_t CachingStorageStrategy::forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                                    const RecordVisitor<CustomerRecord>& visitor) {
+    flush();
+    return backend->forEachCustomer(predicate, visitor);
+}
+
+std::size_t CachingStorageStrategy::forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                                    const RecordVisitor<MenuItem>& visitor) {
+    flush();
+    return backend->forEachMenuItem(predicate, visitor);
+}
+
+std::size_t CachingStorageStrategy::forEachOrder(const RecordPredicate<Order>& predicate,
+                                                 const RecordVisitor<Order>& visitor) {
+    flush();
+    return backend->forEachOrder(predicate, visitor);
+}
+
+bool CachingStorageStrategy::isHealthy() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failedSeq > flushedSeq) return false;   // The last batch did not land
+    }
+    return backend->isHealthy();
+}
+
+StorageCacheStats CachingStorageStrategy::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    StorageCacheStats snapshot = stats;
+    snapshot.cachedRecords = customers.slots.size() + menuItems.slots.size() + orders.slots.size();
+    snapshot.dirtyRecords = dirtyCount();
+    return snapshot;
+}
@@ -2,6 +2,46 @@
 #include "Logger.h"
 #include "BusinessRules.h"
 #include "EventSystem.h"
+#include "TransactionManager.h"
+#include <initializer_list>
+#include <utility>
+
+namespace {
+
+/**
+ * Run `step` in a transaction holding exclusive locks on `entities`, so
+ * commands touching the same order can run on different threads
+ * Entities are always locked in the order given (ORDER before PAYMENT);
+ * a deadlock victim retries
+ */
+template <typename Step>
+bool runLocked(std::initializer_list<std::pair<EntityType, int>> entities, Step&& step) {
+    auto& tm = TransactionManager::instance();
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        Transaction* tx = tm.createTransaction();
+        tx->begin();
+        bool locked = true;
+        for (const auto& entity : entities) {
+            if (!(locked = tx->lock(entity.first, entity.second, LockMode::EXCLUSIVE))) break;
+        }
+        if (locked) {
+            try {
+                tx->execute(step);
+            } catch (const std::exception&) {
+                // Transaction is FAILED; commit() rolls back
+            }
+        }
+        tx->commit();
+        const bool committed = tx->isSuccessful();
+        const bool retry = tx->hasConflict();
+        tm.removeTransaction(tx);
+        if (committed) return true;
+        if (!retry) return false;
+    }
+    return false;
+}
+
+} // namespace
 
 // Static members
 CommandInvoker* CommandInvoker::instance = nullptr;
@@ -57,9 +97,9 @@ void CommandInvoker::replayCommands() {
 // PlaceOrderCommand
 bool PlaceOrderCommand::execute() {
     Logger::log(LogLevel::INFO, "PlaceOrderCommand: Processing");
-    Event evt;
-    evt.type = EventType::ORDER_PLACED;
-    evt.timestamp = std::time(nullptr);
+    static const EventSourceId source = EventSources::intern("PlaceOrderCommand");
+    Event evt{EventType::ORDER_PLACED, EntityType::ORDER, source, order.orderId, std::time(nullptr),
+              OrderPayload{order.customerId, order.total}};
     EventBus::getInstance().emit(evt);
     return true;
 }
@@ -80,11 +120,11 @@ std::string PlaceOrderCommand::getDescription() const {
 // CancelOrderCommand
 bool CancelOrderCommand::execute() {
     Logger::log(LogLevel::INFO, "CancelOrderCommand #" + std::to_string(orderId));
-    Event evt;
-    evt.type = EventType::ORDER_CANCELLED;
-    evt.timestamp = std::time(nullptr);
-    EventBus::getInstance().emit(evt);
-    return true;
+    static const EventSourceId source = EventSources::intern("CancelOrderCommand");
+    return runLocked({{EntityType::ORDER, orderId}, {EntityType::PAYMENT, orderId}}, [this] {
+        Event evt{EventType::ORDER_CANCELLED, EntityType::ORDER, source, orderId, std::time(nullptr), {}};
+        EventBus::getInstance().emit(evt);
+    });
 }
 
 bool CancelOrderCommand::undo() {
@@ -103,11 +143,12 @@ std::string CancelOrderCommand::getDescription() const {
 // IssueRefundCommand
 bool IssueRefundCommand::execute() {
     Logger::log(LogLevel::INFO, "IssueRefundCommand: $" + std::to_string(amount));
-    Event evt;
-    evt.type = EventType::REFUND_ISSUED;
-    evt.timestamp = std::time(nullptr);
-    EventBus::getInstance().emit(evt);
-    return true;
+    static const EventSourceId source = EventSources::intern("IssueRefundCommand");
+    return runLocked({{EntityType::ORDER, orderId}, {EntityType::PAYMENT, orderId}}, [this] {
+        Event evt{EventType::REFUND_ISSUED, EntityType::PAYMENT, source, orderId, std::time(nullptr),
+                  PaymentPayload{orderId, amount}};
+        EventBus::getInstance().emit(evt);
+    });
 }
 
 bool IssueRefundCommand::undo() {
@@ -126,9 +167,8 @@ std::string IssueRefundCommand::getDescription() const {
 // ConfirmOrderCommand
 bool ConfirmOrderCommand::execute() {
     Logger::log(LogLevel::INFO, "ConfirmOrderCommand #" + std::to_string(orderId));
-    Event evt;
-    evt.type = EventType::ORDER_CONFIRMED;
-    evt.timestamp = std::time(nullptr);
+    static const EventSourceId source = EventSources::intern("ConfirmOrderCommand");
+    Event evt{EventType::ORDER_CONFIRMED, EntityType::ORDER, source, orderId, std::time(nullptr), {}};
     EventBus::getInstance().emit(evt);
     return true;
 }
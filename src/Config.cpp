@@ -94,7 +94,7 @@ bool Config::exists(const std::string& key) {
 void Config::logConfiguration() {
     Logger::log(LogLevel::INFO, "=== LOADED CONFIGURATION ===");
     for (const auto& pair : configMap) {
-        Logger::log(LogLevel::DEBUG, pair.first + " = " + pair.second);
+        LOGF_DEBUG(pair.first, " = ", pair.second);
     }
     Logger::log(LogLevel::INFO, "=============================");
 }
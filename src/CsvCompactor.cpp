@@ -0,0 +1,211 @@
+#include "CsvCompactor.h"
+#include "Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t CHUNK_BYTES = 64 * 1024;   // Write and pacing granularity
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+std::uint64_t fileBytes(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+}
+
+} // namespace
+
+CsvCompactor::CsvCompactor(const CsvCompactionOptions& compactionOptions) : options(compactionOptions) {}
+
+CsvCompactor::~CsvCompactor() {
+    stop();
+}
+
+void CsvCompactor::addFile(CsvIndex& index, ExpiredFn expired) {
+    std::lock_guard<std::mutex> lock(compactionMutex);
+    files.push_back({&index, std::move(expired)});
+}
+
+void CsvCompactor::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (background.joinable()) return;
+    stopping = false;
+    background = std::thread(&CsvCompactor::backgroundLoop, this);
+}
+
+void CsvCompactor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCv.notify_all();
+    if (background.joinable()) background.join();
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;   // compactAll() still works
+}
+
+bool CsvCompactor::compactAll() {
+    std::lock_guard<std::mutex> lock(compactionMutex);
+    bool ok = true;
+    for (File& file : files) ok = compact(file) && ok;
+    return ok;
+}
+
+CsvCompactionStats CsvCompactor::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool CsvCompactor::pace(std::uint64_t bytes) {
+    pacedBytes += bytes;
+    std::unique_lock<std::mutex> lock(mutex);
+    if (options.bytesPerSecond > 0) {
+        const std::chrono::duration<double> budget(static_cast<double>(pacedBytes) / options.bytesPerSecond);
+        const auto due = paceStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget);
+        wakeCv.wait_until(lock, due, [this] { return stopping; });
+    }
+    return !stopping;
+}
+
+bool CsvCompactor::compact(File& file) {
+    const std::string& path = file.index->getDataPath();
+    std::uint64_t dataBytes;
+    if (!file.index->flush(dataBytes)) return false;
+    CsvReader reader;
+    if (dataBytes == 0 || !reader.open(path)) return true;   // Nothing stored yet
+    if (reader.size() < dataBytes) return false;              // Replaced since the flush
+    paceStart = std::chrono::steady_clock::now();
+    pacedBytes = 0;
+
+    // Pass 1: where each ID's latest row starts. Rows past dataBytes
+    // arrived after the flush; replaceData carries them over
+    std::unordered_map<int, std::uint64_t> latest;
+    std::uint64_t paced = 0;
+    bool running = true;
+    reader.streamRows([&](const CsvRow& row) {
+        if (row.offset >= dataBytes) return false;
+        int id;
+        if (row.get(0, id)) latest[id] = row.offset;
+        if (row.offset - paced >= CHUNK_BYTES) {
+            running = pace(row.offset - paced);
+            paced = row.offset;
+        }
+        return running;
+    });
+    if (!running) return true;
+
+    // Pass 2: copy each latest row unless its record expired
+    const std::string tmpPath = path + ".compact";
+    const int out = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        Logger::log(LogLevel::ERROR, "CsvCompactor: Cannot create " + tmpPath + ": " + std::strerror(errno));
+        return false;
+    }
+    const std::time_t horizon = std::time(nullptr) - options.retentionSeconds;
+    std::string buffer;
+    std::uint64_t written = 0, kept = 0, dropped = 0;
+    bool ok = true;
+    const auto drain = [&] {
+        ok = ok && writeAll(out, buffer.data(), buffer.size());
+        running = running && pace(buffer.size());
+        written += buffer.size();
+        buffer.clear();
+    };
+    // A kept row is copied once the next row shows where it ends
+    std::uint64_t keptStart = 0;
+    bool keptPending = false;
+    const auto finishRow = [&](std::uint64_t end) {
+        if (!keptPending) return;
+        buffer.append(reader.data() + keptStart, static_cast<std::size_t>(end - keptStart));
+        if (buffer.back() != '\n') buffer += '\n';
+        keptPending = false;
+        if (buffer.size() >= CHUNK_BYTES) drain();
+    };
+    paced = 0;
+    reader.streamRows([&](const CsvRow& row) {
+        if (row.offset >= dataBytes) return false;
+        finishRow(row.offset);
+        int id;
+        const auto it = row.get(0, id) ? latest.find(id) : latest.end();
+        if (it != latest.end() && it->second == row.offset && !(file.expired && file.expired(row, horizon))) {
+            keptStart = row.offset;
+            keptPending = true;
+            kept++;
+        } else {
+            dropped++;
+        }
+        if (row.offset - paced >= CHUNK_BYTES) {
+            running = running && pace(row.offset - paced);
+            paced = row.offset;
+        }
+        return ok && running;
+    });
+    finishRow(dataBytes);
+    if (!buffer.empty()) drain();
+    ::close(out);
+    reader.close();
+
+    std::error_code ec;
+    if (!ok) {
+        Logger::log(LogLevel::ERROR, "CsvCompactor: Cannot write " + tmpPath + ": " + std::strerror(errno));
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    if (!running || dropped == 0) {
+        fs::remove(tmpPath, ec);   // Stopped, or nothing to reclaim
+        if (running) file.compactedBytes = dataBytes;
+        return true;
+    }
+    if (!file.index->replaceData(tmpPath, dataBytes)) return false;
+    file.compactedBytes = fileBytes(path);
+
+    LOGF_INFO("CsvCompactor: Rewrote ", path, ": ", dataBytes, " -> ", written, " bytes, ", kept, " rows kept, ",
+              dropped, " dropped");
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.compactions++;
+    stats.rowsKept += kept;
+    stats.rowsDropped += dropped;
+    stats.bytesReclaimed += dataBytes - written;
+    return true;
+}
+
+void CsvCompactor::backgroundLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeCv.wait_for(lock, options.interval, [this] { return stopping; });
+        if (stopping) return;
+        lock.unlock();
+        {
+            // Rewrite the next file that has grown enough, round robin
+            std::lock_guard<std::mutex> compactionLock(compactionMutex);
+            for (std::size_t i = 0; i < files.size(); ++i) {
+                File& file = files[(nextFile + i) % files.size()];
+                const std::uint64_t size = fileBytes(file.index->getDataPath());
+                if (size < options.minBytes || size < file.compactedBytes * options.growthFactor) continue;
+                nextFile = (nextFile + i + 1) % files.size();
+                compact(file);
+                break;
+            }
+        }
+        lock.lock();
+    }
+}
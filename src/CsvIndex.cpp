@@ -0,0 +1,462 @@
+#include "CsvIndex.h"
+#include "CsvReader.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'R', 'M', 'S', 'I', 'D', 'X', '0', '1'};
+constexpr std::size_t COVERED_AT = sizeof(INDEX_MAGIC);
+constexpr std::size_t SORTED_AT = COVERED_AT + sizeof(std::uint64_t);
+constexpr std::size_t INDEX_HEADER = SORTED_AT + sizeof(std::uint64_t);
+constexpr int SWAP_ROUNDS = 8;                            // replaceData catch-up passes before locking
+constexpr std::uint64_t SWAP_LOCKED_BYTES = 256 * 1024;   // Small enough to copy while writers wait
+constexpr std::uint64_t SCAN_RELEASE_ENTRIES = 64 * 1024;   // openLatest drops index pages this often
+
+bool writeAt(int fd, const void* data, std::size_t size, std::uint64_t offset) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const auto n = ::pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+// `written` (if given) counts the bytes that reached the file, also on failure
+bool writeAll(int fd, const char* data, std::size_t size, std::size_t* written = nullptr) {
+    if (written) *written = 0;
+    while (size > 0) {
+        const auto n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        if (written) *written += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Append bytes [from, to) of `in` to `out`
+bool copyRange(int in, int out, std::uint64_t from, std::uint64_t to) {
+    char buffer[64 * 1024];
+    while (from < to) {
+        const auto n = ::pread(in, buffer, static_cast<std::size_t>(std::min<std::uint64_t>(sizeof(buffer), to - from)),
+                               static_cast<off_t>(from));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || !writeAll(out, buffer, static_cast<std::size_t>(n))) return false;
+        from += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+std::uint64_t fileBytes(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+}
+
+} // namespace
+
+CsvIndex::CsvIndex(std::string path)
+    : dataPath(std::move(path)), indexPath(dataPath + ".idx") {}
+
+CsvIndex::~CsvIndex() {
+    flushPending();
+    saveCovered();
+    closeIndex();
+    if (dataFd >= 0) ::close(dataFd);
+}
+
+void CsvIndex::closeIndex() {
+    sorted.close();
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    tail.clear();
+    sortedCount = entryCount = covered = 0;
+    ready = false;
+}
+
+bool CsvIndex::ensureOpen() {
+    if (ready) return true;
+    if (!load() && !reindex()) return false;
+    return true;
+}
+
+bool CsvIndex::load() {
+    closeIndex();
+    fd = ::open(indexPath.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    char header[INDEX_HEADER];
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < INDEX_HEADER ||
+        ::pread(fd, header, INDEX_HEADER, 0) != static_cast<ssize_t>(INDEX_HEADER) ||
+        std::memcmp(header, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        closeIndex();
+        return false;
+    }
+    std::memcpy(&covered, header + COVERED_AT, sizeof(covered));
+    std::memcpy(&sortedCount, header + SORTED_AT, sizeof(sortedCount));
+    entryCount = (static_cast<std::uint64_t>(st.st_size) - INDEX_HEADER) / sizeof(Entry);   // Drops a torn entry
+    if (sortedCount > entryCount || !sorted.openReadOnly(indexPath)) {
+        closeIndex();
+        return false;
+    }
+
+    const auto* entries = reinterpret_cast<const Entry*>(sorted.data() + INDEX_HEADER);
+    for (std::uint64_t i = sortedCount; i < entryCount; ++i) tail[entries[i].id] = entries[i];
+    ready = true;
+    return true;
+}
+
+void CsvIndex::scanEntries(const std::string& path, std::vector<Entry>& entries, std::uint64_t& dataBytes) {
+    entries.clear();
+    dataBytes = 0;
+    CsvReader reader;
+    if (reader.open(path)) {
+        dataBytes = reader.size();
+        reader.forEachRow([&](const CsvRow& row) {
+            int id;
+            if (row.get(0, id)) entries.push_back({id, 0, row.offset});
+            return true;
+        });
+    }
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const std::uint64_t end = i + 1 < entries.size() ? entries[i + 1].offset : dataBytes;
+        entries[i].length = static_cast<std::uint32_t>(end - entries[i].offset);
+    }
+}
+
+bool CsvIndex::reindex() {
+    std::vector<Entry> entries;
+    std::uint64_t dataBytes;
+    scanEntries(dataPath, entries, dataBytes);
+    if (!writeIndex(entries, dataBytes)) return false;
+    LOGF_INFO("CsvIndex: Rebuilt ", indexPath, " (", entryCount, " IDs)");
+    return true;
+}
+
+void CsvIndex::keepLatest(std::vector<Entry>& entries) {
+    // One entry per ID: the latest, i.e. the last one in file order
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.id < b.id; });
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (i + 1 < entries.size() && entries[i + 1].id == entries[i].id) continue;
+        entries[kept++] = entries[i];
+    }
+    entries.resize(kept);
+}
+
+bool CsvIndex::writeIndex(std::vector<Entry>& entries, std::uint64_t coveredBytes) {
+    keepLatest(entries);
+    const std::size_t kept = entries.size();
+
+    const std::string tmpPath = indexPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        const std::uint64_t count = kept;
+        out.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        out.write(reinterpret_cast<const char*>(&coveredBytes), sizeof(coveredBytes));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  static_cast<std::streamsize>(kept * sizeof(Entry)));
+        if (!out) {
+            Logger::log(LogLevel::ERROR, "CsvIndex: Cannot write " + tmpPath);
+            return false;
+        }
+    }
+
+    // The rename is atomic: readers of the old file keep their mapping
+    std::error_code ec;
+    fs::rename(tmpPath, indexPath, ec);
+    if (ec) {
+        Logger::log(LogLevel::ERROR, "CsvIndex: Cannot replace " + indexPath + ": " + ec.message());
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return load();
+}
+
+bool CsvIndex::reconcile(std::uint64_t dataBytes) {
+    if (dataBytes == covered) return true;
+    if (dataBytes < covered) {
+        LOGF_WARN("CsvIndex: ", dataPath, " shrank below its index, rebuilding");
+        return reindex();
+    }
+    return catchUp(dataBytes);
+}
+
+bool CsvIndex::catchUp(std::uint64_t dataBytes) {
+    CsvReader reader;
+    if (!reader.open(dataPath)) return reindex();
+    dataBytes = reader.size();
+
+    std::vector<Entry> added;
+    reader.forEachRow([&](const CsvRow& row) {
+        int id;
+        if (row.get(0, id)) added.push_back({id, 0, row.offset});
+        return true;
+    }, static_cast<std::size_t>(covered));
+    for (std::size_t i = 0; i < added.size(); ++i) {
+        const std::uint64_t end = i + 1 < added.size() ? added[i + 1].offset : dataBytes;
+        added[i].length = static_cast<std::uint32_t>(end - added[i].offset);
+    }
+    if (!addEntries(added.data(), added.size())) return false;
+    covered = dataBytes;
+    return mergeTail();
+}
+
+bool CsvIndex::addEntries(const Entry* entries, std::size_t count) {
+    if (!writeAt(fd, entries, count * sizeof(Entry), INDEX_HEADER + entryCount * sizeof(Entry))) {
+        Logger::log(LogLevel::ERROR, "CsvIndex: Cannot append to " + indexPath + ": " + std::strerror(errno));
+        return false;
+    }
+    entryCount += count;
+    for (std::size_t i = 0; i < count; ++i) tail[entries[i].id] = entries[i];
+    return true;
+}
+
+bool CsvIndex::mergeTail() {
+    if (tail.size() <= std::max<std::uint64_t>(MERGE_MIN, sortedCount / 8)) return true;
+    const auto* first = reinterpret_cast<const Entry*>(sorted.data() + INDEX_HEADER);
+    std::vector<Entry> entries(first, first + sortedCount);
+    entries.reserve(entries.size() + tail.size());
+    for (const auto& entry : tail) entries.push_back(entry.second);   // Newer than the sorted section
+    return writeIndex(entries, covered);
+}
+
+const CsvIndex::Entry* CsvIndex::lookup(int id) const {
+    const auto recent = tail.find(id);
+    if (recent != tail.end()) return &recent->second;
+    const auto* first = reinterpret_cast<const Entry*>(sorted.data() + INDEX_HEADER);
+    const auto* last = first + sortedCount;
+    const auto* it = std::lower_bound(first, last, id, [](const Entry& e, int key) { return e.id < key; });
+    return it != last && it->id == id ? it : nullptr;
+}
+
+bool CsvIndex::readRow(const Entry& entry, int id, std::string& line) const {
+    const int dataFd = ::open(dataPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dataFd < 0) return false;
+    line.resize(entry.length);
+    const auto n = ::pread(dataFd, line.data(), entry.length, static_cast<off_t>(entry.offset));
+    ::close(dataFd);
+    if (n != static_cast<ssize_t>(entry.length)) return false;
+
+    CsvRow row;
+    const char* end = CsvReader::splitLine(line.data(), line.data() + line.size(), row);
+    int rowId;
+    if (!row.get(0, rowId) || rowId != id) return false;
+    line.resize(static_cast<std::size_t>(end - line.data()));
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
+    return true;
+}
+
+void CsvIndex::setWritePolicy(const CsvWritePolicy& newPolicy) {
+    std::lock_guard<std::mutex> lock(mutex);
+    policy = newPolicy;
+}
+
+bool CsvIndex::append(int id, std::string_view line) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingEntries.push_back({id, static_cast<std::uint32_t>(line.size() + 1), pending.size()});
+    pending.append(line.data(), line.size());
+    pending += '\n';
+    return pending.size() < policy.bufferBytes || flushPending();
+}
+
+bool CsvIndex::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flushPending();
+}
+
+bool CsvIndex::openData(std::uint64_t& dataBytes) {
+    // Reopen if the file was replaced (renamed over) since the last write
+    struct stat st;
+    if (dataFd >= 0 && (::fstat(dataFd, &st) != 0 || st.st_nlink == 0)) {
+        ::close(dataFd);
+        dataFd = -1;
+    }
+    if (dataFd < 0) {
+        dataFd = ::open(dataPath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (dataFd < 0 || ::fstat(dataFd, &st) != 0) {
+            Logger::log(LogLevel::ERROR, "CsvIndex: Cannot open " + dataPath + ": " + std::strerror(errno));
+            return false;
+        }
+    }
+    dataBytes = static_cast<std::uint64_t>(st.st_size);
+    return true;
+}
+
+bool CsvIndex::saveCovered() {
+    return fd < 0 || writeAt(fd, &covered, sizeof(covered), COVERED_AT);
+}
+
+// Rows leave `pending` only once they are in the data file, so a failed
+// flush keeps them for the next one
+bool CsvIndex::flushPending() {
+    if (pending.empty()) return true;
+    std::uint64_t dataBytes;
+    if (!openData(dataBytes) || !ensureOpen() || !reconcile(dataBytes)) return false;
+
+    // Rows land at the current end of the data file, which the index now covers
+    const std::uint64_t base = covered;
+    std::size_t written;
+    if (!writeAll(dataFd, pending.data(), pending.size(), &written)) {
+        const int error = errno;
+        dropWritten(base, written);
+        Logger::log(LogLevel::ERROR, "CsvIndex: Cannot append to " + dataPath + ": " + std::strerror(error));
+        return false;
+    }
+    for (Entry& entry : pendingEntries) entry.offset += base;
+    const bool indexed = addEntries(pendingEntries.data(), pendingEntries.size());
+    const std::uint64_t rows = pending.size();
+    pending.clear();
+    pendingEntries.clear();
+    if (!indexed) return false;   // The next reconcile indexes the rows instead
+    covered = base + rows;
+    if (policy.syncOnFlush && (!saveCovered() || ::fdatasync(dataFd) != 0 || ::fdatasync(fd) != 0)) {
+        Logger::log(LogLevel::ERROR, "CsvIndex: fdatasync failed for " + dataPath + ": " + std::strerror(errno));
+        return false;
+    }
+    return mergeTail();
+}
+
+// After a short write: rows that reached the file whole are left to the
+// next reconcile, a torn one is cut off again and stays pending
+void CsvIndex::dropWritten(std::uint64_t base, std::size_t written) {
+    std::size_t whole = 0, rows = 0;
+    while (rows < pendingEntries.size() &&
+           pendingEntries[rows].offset + pendingEntries[rows].length <= written) {
+        whole = static_cast<std::size_t>(pendingEntries[rows].offset + pendingEntries[rows].length);
+        ++rows;
+    }
+    if (written > whole && ::ftruncate(dataFd, static_cast<off_t>(base + whole)) != 0) {
+        Logger::log(LogLevel::ERROR, "CsvIndex: Cannot cut a torn row off " + dataPath + ": " + std::strerror(errno));
+    }
+    pending.erase(0, whole);
+    pendingEntries.erase(pendingEntries.begin(), pendingEntries.begin() + static_cast<std::ptrdiff_t>(rows));
+    for (Entry& entry : pendingEntries) entry.offset -= whole;
+}
+
+bool CsvIndex::find(int id, std::string& line) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!flushPending()) return false;
+    if (!ready && fileBytes(dataPath) == 0) return false;   // Nothing stored yet; don't create an index
+    if (!ensureOpen() || !reconcile(fileBytes(dataPath))) return false;
+    const Entry* entry = lookup(id);
+    if (!entry) return false;
+    if (readRow(*entry, id, line)) return true;
+
+    // The data file changed under the index (rewritten in place): start over
+    LOGF_WARN("CsvIndex: Stale entry for ID ", id, " in ", indexPath, ", rebuilding");
+    if (!reindex()) return false;
+    entry = lookup(id);
+    return entry && readRow(*entry, id, line);
+}
+
+bool CsvIndex::openLatest(CsvReader& reader, std::vector<std::uint64_t>& offsets) {
+    offsets.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!flushPending()) return false;
+    if (!ready && fileBytes(dataPath) == 0) return false;   // Nothing stored yet
+    if (!ensureOpen() || !reconcile(fileBytes(dataPath)) || !reader.open(dataPath)) return false;
+    if (reader.size() != covered) return false;   // Only written under the lock, so never expected
+
+    const auto* entries = reinterpret_cast<const Entry*>(sorted.data() + INDEX_HEADER);
+    offsets.reserve(sortedCount + tail.size());
+    for (std::uint64_t i = 0; i < sortedCount; ++i) {
+        if (tail.empty() || tail.find(entries[i].id) == tail.end()) offsets.push_back(entries[i].offset);
+        // Drop the pages read so far; lookups fault back only what they need
+        if ((i + 1) % SCAN_RELEASE_ENTRIES == 0) sorted.release(0, INDEX_HEADER + (i + 1) * sizeof(Entry));
+    }
+    sorted.release(0, sorted.size());
+    for (const auto& [id, entry] : tail) offsets.push_back(entry.offset);
+    std::sort(offsets.begin(), offsets.end());
+    return true;
+}
+
+bool CsvIndex::flush(std::uint64_t& dataBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return flushPending() && openData(dataBytes);
+}
+
+bool CsvIndex::replaceData(const std::string& replacementPath, std::uint64_t rewrittenBytes) {
+    std::error_code ec;
+    const int in = ::open(dataPath.c_str(), O_RDONLY | O_CLOEXEC);
+    const int out = ::open(replacementPath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    const auto finish = [&](bool ok) {
+        if (in >= 0) ::close(in);
+        if (out >= 0) ::close(out);
+        if (!ok) fs::remove(replacementPath, ec);
+        return ok;
+    };
+    if (in < 0 || out < 0) {
+        Logger::log(LogLevel::ERROR, "CsvIndex: Cannot open " + replacementPath + " for the swap");
+        return finish(false);
+    }
+
+    // Rows keep arriving while the file was rewritten. The data file only
+    // grows, so copy them over in rounds without the lock, and index the
+    // replacement, until little is left for writers to wait on
+    std::uint64_t copied = rewrittenBytes;
+    for (int round = 0; round < SWAP_ROUNDS; ++round) {
+        std::uint64_t dataBytes;
+        if (!flush(dataBytes)) return finish(false);
+        if (dataBytes < copied) break;   // Shrunk: caught below
+        if (dataBytes - copied <= SWAP_LOCKED_BYTES) break;
+        if (!copyRange(in, out, copied, dataBytes)) return finish(false);
+        copied = dataBytes;
+    }
+    std::vector<Entry> entries;
+    std::uint64_t replacementBytes;
+    scanEntries(replacementPath, entries, replacementBytes);
+    keepLatest(entries);   // Leaves writeIndex a sorted list
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint64_t dataBytes;
+    if (!flushPending() || !openData(dataBytes)) return finish(false);
+    if (dataBytes < copied) {
+        LOGF_WARN("CsvIndex: ", dataPath, " shrank during the rewrite, keeping it");
+        return finish(false);
+    }
+    if (!copyRange(in, out, copied, dataBytes) || ::fdatasync(out) != 0) {
+        Logger::log(LogLevel::ERROR, "CsvIndex: Cannot copy rows into " + replacementPath + ": " + std::strerror(errno));
+        return finish(false);
+    }
+    fs::rename(replacementPath, dataPath, ec);
+    if (ec) {
+        Logger::log(LogLevel::ERROR, "CsvIndex: Cannot replace " + dataPath + ": " + ec.message());
+        return finish(false);
+    }
+    finish(true);
+
+    ::close(dataFd);   // Still the replaced file
+    dataFd = -1;
+    if (!writeIndex(entries, replacementBytes)) return reindex();
+    return reconcile(fileBytes(dataPath));
+}
+
+bool CsvIndex::rebuild() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return reindex();
+}
+
+std::size_t CsvIndex::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<std::size_t>(entryCount);
+}
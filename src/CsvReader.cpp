@@ -0,0 +1,77 @@
+#include "CsvReader.h"
+#include <algorithm>
+#include <filesystem>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline void pushField(CsvRow& row, const char* start, const char* stop) {
+    if (stop > start && stop[-1] == '\r') --stop;
+    if (row.count < CsvRow::MAX_FIELDS) {
+        row.fields[row.count] = std::string_view(start, static_cast<std::size_t>(stop - start));
+    }
+    row.count++;
+}
+
+// Bit i set where p[i] is ',' or '\n', for the next `span` bytes
+inline unsigned delimiterMask(const char* p, const char* end, std::size_t& span) {
+#if defined(__SSE2__)
+    if (end - p >= 16) {
+        span = 16;
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')),
+                                          _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+        return static_cast<unsigned>(_mm_movemask_epi8(hits));
+    }
+#endif
+    span = std::min<std::size_t>(16, static_cast<std::size_t>(end - p));
+    unsigned mask = 0;
+    for (std::size_t i = 0; i < span; ++i) {
+        if (p[i] == ',' || p[i] == '\n') mask |= 1u << i;
+    }
+    return mask;
+}
+
+} // namespace
+
+bool CsvReader::open(const std::string& path) {
+    std::error_code ec;
+    const auto bytes = std::filesystem::file_size(path, ec);
+    if (ec || bytes == 0) {
+        file.close();
+        return false;
+    }
+    return file.openReadOnly(path);
+}
+
+const char* CsvReader::splitLine(const char* line, const char* end, CsvRow& row) {
+    row.count = 0;
+    const char* fieldStart = line;
+    for (const char* p = line; p < end;) {
+        std::size_t span;
+        unsigned mask = delimiterMask(p, end, span);
+        while (mask) {
+            const char* delimiter = p + __builtin_ctz(mask);
+            mask &= mask - 1;
+            pushField(row, fieldStart, delimiter);
+            if (*delimiter == '\n') {
+                row.count = std::min(row.count, CsvRow::MAX_FIELDS);
+                return delimiter + 1;
+            }
+            fieldStart = delimiter + 1;
+        }
+        p += span;
+    }
+    pushField(row, fieldStart, end);
+    row.count = std::min(row.count, CsvRow::MAX_FIELDS);
+    return end;
+}
+
+bool CsvReader::readRow(std::size_t offset, CsvRow& row) const {
+    if (!file.isOpen() || offset >= file.size()) return false;
+    splitLine(file.data() + offset, file.data() + file.size(), row);
+    row.offset = offset;
+    return true;
+}
@@ -0,0 +1,402 @@
+#include "EventLog.h"
+#include "BinaryLog.h"
+#include "Logger.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char SEGMENT_MAGIC[8] = {'R', 'M', 'S', 'E', 'V', 'T', '0', '1'};
+constexpr std::size_t SEGMENT_HEADER = sizeof(SEGMENT_MAGIC) + sizeof(std::uint64_t);
+constexpr std::size_t RECORD_HEADER = BinaryLog::FRAME_HEADER;
+
+// Set while replay() feeds the bus so the log does not re-append its own events
+thread_local bool replaying = false;
+
+using BinaryLog::writeFrame;
+using BinaryLog::zigzag;
+using BinaryLog::unzigzag;
+
+// Segment-local source table: a definition precedes the first event that uses an ID
+constexpr std::uint8_t SOURCE_DEF = 0xFF;
+
+void putDouble(std::string& out, double v) { BinaryLog::put<double>(out, v); }
+
+bool getDouble(const char* data, std::size_t size, std::size_t& pos, double& v) {
+    if (pos + sizeof(v) > size) return false;
+    std::memcpy(&v, data + pos, sizeof(v));
+    pos += sizeof(v);
+    return true;
+}
+
+bool getInt(const char* data, std::size_t size, std::size_t& pos, int& v) {
+    std::uint64_t raw;
+    if (!BinaryLog::getVarint(data, size, pos, raw)) return false;
+    v = static_cast<int>(unzigzag(raw));
+    return true;
+}
+
+void encodeSourceDef(std::string& out, EventSourceId id) {
+    out += static_cast<char>(SOURCE_DEF);
+    BinaryLog::put<std::uint16_t>(out, id);
+    out += EventSources::name(id);
+}
+
+void encodeEvent(std::string& out, const Event& event) {
+    out += static_cast<char>(event.type);
+    out += static_cast<char>(event.entityType);
+    BinaryLog::putVarint(out, event.source);
+    BinaryLog::putVarint(out, zigzag(event.entityId));
+    BinaryLog::putVarint(out, zigzag(static_cast<std::int64_t>(event.timestamp)));
+    out += static_cast<char>(event.payload.index());
+    if (const auto* order = std::get_if<OrderPayload>(&event.payload)) {
+        BinaryLog::putVarint(out, zigzag(order->customerId));
+        putDouble(out, order->amount);
+    } else if (const auto* stock = std::get_if<InventoryPayload>(&event.payload)) {
+        BinaryLog::putVarint(out, zigzag(stock->quantity));
+        BinaryLog::putVarint(out, zigzag(stock->reorderLevel));
+    } else if (const auto* payment = std::get_if<PaymentPayload>(&event.payload)) {
+        BinaryLog::putVarint(out, zigzag(payment->orderId));
+        putDouble(out, payment->amount);
+    }
+}
+
+// Source IDs are translated through the segment's definitions
+using SourceMap = std::array<EventSourceId, EventSources::MAX_SOURCES>;
+
+bool decodeSourceDef(const char* data, std::size_t size, SourceMap& sources) {
+    std::uint16_t id;
+    if (size < 1 + sizeof(id)) return false;
+    std::memcpy(&id, data + 1, sizeof(id));
+    if (id >= sources.size()) return false;
+    sources[id] = EventSources::intern(std::string(data + 1 + sizeof(id), size - 1 - sizeof(id)));
+    return true;
+}
+
+bool decodeEvent(const char* data, std::size_t size, const SourceMap& sources, Event& event) {
+    if (size < 2 || static_cast<std::uint8_t>(data[0]) >= EVENT_TYPE_COUNT ||
+        static_cast<std::uint8_t>(data[1]) >= ENTITY_TYPE_COUNT) {
+        return false;
+    }
+    event.type = static_cast<EventType>(static_cast<std::uint8_t>(data[0]));
+    event.entityType = static_cast<EntityType>(static_cast<std::uint8_t>(data[1]));
+    std::size_t pos = 2;
+    std::uint64_t value;
+    if (!BinaryLog::getVarint(data, size, pos, value) || value >= sources.size()) return false;
+    event.source = sources[value];
+    if (!getInt(data, size, pos, event.entityId)) return false;
+    if (!BinaryLog::getVarint(data, size, pos, value)) return false;
+    event.timestamp = static_cast<std::time_t>(unzigzag(value));
+    if (pos >= size) return false;
+
+    switch (static_cast<std::uint8_t>(data[pos++])) {
+        case 0:
+            event.payload = std::monostate{};
+            break;
+        case 1: {
+            OrderPayload order;
+            if (!getInt(data, size, pos, order.customerId) || !getDouble(data, size, pos, order.amount)) return false;
+            event.payload = order;
+            break;
+        }
+        case 2: {
+            InventoryPayload stock;
+            if (!getInt(data, size, pos, stock.quantity) || !getInt(data, size, pos, stock.reorderLevel)) return false;
+            event.payload = stock;
+            break;
+        }
+        case 3: {
+            PaymentPayload payment;
+            if (!getInt(data, size, pos, payment.orderId) || !getDouble(data, size, pos, payment.amount)) return false;
+            event.payload = payment;
+            break;
+        }
+        default:
+            return false;
+    }
+    return pos == size;
+}
+
+bool readHeader(const MappedFile& file, std::uint64_t& firstSequence) {
+    if (file.size() < SEGMENT_HEADER ||
+        std::memcmp(file.data(), SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+        return false;
+    }
+    std::memcpy(&firstSequence, file.data() + sizeof(SEGMENT_MAGIC), sizeof(firstSequence));
+    return true;
+}
+
+// Walk intact records after the segment header
+template <typename Fn>
+std::size_t scanRecords(const char* data, std::size_t limit, Fn&& fn) {
+    return BinaryLog::scanFrames(data, SEGMENT_HEADER, limit, std::forward<Fn>(fn));
+}
+
+std::string segmentPath(const std::string& dir, std::uint64_t firstSequence) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "events-%020llu.log", static_cast<unsigned long long>(firstSequence));
+    return (fs::path(dir) / name).string();
+}
+
+// Segment files sorted by first sequence (zero-padded names sort numerically)
+std::vector<std::string> listSegments(const std::string& dir) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() == 31 && name.compare(0, 7, "events-") == 0 && name.compare(27, 4, ".log") == 0) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+} // namespace
+
+EventLog& EventLog::getInstance() {
+    // Never destroyed: the bus may still hold it as a listener at exit
+    static EventLog* log = new EventLog();
+    return *log;
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+bool EventLog::open(const std::string& dir, std::size_t segBytes, int commitMs) {
+    std::lock_guard<std::mutex> lock(appendMutex);
+    if (active) return true;
+
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        Logger::log(LogLevel::ERROR, "EventLog: Cannot create " + dir + ": " + ec.message());
+        return false;
+    }
+    directory = dir;
+    segmentBytes = std::max(segBytes, SEGMENT_HEADER + 4096);
+    groupCommitMs = std::max(commitMs, 1);
+
+    const auto segments = listSegments(dir);
+    const bool ok = segments.empty() ? openSegment(1) : recoverSegment(segments.back());
+    if (!ok) return false;
+
+    durableSequence.store(nextSequence - 1);
+    stopping = false;
+    commitRequested = false;
+    committer = std::thread(&EventLog::committerLoop, this);
+    Logger::log(LogLevel::INFO, "EventLog: Opened " + dir + " at sequence " + std::to_string(nextSequence));
+    return true;
+}
+
+bool EventLog::openSegment(std::uint64_t firstSequence) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(segmentPath(directory, firstSequence), segmentBytes)) return false;
+    std::memcpy(file->data(), SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    std::memcpy(file->data() + sizeof(SEGMENT_MAGIC), &firstSequence, sizeof(firstSequence));
+    active = std::move(file);
+    writeOffset = SEGMENT_HEADER;
+    syncedOffset = 0;   // Header is synced with the first commit
+    nextSequence = firstSequence;
+    sourcesDefined.assign(EventSources::MAX_SOURCES, false);
+    return true;
+}
+
+// Find where the previous run stopped. Source IDs are per process, so
+// appends always continue in a fresh segment
+bool EventLog::recoverSegment(const std::string& path) {
+    std::uint64_t firstSequence = 0;
+    std::uint64_t count = 0;
+    {
+        MappedFile file;
+        if (!file.openReadOnly(path) || !readHeader(file, firstSequence)) {
+            Logger::log(LogLevel::ERROR, "EventLog: Bad segment header in " + path);
+            return false;
+        }
+        scanRecords(file.data(), file.size(), [&count](const char* body, std::size_t) {
+            if (static_cast<std::uint8_t>(body[0]) != SOURCE_DEF) ++count;
+            return true;
+        });
+    }
+    // An event-free tail segment would clash with the new segment's name
+    if (count == 0) {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    return openSegment(firstSequence + count);
+}
+
+void EventLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(appendMutex);
+        if (!active) return;
+        stopping = true;
+    }
+    commitCv.notify_one();
+    committer.join();   // Final commit happens on the way out
+
+    std::lock_guard<std::mutex> lock(appendMutex);
+    active.reset();
+    durableCv.notify_all();
+    Logger::log(LogLevel::INFO, "EventLog: Closed at sequence " + std::to_string(nextSequence - 1));
+}
+
+bool EventLog::isOpen() const {
+    std::lock_guard<std::mutex> lock(appendMutex);
+    return active != nullptr;
+}
+
+void EventLog::onEvent(const Event& event) {
+    if (!replaying) append(event);
+}
+
+std::uint64_t EventLog::append(const Event& event) {
+    // Encode outside the lock; the critical section is a memcpy
+    thread_local std::string body;
+    body.clear();
+    encodeEvent(body, event);
+    std::size_t need = RECORD_HEADER + body.size();
+
+    std::lock_guard<std::mutex> lock(appendMutex);
+    if (!active) return 0;
+
+    thread_local std::string sourceDef;
+    sourceDef.clear();
+    if (event.source != 0 && event.source < sourcesDefined.size()) {
+        encodeSourceDef(sourceDef, event.source);
+        need += RECORD_HEADER + sourceDef.size();
+    }
+
+    if (writeOffset + need > active->size()) {
+        if (SEGMENT_HEADER + need > segmentBytes) {
+            Logger::log(LogLevel::ERROR, "EventLog: Event of " + std::to_string(need) +
+                                         " bytes exceeds segment size");
+            return 0;
+        }
+        // Roll over: the committer msyncs the full segment's tail, not this thread
+        if (writeOffset > syncedOffset) {
+            sealed.push_back({active, syncedOffset, writeOffset});
+            commitRequested = true;
+            commitCv.notify_one();
+        }
+        if (!openSegment(nextSequence)) return 0;
+    }
+
+    // First use of this source in the segment: define it ahead of the event
+    if (!sourceDef.empty() && !sourcesDefined[event.source]) {
+        writeFrame(active->data(), writeOffset, sourceDef);
+        sourcesDefined[event.source] = true;
+    }
+    writeFrame(active->data(), writeOffset, body);
+    return nextSequence++;
+}
+
+// Group commit: one msync per segment covers everything appended since
+// the last one, rolled-over segments first
+void EventLog::committerLoop() {
+    std::vector<SyncRange> ranges;   // Swapped with `sealed`, so both keep their capacity
+    std::unique_lock<std::mutex> lock(appendMutex);
+    for (;;) {
+        commitCv.wait_for(lock, std::chrono::milliseconds(groupCommitMs),
+                          [this] { return commitRequested || stopping; });
+        commitRequested = false;
+
+        if (writeOffset > syncedOffset || !sealed.empty()) {
+            ranges.swap(sealed);
+            if (writeOffset > syncedOffset) ranges.push_back({active, syncedOffset, writeOffset});
+            const std::uint64_t sequence = nextSequence - 1;
+            syncedOffset = writeOffset;
+
+            lock.unlock();
+            for (const SyncRange& range : ranges) range.file->sync(range.from, range.to - range.from);
+            ranges.clear();
+            lock.lock();
+
+            if (sequence > durableSequence.load()) durableSequence.store(sequence);
+        }
+        durableCv.notify_all();
+        if (stopping) return;
+    }
+}
+
+void EventLog::sync() {
+    std::unique_lock<std::mutex> lock(appendMutex);
+    if (!active) return;
+    const std::uint64_t target = nextSequence - 1;
+    commitRequested = true;
+    commitCv.notify_one();
+    durableCv.wait(lock, [this, target] { return durableSequence.load() >= target || !active; });
+}
+
+std::uint64_t EventLog::getLastSequence() const {
+    std::lock_guard<std::mutex> lock(appendMutex);
+    return nextSequence - 1;
+}
+
+std::uint64_t EventLog::getDurableSequence() const {
+    return durableSequence.load();
+}
+
+std::size_t EventLog::replay(std::uint64_t fromSequence, EventBus& bus) {
+    struct ReplayScope {
+        ReplayScope() { replaying = true; }
+        ~ReplayScope() { replaying = false; }
+    } scope;
+    return replay(fromSequence, [&bus](std::uint64_t, const Event& event) { bus.emit(event); });
+}
+
+std::size_t EventLog::replay(std::uint64_t fromSequence,
+                             const std::function<void(std::uint64_t, const Event&)>& visitor) {
+    // Only records complete at this point are replayed
+    std::string dir, activePath;
+    std::size_t activeEnd = 0;
+    std::uint64_t lastSequence = 0;
+    {
+        std::lock_guard<std::mutex> lock(appendMutex);
+        dir = directory;
+        if (active) {
+            activePath = active->path();
+            activeEnd = writeOffset;
+        }
+        lastSequence = nextSequence - 1;
+    }
+    if (dir.empty()) return 0;
+
+    const auto segments = listSegments(dir);
+    std::size_t delivered = 0;
+    Event event;
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        // Skip whole segments that end before fromSequence
+        if (i + 1 < segments.size()) {
+            const std::uint64_t nextFirst = std::strtoull(segments[i + 1].c_str() + segments[i + 1].size() - 24, nullptr, 10);
+            if (nextFirst <= fromSequence) continue;
+        }
+
+        MappedFile file;
+        std::uint64_t sequence = 0;
+        if (!file.openReadOnly(segments[i]) || !readHeader(file, sequence)) continue;
+        const std::size_t limit = segments[i] == activePath ? activeEnd : file.size();
+
+        SourceMap sources{};
+        scanRecords(file.data(), limit, [&](const char* body, std::size_t len) {
+            if (static_cast<std::uint8_t>(body[0]) == SOURCE_DEF) return decodeSourceDef(body, len, sources);
+            if (sequence > lastSequence) return false;
+            if (sequence++ < fromSequence) return true;
+            if (!decodeEvent(body, len, sources, event)) return false;
+            visitor(sequence - 1, event);
+            ++delivered;
+            return true;
+        });
+    }
+    return delivered;
+}
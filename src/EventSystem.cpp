@@ -1,62 +1,429 @@
 #include "EventSystem.h"
+#include "Config.h"
 #include "Logger.h"
 #include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <deque>
 #include <iostream>
 
-EventBus* EventBus::instance = nullptr;
+// Nesting depth of bus callbacks on this thread (emit() or an async worker).
+// A write made from inside a callback must not wait for readers, since the
+// writer may itself be one of them
+static thread_local int callbackDepth = 0;
+
+// Coalesced types whose batch this thread is delivering; a batch listener
+// that emits more of them must not try to take deliverMutex again
+static thread_local std::bitset<EVENT_TYPE_COUNT> deliveringHere;
+
+namespace {
+struct CallbackScope {
+    CallbackScope() { ++callbackDepth; }
+    ~CallbackScope() { --callbackDepth; }
+};
+
+bool addUnique(std::vector<EventListener*>& list, EventListener* listener) {
+    if (std::find(list.begin(), list.end(), listener) != list.end()) return false;
+    list.push_back(listener);
+    return true;
+}
+
+bool removeFrom(std::vector<EventListener*>& list, EventListener* listener) {
+    auto it = std::find(list.begin(), list.end(), listener);
+    if (it == list.end()) return false;
+    list.erase(it);
+    return true;
+}
+} // namespace
+
+// ============================================================================
+// Event sources and descriptions
+// ============================================================================
+
+namespace {
+std::mutex sourceMutex;
+std::deque<std::string> sourceStorage;   // Stable addresses for names[]
+std::array<std::atomic<const char*>, EventSources::MAX_SOURCES> sourceNames{};
+std::atomic<std::size_t> sourceCount{0};
+} // namespace
+
+EventSourceId EventSources::intern(const std::string& sourceName) {
+    std::lock_guard<std::mutex> lock(sourceMutex);
+    const std::size_t count = sourceCount.load(std::memory_order_relaxed);
+    if (count == 0) {
+        sourceStorage.emplace_back("");   // ID 0: unspecified
+        sourceNames[0].store(sourceStorage.back().c_str(), std::memory_order_release);
+        sourceCount.store(1, std::memory_order_release);
+        if (sourceName.empty()) return 0;
+    }
+    for (std::size_t id = 0; id < sourceCount.load(std::memory_order_relaxed); ++id) {
+        if (sourceStorage[id] == sourceName) return static_cast<EventSourceId>(id);
+    }
+    const std::size_t id = sourceCount.load(std::memory_order_relaxed);
+    if (id >= MAX_SOURCES) {
+        Logger::log(LogLevel::WARNING, "EventSources: Table full, '" + sourceName + "' left unnamed");
+        return 0;
+    }
+    sourceStorage.push_back(sourceName);
+    sourceNames[id].store(sourceStorage.back().c_str(), std::memory_order_release);
+    sourceCount.store(id + 1, std::memory_order_release);
+    return static_cast<EventSourceId>(id);
+}
+
+const char* EventSources::name(EventSourceId id) {
+    if (id >= sourceCount.load(std::memory_order_acquire)) return "";
+    return sourceNames[id].load(std::memory_order_acquire);
+}
+
+std::string describeEvent(const Event& event) {
+    std::string out = Logger::concat(eventTypeName(event.type), " ", entityTypeName(event.entityType),
+                                     "#", event.entityId);
+    if (const auto* order = std::get_if<OrderPayload>(&event.payload)) {
+        out += Logger::concat(" customer=", order->customerId, " amount=", order->amount);
+    } else if (const auto* stock = std::get_if<InventoryPayload>(&event.payload)) {
+        out += Logger::concat(" quantity=", stock->quantity, " reorderLevel=", stock->reorderLevel);
+    } else if (const auto* payment = std::get_if<PaymentPayload>(&event.payload)) {
+        out += Logger::concat(" order=", payment->orderId, " amount=", payment->amount);
+    }
+    const char* source = EventSources::name(event.source);
+    if (*source) out += Logger::concat(" (", source, ")");
+    return out;
+}
+
+// ============================================================================
+// AsyncListenerQueue
+// ============================================================================
+
+AsyncListenerQueue::AsyncListenerQueue(EventListener* t, std::size_t requested, QueueFullPolicy p)
+    : target(t), policy(p) {
+    capacity = 2;
+    while (capacity < requested) capacity <<= 1;
+    mask = capacity - 1;
+    cells.reset(new Cell[capacity]);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    worker = std::thread(&AsyncListenerQueue::workerLoop, this);
+}
+
+AsyncListenerQueue::~AsyncListenerQueue() {
+    stop();
+}
+
+// Bounded MPSC ring (Vyukov): producers claim a slot with CAS on tail
+bool AsyncListenerQueue::tryEnqueue(const Event& event) {
+    std::size_t pos = tail.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.event = event;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;   // Full
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool AsyncListenerQueue::tryDequeue(Event& out) {
+    Cell& cell = cells[head & mask];
+    if (cell.sequence.load(std::memory_order_acquire) != head + 1) return false;
+    out = std::move(cell.event);
+    cell.sequence.store(head + capacity, std::memory_order_release);
+    ++head;
+    return true;
+}
+
+void AsyncListenerQueue::onEvent(const Event& event) {
+    if (stopping.load(std::memory_order_acquire)) return;
+    
+    // Counted before publishing so processed never overtakes enqueued
+    const std::uint64_t count = enqueued.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (!tryEnqueue(event)) {
+        if (policy == QueueFullPolicy::DROP) {
+            enqueued.fetch_sub(1, std::memory_order_acq_rel);
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        blocked.fetch_add(1, std::memory_order_relaxed);
+        do {
+            wakeCv.notify_one();
+            std::this_thread::yield();
+        } while (!tryEnqueue(event));
+    }
+    
+    const std::uint64_t done = processed.load(std::memory_order_relaxed);
+    const auto depth = std::min(capacity, static_cast<std::size_t>(count > done ? count - done : 0));
+    std::size_t seen = highWater.load(std::memory_order_relaxed);
+    while (depth > seen && !highWater.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {}
+    
+    // Pairs with the fence in workerLoop so a sleeping worker is never missed
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (workerSleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeCv.notify_one();
+    }
+}
+
+void AsyncListenerQueue::workerLoop() {
+    CallbackScope scope;
+    Event event;
+    for (;;) {
+        bool didWork = false;
+        while (tryDequeue(event)) {
+            try {
+                target->onEvent(event);
+            } catch (const std::exception& e) {
+                Logger::log(LogLevel::ERROR, "EventBus: Async listener '" + target->getName() +
+                           "' threw exception: " + std::string(e.what()));
+            }
+            processed.fetch_add(1, std::memory_order_release);
+            didWork = true;
+        }
+        
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        if (didWork) drainedCv.notify_all();
+        if (stopping.load(std::memory_order_acquire) &&
+            processed.load(std::memory_order_acquire) == enqueued.load(std::memory_order_acquire)) {
+            drainedCv.notify_all();
+            return;
+        }
+        
+        workerSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeCv.wait_for(lock, std::chrono::milliseconds(10), [this] {
+            return cells[head & mask].sequence.load(std::memory_order_acquire) == head + 1 ||
+                   stopping.load(std::memory_order_acquire);
+        });
+        workerSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void AsyncListenerQueue::drain() {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    const std::uint64_t target = enqueued.load(std::memory_order_acquire);
+    wakeCv.notify_one();
+    drainedCv.wait(lock, [this, target] {
+        return processed.load(std::memory_order_acquire) >= target;
+    });
+}
+
+void AsyncListenerQueue::stop() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping.store(true, std::memory_order_release);
+    }
+    wakeCv.notify_one();
+    worker.join();
+}
+
+ListenerQueueStats AsyncListenerQueue::getStats() const {
+    ListenerQueueStats stats;
+    stats.listenerName = target->getName();
+    stats.capacity = capacity;
+    stats.enqueued = enqueued.load(std::memory_order_relaxed);
+    stats.processed = processed.load(std::memory_order_relaxed);
+    stats.depth = std::min(capacity, static_cast<std::size_t>(stats.enqueued - std::min(stats.processed, stats.enqueued)));
+    stats.highWaterMark = highWater.load(std::memory_order_relaxed);
+    stats.dropped = dropped.load(std::memory_order_relaxed);
+    stats.blocked = blocked.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ============================================================================
+// EventBus
+// ============================================================================
+
+class EventBus::ReadGuard {
+public:
+    explicit ReadGuard(const EventBus& b) : bus(b) {
+        slot = bus.readerEpoch.load(std::memory_order_seq_cst) & 1;
+        bus.activeReaders[slot].value.fetch_add(1, std::memory_order_seq_cst);
+        current = bus.table.load(std::memory_order_seq_cst);
+    }
+    ~ReadGuard() {
+        bus.activeReaders[slot].value.fetch_sub(1, std::memory_order_release);
+    }
+    const ListenerTable& snapshot() const { return *current; }
+
+private:
+    const EventBus& bus;
+    unsigned slot;
+    const ListenerTable* current;
+};
+
+EventBus::EventBus() : table(new ListenerTable()) {}
 
 EventBus& EventBus::getInstance() {
-    if (!instance) {
-        instance = new EventBus();
+    // Thread-safe initialisation; never destroyed so emits from other
+    // static destructors still find a live bus
+    static EventBus* bus = new EventBus();
+    return *bus;
+}
+
+// Grace period: flip new readers onto the other counter and wait for the
+// old one to empty, once per counter. Every read section that started
+// before the caller published has then finished
+void EventBus::waitForReaders() {
+    std::lock_guard<std::mutex> lock(graceMutex);
+    for (int pass = 0; pass < 2; ++pass) {
+        const unsigned old = readerEpoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+        while (activeReaders[old].value.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Copy the current table, let `mutate` edit the copy and publish it.
+// Returns false (publishing nothing) if `mutate` reports no change
+bool EventBus::modify(const std::function<bool(ListenerTable&)>& mutate) {
+    std::vector<std::unique_ptr<const ListenerTable>> tables;
+    std::vector<std::shared_ptr<AsyncListenerQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto next = std::make_unique<ListenerTable>(*table.load(std::memory_order_relaxed));
+        if (!mutate(*next)) return false;
+        splitBatchListeners(*next);
+        retiredTables.emplace_back(table.exchange(next.release(), std::memory_order_seq_cst));
+        if (callbackDepth > 0) return true;
+        tables.swap(retiredTables);
+        queues.swap(retiredQueues);
+    }
+    
+    waitForReaders();
+    for (auto& queue : queues) queue->stop();
+    return true;
+}
+
+AsyncListenerQueue* EventBus::asyncAdapterFor(EventListener* listener) const {
+    for (const auto& queue : asyncQueues) {
+        if (queue->getTarget() == listener) return queue.get();
+    }
+    return nullptr;
+}
+
+EventListener* EventBus::adapterOrCreate(EventListener* listener, std::size_t capacity, QueueFullPolicy policy) {
+    if (AsyncListenerQueue* existing = asyncAdapterFor(listener)) return existing;
+    asyncQueues.push_back(std::make_shared<AsyncListenerQueue>(listener, capacity, policy));
+    return asyncQueues.back().get();
+}
+
+// Move the adapter to the retired list; it is stopped after the grace period
+void EventBus::detachAdapter(AsyncListenerQueue* adapter) {
+    auto it = std::find_if(asyncQueues.begin(), asyncQueues.end(),
+                           [adapter](const std::shared_ptr<AsyncListenerQueue>& q) { return q.get() == adapter; });
+    if (it != asyncQueues.end()) {
+        retiredQueues.push_back(std::move(*it));
+        asyncQueues.erase(it);
     }
-    return *instance;
 }
 
 void EventBus::subscribe(EventListener* listener) {
     if (!listener) return;
     
     // Avoid duplicates
-    auto it = std::find(listeners.begin(), listeners.end(), listener);
-    if (it == listeners.end()) {
-        listeners.push_back(listener);
+    if (modify([listener](ListenerTable& t) { return addUnique(t.all, listener); })) {
         Logger::log(LogLevel::INFO, "EventBus: Listener '" + listener->getName() + "' subscribed");
     }
 }
 
+void EventBus::subscribe(EventType type, EventListener* listener) {
+    if (!listener || static_cast<std::size_t>(type) >= EVENT_TYPE_COUNT) return;
+    
+    const auto index = static_cast<std::size_t>(type);
+    if (modify([listener, index](ListenerTable& t) { return addUnique(t.byType[index], listener); })) {
+        Logger::log(LogLevel::INFO, "EventBus: Listener '" + listener->getName() + "' subscribed to " +
+                                    eventTypeName(type));
+    }
+}
+
+void EventBus::subscribe(EventListener* listener, DispatchMode mode,
+                         std::size_t queueCapacity, QueueFullPolicy policy) {
+    if (!listener) return;
+    if (mode == DispatchMode::SYNC) {
+        subscribe(listener);
+        return;
+    }
+    
+    const bool added = modify([&](ListenerTable& t) {
+        return addUnique(t.all, adapterOrCreate(listener, queueCapacity, policy));
+    });
+    if (added) {
+        Logger::log(LogLevel::INFO, "EventBus: Listener '" + listener->getName() + "' subscribed (async)");
+    }
+}
+
+void EventBus::subscribe(EventType type, EventListener* listener, DispatchMode mode,
+                         std::size_t queueCapacity, QueueFullPolicy policy) {
+    if (!listener || static_cast<std::size_t>(type) >= EVENT_TYPE_COUNT) return;
+    if (mode == DispatchMode::SYNC) {
+        subscribe(type, listener);
+        return;
+    }
+    
+    const auto index = static_cast<std::size_t>(type);
+    const bool added = modify([&](ListenerTable& t) {
+        return addUnique(t.byType[index], adapterOrCreate(listener, queueCapacity, policy));
+    });
+    if (added) {
+        Logger::log(LogLevel::INFO, "EventBus: Listener '" + listener->getName() + "' subscribed to " +
+                                    eventTypeName(type) + " (async)");
+    }
+}
+
 void EventBus::unsubscribe(EventListener* listener) {
     if (!listener) return;
     
-    auto it = std::find(listeners.begin(), listeners.end(), listener);
-    if (it != listeners.end()) {
-        listeners.erase(it);
+    // Remove the listener itself and, if it was async, its queue adapter
+    const bool removed = modify([this, listener](ListenerTable& t) {
+        AsyncListenerQueue* adapter = asyncAdapterFor(listener);
+        bool changed = false;
+        for (EventListener* target : {listener, static_cast<EventListener*>(adapter)}) {
+            if (!target) continue;
+            changed |= removeFrom(t.all, target);
+            for (auto& typed : t.byType) changed |= removeFrom(typed, target);
+        }
+        if (adapter) {
+            detachAdapter(adapter);
+            changed = true;
+        }
+        return changed;
+    });
+    if (removed) {
         Logger::log(LogLevel::INFO, "EventBus: Listener '" + listener->getName() + "' unsubscribed");
     }
 }
 
-void EventBus::emit(const Event& event) {
-    std::string eventName;
-    switch (event.type) {
-        case EventType::ORDER_PLACED:       eventName = "ORDER_PLACED"; break;
-        case EventType::ORDER_CONFIRMED:    eventName = "ORDER_CONFIRMED"; break;
-        case EventType::ORDER_PREPARING:    eventName = "ORDER_PREPARING"; break;
-        case EventType::ORDER_READY:        eventName = "ORDER_READY"; break;
-        case EventType::ORDER_SERVED:       eventName = "ORDER_SERVED"; break;
-        case EventType::ORDER_CANCELLED:    eventName = "ORDER_CANCELLED"; break;
-        case EventType::ORDER_REFUNDED:     eventName = "ORDER_REFUNDED"; break;
-        case EventType::INVENTORY_UPDATED:  eventName = "INVENTORY_UPDATED"; break;
-        case EventType::INVENTORY_LOW:      eventName = "INVENTORY_LOW"; break;
-        case EventType::CUSTOMER_CREATED:   eventName = "CUSTOMER_CREATED"; break;
-        case EventType::CUSTOMER_DELETED:   eventName = "CUSTOMER_DELETED"; break;
-        case EventType::PAYMENT_PROCESSED:  eventName = "PAYMENT_PROCESSED"; break;
-        case EventType::REFUND_ISSUED:      eventName = "REFUND_ISSUED"; break;
-        default:                            eventName = "UNKNOWN"; break;
-    }
-    
-    Logger::log(LogLevel::DEBUG, "EventBus: Emitting " + eventName + " (entity:" + event.entityType + 
-                                 "#" + std::to_string(event.entityId) + ")");
-    
-    // Dispatch to all listeners
-    for (auto listener : listeners) {
+void EventBus::unsubscribe(EventType type, EventListener* listener) {
+    if (!listener || static_cast<std::size_t>(type) >= EVENT_TYPE_COUNT) return;
+    
+    const auto index = static_cast<std::size_t>(type);
+    const bool removed = modify([this, listener, index](ListenerTable& t) {
+        EventListener* adapter = asyncAdapterFor(listener);
+        return removeFrom(t.byType[index], adapter ? adapter : listener);
+    });
+    if (removed) {
+        Logger::log(LogLevel::INFO, "EventBus: Listener '" + listener->getName() + "' unsubscribed from " +
+                                    eventTypeName(type));
+    }
+}
+
+std::size_t EventBus::getListenerCount(EventType type) const {
+    if (static_cast<std::size_t>(type) >= EVENT_TYPE_COUNT) return 0;
+    ReadGuard guard(*this);
+    const ListenerTable& t = guard.snapshot();
+    return t.all.size() + t.byType[static_cast<std::size_t>(type)].size();
+}
+
+static void dispatch(const std::vector<EventListener*>& targets, const Event& event) {
+    for (auto listener : targets) {
         try {
             listener->onEvent(event);
         } catch (const std::exception& e) {
@@ -66,8 +433,306 @@ void EventBus::emit(const Event& event) {
     }
 }
 
+void EventBus::emit(const Event& event) {
+    LOGF_DEBUG("EventBus: Emitting ", eventTypeName(event.type), " (entity:", entityTypeName(event.entityType),
+               "#", event.entityId, ")");
+    
+    ReadGuard guard(*this);
+    CallbackScope scope;
+    const ListenerTable& t = guard.snapshot();
+    const auto index = static_cast<std::size_t>(event.type);
+    if (index >= EVENT_TYPE_COUNT) {
+        dispatch(t.all, event);
+        return;
+    }
+    if (t.coalesced[index]) {
+        dispatch(t.immediate[index], event);
+        if (!t.batched[index].empty()) coalesce(index, event);
+        return;
+    }
+    dispatch(t.all, event);
+    dispatch(t.byType[index], event);
+}
+
+// ============================================================================
+// Coalescing
+// ============================================================================
+
+struct EventBus::CoalesceBuffer {
+    std::mutex pendingMutex;
+    std::vector<Event> pending;                     // First-seen order per entity
+    std::chrono::steady_clock::time_point firstPendingAt;
+    
+    // entityId -> index in pending: open addressing, emptied by bumping
+    // `generation` instead of clearing the arrays
+    std::vector<int> slotIds;
+    std::vector<std::uint32_t> slotIndex;
+    std::vector<std::uint32_t> slotGeneration;
+    std::uint32_t generation = 1;
+    
+    void resize(std::size_t maxEntities) {
+        std::size_t size = 16;
+        while (size < 2 * maxEntities) size <<= 1;
+        slotIds.assign(size, 0);
+        slotIndex.assign(size, 0);
+        slotGeneration.assign(size, 0);
+        generation = 1;
+    }
+    
+    // Index of entityId in pending, inserting `next` if absent
+    std::uint32_t slotFor(int entityId, std::uint32_t next, bool& inserted) {
+        const std::size_t mask = slotIds.size() - 1;
+        std::size_t i = (static_cast<std::uint32_t>(entityId) * 0x9E3779B1u) & mask;
+        while (slotGeneration[i] == generation) {
+            if (slotIds[i] == entityId) {
+                inserted = false;
+                return slotIndex[i];
+            }
+            i = (i + 1) & mask;
+        }
+        slotGeneration[i] = generation;
+        slotIds[i] = entityId;
+        slotIndex[i] = next;
+        inserted = true;
+        return next;
+    }
+    
+    // Rebuilds the table for what is pending, keeping it at most half full
+    void reindex(std::size_t maxEntities) {
+        resize(std::max(maxEntities, pending.size()));
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            bool inserted;
+            slotFor(pending[i].entityId, static_cast<std::uint32_t>(i), inserted);
+        }
+    }
+    
+    void resetSlots() {
+        if (++generation == 0) resize(slotIds.size() / 2);   // Wrapped: really clear
+    }
+    
+    std::mutex deliverMutex;                        // Keeps batches in order
+    std::vector<Event> delivering;
+    
+    std::atomic<std::size_t> maxBatch{1024};
+    std::atomic<long> windowMs{50};
+};
+
+// Derived lists for coalesced types; recomputed on every publish
+void EventBus::splitBatchListeners(ListenerTable& t) {
+    for (std::size_t i = 0; i < EVENT_TYPE_COUNT; ++i) {
+        t.immediate[i].clear();
+        t.batched[i].clear();
+        if (!t.coalesced[i]) continue;
+        for (const auto* list : {&t.all, &t.byType[i]}) {
+            for (EventListener* listener : *list) {
+                (listener->acceptsBatches() ? t.batched[i] : t.immediate[i]).push_back(listener);
+            }
+        }
+    }
+}
+
+void EventBus::coalesce(std::size_t typeIndex, const Event& event) {
+    CoalesceBuffer* buffer = coalesceBuffers[typeIndex].load(std::memory_order_acquire);
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(buffer->pendingMutex);
+        // pending outgrows maxBatch while a delivery is in progress
+        if ((buffer->pending.size() + 1) * 2 > buffer->slotIds.size()) {
+            buffer->reindex(buffer->slotIds.size());
+        }
+        bool inserted;
+        const auto next = static_cast<std::uint32_t>(buffer->pending.size());
+        const std::uint32_t slot = buffer->slotFor(event.entityId, next, inserted);
+        if (inserted) {
+            if (next == 0) buffer->firstPendingAt = std::chrono::steady_clock::now();
+            buffer->pending.push_back(event);
+        } else {
+            buffer->pending[slot] = event;   // Latest state wins
+        }
+        full = buffer->pending.size() >= buffer->maxBatch.load(std::memory_order_relaxed);
+    }
+    // Never wait here: a batch listener may be emitting from inside delivery
+    if (full) deliverBatch(typeIndex, false);
+}
+
+void EventBus::deliverBatch(std::size_t typeIndex, bool wait) {
+    CoalesceBuffer* buffer = coalesceBuffers[typeIndex].load(std::memory_order_acquire);
+    if (!buffer) return;
+    // Re-entered from one of our own batch listeners: the outer call
+    // picks up what they add
+    if (deliveringHere[typeIndex]) return;
+    
+    std::unique_lock<std::mutex> deliver(buffer->deliverMutex, std::defer_lock);
+    if (wait) {
+        deliver.lock();
+    } else if (!deliver.try_lock()) {
+        return;   // Whoever holds it, or the flusher, picks these up next
+    }
+    ReadGuard guard(*this);
+    CallbackScope scope;
+    deliveringHere[typeIndex] = true;
+    // Listeners may emit more of this type while being called; a flush
+    // drains those too, otherwise they wait for a full batch or the window
+    for (bool more = true; more;) {
+        {
+            std::lock_guard<std::mutex> lock(buffer->pendingMutex);
+            if (buffer->pending.empty()) break;
+            buffer->delivering.swap(buffer->pending);
+            buffer->resetSlots();
+        }
+        
+        const ListenerTable& t = guard.snapshot();
+        auto deliverTo = [&](EventListener* listener) {
+            try {
+                listener->onEventBatch(buffer->delivering.data(), buffer->delivering.size());
+            } catch (const std::exception& e) {
+                Logger::log(LogLevel::ERROR, "EventBus: Listener '" + listener->getName() +
+                           "' threw exception on batch: " + std::string(e.what()));
+            }
+        };
+        if (t.coalesced[typeIndex]) {
+            for (EventListener* listener : t.batched[typeIndex]) deliverTo(listener);
+        } else {
+            // Coalescing was switched off after these were buffered; immediate
+            // listeners already saw each of them at emit time
+            for (const auto* list : {&t.all, &t.byType[typeIndex]}) {
+                for (EventListener* listener : *list) {
+                    if (listener->acceptsBatches()) deliverTo(listener);
+                }
+            }
+        }
+        buffer->delivering.clear();
+        
+        std::lock_guard<std::mutex> lock(buffer->pendingMutex);
+        more = wait || buffer->pending.size() >= buffer->maxBatch.load(std::memory_order_relaxed);
+    }
+    deliveringHere[typeIndex] = false;
+}
+
+// Delivers batches whose window has passed (for the life of the process)
+void EventBus::flusherLoop() {
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(flushTickMs.load(std::memory_order_relaxed)));
+        if (openBatchScopes.load(std::memory_order_acquire) > 0) continue;
+        
+        const auto now = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < EVENT_TYPE_COUNT; ++i) {
+            CoalesceBuffer* buffer = coalesceBuffers[i].load(std::memory_order_acquire);
+            if (!buffer) continue;
+            bool due;
+            {
+                std::lock_guard<std::mutex> lock(buffer->pendingMutex);
+                due = !buffer->pending.empty() &&
+                      now - buffer->firstPendingAt >= std::chrono::milliseconds(buffer->windowMs.load());
+            }
+            if (due) deliverBatch(i, true);
+        }
+    }
+}
+
+void EventBus::setCoalescing(EventType type, std::size_t maxBatch, std::chrono::milliseconds window) {
+    const auto index = static_cast<std::size_t>(type);
+    if (index >= EVENT_TYPE_COUNT) return;
+    const long windowMs = std::max<long>(1, static_cast<long>(window.count()));
+    
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        CoalesceBuffer* buffer = coalesceBuffers[index].load(std::memory_order_relaxed);
+        if (!buffer) {
+            buffer = new CoalesceBuffer();
+            coalesceBuffers[index].store(buffer, std::memory_order_release);
+        }
+        {
+            std::lock_guard<std::mutex> pendingLock(buffer->pendingMutex);
+            const std::size_t limit = std::max<std::size_t>(1, maxBatch);
+            buffer->maxBatch.store(limit);
+            buffer->reindex(limit);
+        }
+        buffer->windowMs.store(windowMs);
+        
+        // The flusher ticks at the shortest window in use
+        const long tick = flushTickMs.load();
+        if (tick == 0 || windowMs < tick) flushTickMs.store(windowMs);
+        if (tick == 0) std::thread(&EventBus::flusherLoop, this).detach();
+    }
+    
+    modify([index](ListenerTable& t) {
+        t.coalesced[index] = true;
+        return true;
+    });
+    Logger::log(LogLevel::INFO, "EventBus: Coalescing " + std::string(eventTypeName(type)) + " (batch " +
+                                std::to_string(maxBatch) + ", window " + std::to_string(windowMs) + " ms)");
+}
+
+void EventBus::disableCoalescing(EventType type) {
+    const auto index = static_cast<std::size_t>(type);
+    if (index >= EVENT_TYPE_COUNT) return;
+    // Pending events go to the batch listeners only: the immediate ones
+    // were called for each of them at emit time
+    deliverBatch(index, true);
+    const bool changed = modify([index](ListenerTable& t) {
+        if (!t.coalesced[index]) return false;
+        t.coalesced[index] = false;
+        return true;
+    });
+    // Events buffered between the drain and the switch
+    if (changed) deliverBatch(index, true);
+}
+
+void EventBus::flushBatches() {
+    for (std::size_t i = 0; i < EVENT_TYPE_COUNT; ++i) {
+        deliverBatch(i, true);
+    }
+}
+
+EventBus::BatchScope::BatchScope(EventBus& b) : bus(b) {
+    bus.openBatchScopes.fetch_add(1, std::memory_order_acq_rel);
+}
+
+EventBus::BatchScope::~BatchScope() {
+    if (bus.openBatchScopes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        bus.flushBatches();
+    }
+}
+
+void EventBus::drainAsync() {
+    std::vector<std::shared_ptr<AsyncListenerQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        queues = asyncQueues;
+    }
+    // Outside the lock: a worker may subscribe from its callback meanwhile
+    for (auto& queue : queues) {
+        queue->drain();
+    }
+}
+
+std::vector<ListenerQueueStats> EventBus::getQueueStats() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::vector<ListenerQueueStats> stats;
+    for (const auto& queue : asyncQueues) {
+        stats.push_back(queue->getStats());
+    }
+    return stats;
+}
+
+std::size_t EventBus::getQueuedEventCount() const {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::size_t total = 0;
+    for (const auto& queue : asyncQueues) {
+        total += queue->getStats().depth;
+    }
+    return total;
+}
+
 void EventBus::clear() {
-    listeners.clear();
+    flushBatches();
+    modify([this](ListenerTable& t) {
+        t = ListenerTable();
+        for (auto& queue : asyncQueues) retiredQueues.push_back(std::move(queue));
+        asyncQueues.clear();
+        return true;
+    });
     Logger::log(LogLevel::INFO, "EventBus: Cleared all listeners");
 }
 
@@ -78,9 +743,7 @@ void EventBus::clear() {
 class LoggerListener : public EventListener {
 public:
     void onEvent(const Event& event) override {
-        std::string eventName = "[EVENT]";
-        Logger::log(LogLevel::INFO, eventName + " " + event.entityType + 
-                   "#" + std::to_string(event.entityId) + " | " + event.details);
+        Logger::log(LogLevel::INFO, "[EVENT] " + describeEvent(event));
     }
     std::string getName() const override { return "LoggerListener"; }
 };
@@ -89,7 +752,8 @@ class AuditListener : public EventListener {
 public:
     void onEvent(const Event& event) override {
         // In production: write to audit table with full details
-        Logger::log(LogLevel::INFO, "AUDIT: " + event.entityType + " operation: " + event.details);
+        Logger::log(LogLevel::INFO, "AUDIT: " + std::string(entityTypeName(event.entityType)) +
+                                    " operation: " + describeEvent(event));
     }
     std::string getName() const override { return "AuditListener"; }
 };
@@ -98,8 +762,10 @@ class AnalyticsListener : public EventListener {
 public:
     void onEvent(const Event& event) override {
         // In production: update metrics, send to analytics service
-        Logger::log(LogLevel::DEBUG, "ANALYTICS: Tracked " + event.entityType + " event");
+        LOGF_DEBUG("ANALYTICS: Tracked ", entityTypeName(event.entityType), " event");
     }
+    // Only the latest stock level per item matters for metrics
+    bool acceptsBatches() const override { return true; }
     std::string getName() const override { return "AnalyticsListener"; }
 };
 
@@ -113,12 +779,25 @@ void initializeEventListeners() {
     auditListener = new AuditListener();
     analyticsListener = new AnalyticsListener();
     
-    EventBus::getInstance().subscribe(loggerListener);
-    EventBus::getInstance().subscribe(auditListener);
-    EventBus::getInstance().subscribe(analyticsListener);
+    const auto capacity = static_cast<std::size_t>(Config::getInt("EVENT_QUEUE_CAPACITY", 1024));
+    
+    // Bulk inventory updates reach batch-capable listeners as one span
+    const auto maxBatch = static_cast<std::size_t>(Config::getInt("EVENT_COALESCE_MAX_BATCH", 1024));
+    const std::chrono::milliseconds window(Config::getInt("EVENT_COALESCE_WINDOW_MS", 50));
+    EventBus::getInstance().setCoalescing(EventType::INVENTORY_UPDATED, maxBatch, window);
+    EventBus::getInstance().setCoalescing(EventType::INVENTORY_LOW, maxBatch, window);
+    
+    // Logging and analytics run off the request path; audit stays in lockstep
+    EventBus::getInstance().subscribe(loggerListener, DispatchMode::ASYNC, capacity);
+    EventBus::getInstance().subscribe(auditListener, DispatchMode::SYNC);
+    EventBus::getInstance().subscribe(analyticsListener, DispatchMode::ASYNC, capacity);
 }
 
 void cleanupEventListeners() {
+    // Deliver everything already emitted before the listeners go away
+    EventBus::getInstance().flushBatches();
+    EventBus::getInstance().drainAsync();
+    
     if (loggerListener) { EventBus::getInstance().unsubscribe(loggerListener); delete loggerListener; }
     if (auditListener) { EventBus::getInstance().unsubscribe(auditListener); delete auditListener; }
     if (analyticsListener) { EventBus::getInstance().unsubscribe(analyticsListener); delete analyticsListener; }
@@ -1,5 +1,9 @@
 #include "HealthService.h"
+#include "EventSystem.h"
+#include "IdempotencyService.h"
+#include "LockManager.h"
 #include "Logger.h"
+#include "CachingStorageStrategy.h"
 #include <fstream>
 #include <filesystem>
 #include <sstream>
@@ -48,6 +52,53 @@ SystemHealth HealthService::checkHealth() {
         }
     }
     
+    // Async event queues (backpressure)
+    health.eventQueueSize = EventBus::getInstance().getQueuedEventCount();
+    for (const auto& q : EventBus::getInstance().getQueueStats()) {
+        if (q.dropped > 0) {
+            health.warnings.push_back("Event queue '" + q.listenerName + "' dropped " +
+                                      std::to_string(q.dropped) + " events");
+        }
+    }
+    
+    // Idempotency fast-negative filter (undersized filters push lookups to the registry)
+    const IdempotencyFilterStats filter = IdempotencyService::getFilterStats();
+    health.idempotencyFilterFalsePositiveRate = filter.falsePositiveRate();
+    if (filter.definitelyNew + filter.falsePositives >= 1000 &&
+        health.idempotencyFilterFalsePositiveRate > 0.05) {
+        health.warnings.push_back("Idempotency filter false-positive rate " +
+                                  std::to_string(health.idempotencyFilterFalsePositiveRate * 100) +
+                                  "%, raise IDEMPOTENCY_FILTER_EXPECTED_KEYS");
+    }
+    
+    // Entity lock contention
+    const LockWaitStats locks = LockManager::instance().getWaitStats();
+    health.lockWaitP99Ms = locks.percentileMs(0.99);
+    health.lockDeadlocks = locks.deadlocks;
+    if (locks.waits >= 100 && health.lockWaitP99Ms > 100.0) {
+        health.warnings.push_back("Entity lock wait p99 above " + std::to_string(static_cast<int>(health.lockWaitP99Ms)) +
+                                  " ms, " + std::to_string(locks.deadlocks) + " deadlocks resolved");
+    }
+    
+    // Write-behind storage cache
+    StorageCacheStats cache;
+    health.storageCacheEnabled = StorageManager::instance().getCacheStats(cache);
+    if (health.storageCacheEnabled) {
+        health.storageCacheHitRatio = cache.hitRatio();
+        health.storageFlushMeanMs = cache.meanFlushMs();
+        health.storageFlushMaxMs = cache.maxFlushMs;
+        health.storageDirtyRecords = cache.dirtyRecords;
+        health.storageFlushFailures = cache.flushFailures;
+        if (!StorageManager::instance().getStrategy().isHealthy()) {
+            health.issues.push_back("Storage cache cannot flush to " + StorageManager::instance().getStorageType() +
+                                    " (" + std::to_string(cache.dirtyRecords) + " records unwritten)");
+            health.overallStatus = SystemHealth::Status::UNHEALTHY;
+        } else if (cache.flushes >= 10 && health.storageFlushMeanMs > 100.0) {
+            health.warnings.push_back("Storage cache flushes average " +
+                                      std::to_string(static_cast<int>(health.storageFlushMeanMs)) + " ms");
+        }
+    }
+    
     // Estimate memory
     health.estimatedMemoryMB = estimateMemoryUsage();
     
@@ -92,6 +143,17 @@ std::string HealthService::getDetailedReport() {
     ss << "\nMetrics:\n";
     ss << "  Estimated Memory: " << health.estimatedMemoryMB << " MB\n";
     ss << "  Event Queue Size: " << health.eventQueueSize << " events\n";
+    ss << "  Idempotency Filter False Positives: " << health.idempotencyFilterFalsePositiveRate * 100 << "%\n";
+    ss << "  Entity Lock Wait p99: " << health.lockWaitP99Ms << " ms (" << health.lockDeadlocks << " deadlocks)\n";
+    const LockWaitStats locks = LockManager::instance().getWaitStats();
+    for (size_t i = 0; i < LockWaitStats::BUCKETS; ++i) {
+        ss << "    " << LockWaitStats::bucketLabel(i) << ": " << locks.buckets[i] << "\n";
+    }
+    if (health.storageCacheEnabled) {
+        ss << "  Storage Cache Hit Ratio: " << health.storageCacheHitRatio * 100 << "%\n";
+        ss << "  Storage Flush: mean " << health.storageFlushMeanMs << " ms, max " << health.storageFlushMaxMs
+           << " ms (" << health.storageDirtyRecords << " dirty, " << health.storageFlushFailures << " failures)\n";
+    }
     
     if (!health.issues.empty()) {
         ss << "\nIssues:\n";
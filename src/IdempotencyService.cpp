@@ -1,87 +1,431 @@
 #include "IdempotencyService.h"
+#include "BloomFilter.h"
 #include "Logger.h"
+#include "TimingWheel.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 
-std::map<std::string, IdempotencyRecord> IdempotencyService::registry;
+namespace {
+constexpr std::uint32_t TOMBSTONE = 0xFFFFFFFFu;
+constexpr unsigned CHUNK_BITS = 10;   // 1024 records per slab chunk
+constexpr std::uint32_t CHUNK_MASK = (1u << CHUNK_BITS) - 1;
+constexpr unsigned SHARD_SHIFT = 58;  // Top 6 bits pick one of 64 shards
+constexpr std::size_t DEFAULT_FILTER_KEYS = 100000;
+constexpr double DEFAULT_FILTER_FP_RATE = 0.01;
+static_assert((IdempotencyService::SHARD_COUNT >> (64 - SHARD_SHIFT)) == 1, "shard bits mismatch");
+}
+
+/**
+ * One shard: open-addressing index (hash -> record slot) with linear
+ * probing, plus a slab of records that never moves
+ * slotHash 0 marks an empty slot; slotRecord TOMBSTONE a deleted one
+ * Each stored record is scheduled on the shard's timing wheel; meta
+ * holds its hash and current deadline (0 once freed) to spot stale fires
+ * The counting Bloom filter mirrors the live keys and is read without the
+ * lock; replaced filters stay allocated since a reader may still hold one
+ * inFlight holds claimed request IDs that have no outcome yet; the shared
+ * future is the waiter list
+ */
+struct IdempotencyService::Shard {
+    mutable std::shared_mutex mutex;
+
+    std::vector<std::uint64_t> slotHash;
+    std::vector<std::uint32_t> slotRecord;
+    std::size_t used = 0;   // Live entries + tombstones
+    std::size_t live = 0;
+
+    std::vector<std::unique_ptr<IdempotencyRecord[]>> chunks;
+    std::vector<std::uint32_t> freeRecords;
+    std::uint32_t nextRecord = 0;
+
+    struct RecordMeta {
+        std::uint64_t hash;
+        std::time_t expiresAt;   // First second the record counts as expired
+    };
+    std::vector<RecordMeta> meta;
+    TimingWheel wheel;
+
+    std::atomic<CountingBloomFilter*> filter{nullptr};
+    std::vector<std::unique_ptr<CountingBloomFilter>> filters;   // Current one last
+
+    struct InFlight {
+        std::promise<IdempotencyOutcome> promise;
+        std::shared_future<IdempotencyOutcome> result;
+    };
+    std::unordered_map<std::string, InFlight> inFlight;
+
+    // Detach the in-flight entry for requestId, if any (caller holds the lock)
+    std::optional<std::promise<IdempotencyOutcome>> release(const std::string& requestId) {
+        if (inFlight.empty()) return std::nullopt;
+        auto it = inFlight.find(requestId);
+        if (it == inFlight.end()) return std::nullopt;
+        std::optional<std::promise<IdempotencyOutcome>> promise(std::move(it->second.promise));
+        inFlight.erase(it);
+        return promise;
+    }
+
+    alignas(64) std::atomic<std::uint64_t> definitelyNew{0};
+    std::atomic<std::uint64_t> falsePositives{0};
+
+    Shard() {
+        replaceFilter(DEFAULT_FILTER_KEYS / SHARD_COUNT, DEFAULT_FILTER_FP_RATE);
+    }
+
+    // Build a filter over the live keys and publish it (caller holds the lock)
+    void replaceFilter(std::size_t expectedKeys, double falsePositiveRate) {
+        filters.emplace_back(new CountingBloomFilter(expectedKeys, falsePositiveRate));
+        CountingBloomFilter* next = filters.back().get();
+        for (std::size_t i = 0; i < slotHash.size(); ++i) {
+            if (slotHash[i] != 0 && slotRecord[i] != TOMBSTONE) next->add(slotHash[i]);
+        }
+        filter.store(next, std::memory_order_release);
+    }
+
+    IdempotencyRecord& record(std::uint32_t index) {
+        return chunks[index >> CHUNK_BITS][index & CHUNK_MASK];
+    }
+
+    // Slot holding requestId, or -1
+    long find(std::uint64_t hash, const std::string& requestId) {
+        if (slotHash.empty()) return -1;
+        const std::size_t mask = slotHash.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            if (slotHash[i] == 0) return -1;
+            if (slotHash[i] == hash && slotRecord[i] != TOMBSTONE &&
+                record(slotRecord[i]).requestId == requestId) {
+                return static_cast<long>(i);
+            }
+        }
+    }
+
+    std::uint32_t allocateRecord() {
+        if (!freeRecords.empty()) {
+            const std::uint32_t index = freeRecords.back();
+            freeRecords.pop_back();
+            return index;
+        }
+        if ((nextRecord & CHUNK_MASK) == 0) {
+            chunks.emplace_back(new IdempotencyRecord[CHUNK_MASK + 1]);
+            meta.resize(nextRecord + CHUNK_MASK + 1, RecordMeta{0, 0});
+        }
+        return nextRecord++;
+    }
+
+    void insert(std::uint64_t hash, std::uint32_t recordIndex) {
+        if ((used + 1) * 10 > slotHash.size() * 7) rehash();
+        const std::size_t mask = slotHash.size() - 1;
+        std::size_t i = hash & mask;
+        while (slotHash[i] != 0 && slotRecord[i] != TOMBSTONE) i = (i + 1) & mask;
+        if (slotHash[i] == 0) ++used;   // Reusing a tombstone keeps `used`
+        filter.load(std::memory_order_relaxed)->add(hash);
+        slotHash[i] = hash;
+        slotRecord[i] = recordIndex;
+        ++live;
+    }
+
+    void erase(std::size_t slot) {
+        const std::uint32_t index = slotRecord[slot];
+        record(index) = IdempotencyRecord{};   // Release the strings now
+        filter.load(std::memory_order_relaxed)->remove(slotHash[slot]);
+        meta[index].expiresAt = 0;
+        freeRecords.push_back(index);
+        slotRecord[slot] = TOMBSTONE;         // Hash stays so probe chains hold
+        --live;
+    }
+
+    // Reclaim records whose deadline has passed; cost follows the number due
+    std::size_t expireDue(std::time_t now) {
+        std::size_t removed = 0;
+        wheel.advance(now, [&](std::uint32_t index, std::time_t deadline) {
+            if (meta[index].expiresAt != deadline) return;   // Freed or refreshed since
+            const long slot = find(meta[index].hash, record(index).requestId);
+            if (slot >= 0) {
+                erase(static_cast<std::size_t>(slot));
+                ++removed;
+            }
+        });
+        return removed;
+    }
+
+    // Insert or overwrite the record for requestId and (re)schedule its expiry
+    // Caller fills in the outcome fields
+    IdempotencyRecord& upsert(std::uint64_t hash, const std::string& requestId,
+                              std::time_t createdAt, int ttlSeconds) {
+        const long slot = find(hash, requestId);
+        std::uint32_t index;
+        if (slot >= 0) {
+            index = slotRecord[slot];
+        } else {
+            index = allocateRecord();
+            insert(hash, index);
+        }
+        // Assign in place so a reused slab slot keeps its string capacity
+        IdempotencyRecord& entry = record(index);
+        entry.requestId = requestId;
+        entry.createdAt = createdAt;
+        entry.ttlSeconds = ttlSeconds;
+
+        const std::time_t deadline = createdAt + ttlSeconds + 1;
+        meta[index] = {hash, deadline};
+        wheel.schedule(index, deadline);
+        return entry;
+    }
+
+    // Grow to keep live entries under half full and drop tombstones
+    void rehash() {
+        std::size_t capacity = 16;
+        while ((live + 1) * 2 > capacity) capacity <<= 1;
+        std::vector<std::uint64_t> oldHash(capacity, 0);
+        std::vector<std::uint32_t> oldRecord(capacity, 0);
+        oldHash.swap(slotHash);
+        oldRecord.swap(slotRecord);
+
+        const std::size_t mask = capacity - 1;
+        for (std::size_t j = 0; j < oldHash.size(); ++j) {
+            if (oldHash[j] == 0 || oldRecord[j] == TOMBSTONE) continue;
+            std::size_t i = oldHash[j] & mask;
+            while (slotHash[i] != 0) i = (i + 1) & mask;
+            slotHash[i] = oldHash[j];
+            slotRecord[i] = oldRecord[j];
+        }
+        used = live;
+    }
+};
+
+IdempotencyService::Shard IdempotencyService::shards[IdempotencyService::SHARD_COUNT];
 int IdempotencyService::defaultTTLSeconds = 86400;  // 24 hours
+IdempotencyStore IdempotencyService::durableStore;
+
+std::uint64_t IdempotencyService::hashRequestId(const std::string& requestId) {
+    std::uint64_t h = 14695981039346656037ull;   // FNV-1a
+    for (unsigned char c : requestId) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    // Finalizer so both the shard (high) and slot (low) bits are well mixed
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h ? h : 1;
+}
+
+IdempotencyService::Shard& IdempotencyService::shardFor(std::uint64_t hash) {
+    return shards[hash >> SHARD_SHIFT];
+}
 
 bool IdempotencyService::isDuplicate(const std::string& requestId, std::string& cachedResult) {
-    auto it = registry.find(requestId);
-    
-    if (it == registry.end()) {
-        // Not seen before
+    const std::uint64_t hash = hashRequestId(requestId);
+    Shard& shard = shardFor(hash);
+
+    // Fast negative: most request IDs are new and never reach the table
+    if (!shard.filter.load(std::memory_order_acquire)->mayContain(hash)) {
+        shard.definitelyNew.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
-    
-    IdempotencyRecord& record = it->second;
-    
-    // Check if expired
-    if (record.isExpired()) {
-        Logger::log(LogLevel::DEBUG, "IdempotencyService: Request " + requestId + " record expired");
-        registry.erase(it);
-        return false;
+
+    const std::time_t now = std::time(nullptr);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const long slot = shard.find(hash, requestId);
+        if (slot < 0) {
+            // Not seen before; the filter was wrong
+            shard.falsePositives.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const IdempotencyRecord& record = shard.record(shard.slotRecord[slot]);
+        if (!record.isExpired(now)) {
+            // Return cached result
+            cachedResult = record.resultData;
+            lock.unlock();
+            LOGF_INFO("IdempotencyService: Duplicate request ", requestId,
+                      " detected, returning cached result");
+            return true;
+        }
+    }
+
+    // Expired: its wheel entry is due, so reclaiming the shard drops it
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.expireDue(now);
+    }
+    LOGF_DEBUG("IdempotencyService: Request ", requestId, " record expired");
+    return false;
+}
+
+void IdempotencyService::store(const std::string& requestId, const std::string& operationType,
+                               bool succeeded, const std::string& resultData) {
+    const std::uint64_t hash = hashRequestId(requestId);
+    Shard& shard = shardFor(hash);
+    const std::time_t now = std::time(nullptr);
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.expireDue(now);   // Incremental reclamation on the write path
+    IdempotencyRecord& record = shard.upsert(hash, requestId, now, defaultTTLSeconds);
+    record.operationType = operationType;
+    record.succeeded = succeeded;
+    record.resultData = resultData;
+
+    // Appended under the shard lock so the log keeps per-key write order
+    if (durableStore.isOpen()) durableStore.append(record);
+
+    auto waiting = shard.release(requestId);
+    lock.unlock();
+    if (waiting) {
+        waiting->set_value({succeeded ? IdempotencyOutcome::Status::SUCCEEDED
+                                      : IdempotencyOutcome::Status::FAILED,
+                            resultData});
+    }
+}
+
+IdempotencyClaim IdempotencyService::claim(const std::string& requestId) {
+    const std::uint64_t hash = hashRequestId(requestId);
+    Shard& shard = shardFor(hash);
+    const std::time_t now = std::time(nullptr);
+    IdempotencyClaim claim;
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.expireDue(now);
+
+    // Already succeeded: hand back the stored outcome. A stored failure
+    // is dropped so this retry runs the operation again
+    const long slot = shard.find(hash, requestId);
+    if (slot >= 0) {
+        const IdempotencyRecord& record = shard.record(shard.slotRecord[slot]);
+        if (record.succeeded) {
+            std::promise<IdempotencyOutcome> done;
+            done.set_value({IdempotencyOutcome::Status::SUCCEEDED, record.resultData});
+            claim.result = done.get_future().share();
+            return claim;
+        }
+        shard.erase(static_cast<std::size_t>(slot));
+    }
+
+    // Still running: wait on the first caller
+    auto it = shard.inFlight.find(requestId);
+    if (it != shard.inFlight.end()) {
+        claim.result = it->second.result;
+        lock.unlock();
+        LOGF_INFO("IdempotencyService: Request ", requestId, " in flight, waiting for its result");
+        return claim;
+    }
+
+    Shard::InFlight& entry = shard.inFlight[requestId];
+    entry.result = entry.promise.get_future().share();
+    claim.owner = true;
+    claim.result = entry.result;
+    return claim;
+}
+
+void IdempotencyService::abandonRequest(const std::string& requestId) {
+    const std::uint64_t hash = hashRequestId(requestId);
+    Shard& shard = shardFor(hash);
+
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto waiting = shard.release(requestId);
+    lock.unlock();
+    if (waiting) {
+        waiting->set_value({IdempotencyOutcome::Status::ABANDONED, ""});
+        LOGF_WARN("IdempotencyService: Request ", requestId, " abandoned");
     }
-    
-    // Return cached result
-    cachedResult = record.resultData;
-    Logger::log(LogLevel::INFO, "IdempotencyService: Duplicate request " + requestId + 
-               " detected, returning cached result");
-    return true;
 }
 
-void IdempotencyService::recordSuccess(const std::string& requestId, 
+void IdempotencyService::recordSuccess(const std::string& requestId,
                                       const std::string& operationType,
                                       const std::string& resultData) {
-    registry[requestId] = {
-        requestId,
-        operationType,
-        true,
-        resultData,
-        std::time(nullptr),
-        defaultTTLSeconds
-    };
-    Logger::log(LogLevel::INFO, "IdempotencyService: Recorded success for " + requestId);
+    store(requestId, operationType, true, resultData);
+    LOGF_INFO("IdempotencyService: Recorded success for ", requestId);
 }
 
-void IdempotencyService::recordFailure(const std::string& requestId, 
+void IdempotencyService::recordFailure(const std::string& requestId,
                                       const std::string& operationType) {
-    registry[requestId] = {
-        requestId,
-        operationType,
-        false,
-        "",
-        std::time(nullptr),
-        defaultTTLSeconds
-    };
-    Logger::log(LogLevel::WARNING, "IdempotencyService: Recorded failure for " + requestId);
+    store(requestId, operationType, false, "");
+    LOGF_WARN("IdempotencyService: Recorded failure for ", requestId);
 }
 
 IdempotencyRecord* IdempotencyService::getRecord(const std::string& requestId) {
-    auto it = registry.find(requestId);
-    if (it != registry.end()) {
-        return &(it->second);
-    }
-    return nullptr;
+    const std::uint64_t hash = hashRequestId(requestId);
+    Shard& shard = shardFor(hash);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    const long slot = shard.find(hash, requestId);
+    return slot >= 0 ? &shard.record(shard.slotRecord[slot]) : nullptr;
 }
 
 void IdempotencyService::cleanupExpired() {
-    int removed = 0;
-    auto it = registry.begin();
-    while (it != registry.end()) {
-        if (it->second.isExpired()) {
-            it = registry.erase(it);
-            removed++;
-        } else {
-            ++it;
-        }
+    const std::time_t now = std::time(nullptr);
+    std::size_t removed = 0;
+    for (Shard& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        removed += shard.expireDue(now);
     }
+    durableStore.compactIfGrown(now);
     if (removed > 0) {
-        Logger::log(LogLevel::INFO, "IdempotencyService: Cleaned up " + std::to_string(removed) + 
+        Logger::log(LogLevel::INFO, "IdempotencyService: Cleaned up " + std::to_string(removed) +
                    " expired records");
     }
 }
 
 int IdempotencyService::getTrackedCount() {
-    return static_cast<int>(registry.size());
+    std::size_t total = 0;
+    for (Shard& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.live;
+    }
+    return static_cast<int>(total);
+}
+
+bool IdempotencyService::enablePersistence(const std::string& path, std::size_t initialBytes) {
+    const std::time_t now = std::time(nullptr);
+    std::string requestId;
+    return durableStore.open(path, initialBytes, [&](const IdempotencyStore::RecordView& view) {
+        // Later records supersede earlier ones; an expired latest record drops the key
+        requestId.assign(view.requestId.data(), view.requestId.size());
+        const std::uint64_t hash = hashRequestId(requestId);
+        Shard& shard = shardFor(hash);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.expireDue(now);
+        if ((now - view.createdAt) > view.ttlSeconds) {
+            const long slot = shard.find(hash, requestId);
+            if (slot >= 0) shard.erase(static_cast<std::size_t>(slot));
+            return;
+        }
+        IdempotencyRecord& record = shard.upsert(hash, requestId, view.createdAt, view.ttlSeconds);
+        record.operationType.assign(view.operationType.data(), view.operationType.size());
+        record.succeeded = view.succeeded;
+        record.resultData.assign(view.resultData.data(), view.resultData.size());
+    });
+}
+
+void IdempotencyService::disablePersistence() {
+    durableStore.close();
+}
+
+void IdempotencyService::syncPersistence() {
+    durableStore.sync();
+}
+
+void IdempotencyService::configureFilter(std::size_t expectedKeys, double falsePositiveRate) {
+    for (Shard& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.replaceFilter(expectedKeys / SHARD_COUNT + 1, falsePositiveRate);
+    }
+    Logger::log(LogLevel::INFO, "IdempotencyService: Filter sized for " + std::to_string(expectedKeys) +
+               " keys at " + std::to_string(falsePositiveRate * 100) + "% false positives");
+}
+
+IdempotencyFilterStats IdempotencyService::getFilterStats() {
+    IdempotencyFilterStats stats;
+    for (Shard& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        stats.definitelyNew += shard.definitelyNew.load(std::memory_order_relaxed);
+        stats.falsePositives += shard.falsePositives.load(std::memory_order_relaxed);
+        stats.memoryBytes += shard.filter.load(std::memory_order_relaxed)->memoryBytes();
+    }
+    return stats;
 }
 
 void IdempotencyService::setDefaultTTL(int seconds) {
@@ -0,0 +1,233 @@
+#include "IdempotencyStore.h"
+#include "BinaryLog.h"
+#include "IdempotencyService.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char STORE_MAGIC[8] = {'R', 'M', 'S', 'I', 'D', 'M', '0', '1'};
+constexpr std::size_t STORE_HEADER = sizeof(STORE_MAGIC) + sizeof(std::uint64_t);
+constexpr std::size_t MIN_COMPACT_BYTES = 1024 * 1024;   // Not worth rewriting below this
+
+void putField(std::string& out, const std::string& value) {
+    BinaryLog::putVarint(out, value.size());
+    out += value;
+}
+
+bool getField(const char* data, std::size_t size, std::size_t& pos, std::string_view& value) {
+    std::uint64_t len;
+    if (!BinaryLog::getVarint(data, size, pos, len) || len > size - pos) return false;
+    value = std::string_view(data + pos, static_cast<std::size_t>(len));
+    pos += static_cast<std::size_t>(len);
+    return true;
+}
+
+void encodeRecord(std::string& out, const IdempotencyRecord& record) {
+    out += static_cast<char>(record.succeeded ? 1 : 0);
+    BinaryLog::putVarint(out, BinaryLog::zigzag(static_cast<std::int64_t>(record.createdAt)));
+    BinaryLog::putVarint(out, BinaryLog::zigzag(record.ttlSeconds));
+    putField(out, record.requestId);
+    putField(out, record.operationType);
+    putField(out, record.resultData);
+}
+
+bool decodeRecord(const char* data, std::size_t size, IdempotencyStore::RecordView& view) {
+    if (size < 1) return false;
+    view.succeeded = data[0] != 0;
+    std::size_t pos = 1;
+    std::uint64_t value;
+    if (!BinaryLog::getVarint(data, size, pos, value)) return false;
+    view.createdAt = static_cast<std::time_t>(BinaryLog::unzigzag(value));
+    if (!BinaryLog::getVarint(data, size, pos, value)) return false;
+    view.ttlSeconds = static_cast<int>(BinaryLog::unzigzag(value));
+    return getField(data, size, pos, view.requestId) &&
+           getField(data, size, pos, view.operationType) &&
+           getField(data, size, pos, view.resultData) && pos == size;
+}
+
+bool isExpired(const IdempotencyStore::RecordView& view, std::time_t now) {
+    return (now - view.createdAt) > view.ttlSeconds;
+}
+
+} // namespace
+
+IdempotencyStore::~IdempotencyStore() {
+    close();
+}
+
+bool IdempotencyStore::map(std::size_t bytes) {
+    if (!file.open(path, bytes)) {
+        Logger::log(LogLevel::ERROR, "IdempotencyStore: Cannot map " + path);
+        return false;
+    }
+    return true;
+}
+
+bool IdempotencyStore::open(const std::string& storePath, std::size_t initialBytes,
+                            const std::function<void(const RecordView&)>& visitor) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (file.isOpen()) return true;
+
+        path = storePath;
+        std::error_code ec;
+        const fs::path parent = fs::path(path).parent_path();
+        if (!parent.empty()) fs::create_directories(parent, ec);
+        fs::remove(path + ".tmp", ec);   // Leftover from an interrupted compaction
+
+        if (!map(std::max(initialBytes, STORE_HEADER + 4096))) return false;
+        static const char zeros[sizeof(STORE_MAGIC)] = {};
+        if (std::memcmp(file.data(), zeros, sizeof(zeros)) == 0) {
+            std::memcpy(file.data(), STORE_MAGIC, sizeof(STORE_MAGIC));
+        } else if (std::memcmp(file.data(), STORE_MAGIC, sizeof(STORE_MAGIC)) != 0) {
+            Logger::log(LogLevel::ERROR, "IdempotencyStore: Bad header in " + path);
+            file.close();
+            return false;
+        }
+    }
+
+    // Single sequential pass: recovery and index rebuild together. Appends
+    // are still refused, and the visitor runs unlocked because it takes the
+    // registry's shard locks (append() nests the other way round)
+    std::size_t count = 0;
+    RecordView view;
+    const std::size_t end = BinaryLog::scanFrames(file.data(), STORE_HEADER, file.size(),
+                                                  [&](const char* body, std::size_t len) {
+        if (!decodeRecord(body, len, view)) return false;
+        visitor(view);
+        ++count;
+        return true;
+    });
+
+    std::lock_guard<std::mutex> lock(mutex);
+    writeOffset = end;
+    compactedBytes = end;
+    accepting.store(true, std::memory_order_release);
+    Logger::log(LogLevel::INFO, "IdempotencyStore: Loaded " + std::to_string(count) +
+                               " records from " + path);
+    return true;
+}
+
+void IdempotencyStore::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.isOpen()) return;
+    accepting.store(false, std::memory_order_release);
+    file.sync(0, writeOffset);
+    file.close();
+}
+
+bool IdempotencyStore::append(const IdempotencyRecord& record) {
+    if (!isOpen()) return false;
+
+    // Encode outside the lock; the critical section is a memcpy
+    thread_local std::string body;
+    body.clear();
+    encodeRecord(body, record);
+    const std::size_t need = BinaryLog::FRAME_HEADER + body.size();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.isOpen()) return false;
+    if (writeOffset + need > file.size() && !grow(need)) return false;
+    BinaryLog::writeFrame(file.data(), writeOffset, body);
+    return true;
+}
+
+// Out of room: remap larger. Callers hold IdempotencyService shard locks,
+// so compaction is left to compactIfGrown() (cleanupExpired)
+bool IdempotencyStore::grow(std::size_t need) {
+    const std::size_t bytes = std::max(file.size() * 2, writeOffset + need);
+    file.close();
+    if (!map(bytes)) {
+        accepting.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+std::size_t IdempotencyStore::compact(std::time_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.isOpen()) return 0;
+    return compactLocked(now);
+}
+
+bool IdempotencyStore::compactIfGrown(std::time_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.isOpen() || writeOffset < MIN_COMPACT_BYTES || writeOffset < compactedBytes * 2) {
+        return false;
+    }
+    compactLocked(now);
+    return true;
+}
+
+std::size_t IdempotencyStore::compactLocked(std::time_t now) {
+    const char* data = file.data();
+    RecordView view;
+
+    // Pass 1: the offset of the latest record per request ID
+    std::unordered_map<std::string_view, std::size_t> latest;
+    BinaryLog::scanFrames(data, STORE_HEADER, writeOffset, [&](const char* body, std::size_t len) {
+        if (!decodeRecord(body, len, view)) return false;
+        latest[view.requestId] = static_cast<std::size_t>(body - data);
+        return true;
+    });
+
+    // Pass 2: copy the survivors into a fresh file
+    const std::string tmpPath = path + ".tmp";
+    const std::size_t bytes = file.size();
+    std::size_t offset = STORE_HEADER;
+    {
+        MappedFile out;
+        if (!out.open(tmpPath, bytes)) {
+            Logger::log(LogLevel::ERROR, "IdempotencyStore: Cannot create " + tmpPath);
+            return 0;
+        }
+        std::memcpy(out.data(), STORE_MAGIC, sizeof(STORE_MAGIC));
+        BinaryLog::scanFrames(data, STORE_HEADER, writeOffset, [&](const char* body, std::size_t len) {
+            if (!decodeRecord(body, len, view)) return false;
+            if (latest[view.requestId] == static_cast<std::size_t>(body - data) && !isExpired(view, now)) {
+                const std::size_t frame = BinaryLog::FRAME_HEADER + len;
+                std::memcpy(out.data() + offset, body - BinaryLog::FRAME_HEADER, frame);
+                offset += frame;
+            }
+            return true;
+        });
+        out.sync(0, offset);
+    }
+
+    // Swap: the rename is atomic, so a crash leaves either the old or the new log
+    std::error_code ec;
+    file.close();
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        Logger::log(LogLevel::ERROR, "IdempotencyStore: Compaction rename failed: " + ec.message());
+        fs::remove(tmpPath, ec);
+        if (!map(bytes)) accepting.store(false, std::memory_order_release);
+        return 0;
+    }
+    if (!map(bytes)) {
+        accepting.store(false, std::memory_order_release);
+        return 0;
+    }
+
+    const std::size_t reclaimed = writeOffset - offset;
+    LOGF_INFO("IdempotencyStore: Compacted ", path, ", reclaimed ", reclaimed, " bytes");
+    writeOffset = offset;
+    compactedBytes = offset;
+    return reclaimed;
+}
+
+void IdempotencyStore::sync() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.isOpen()) file.sync(0, writeOffset);
+}
+
+std::size_t IdempotencyStore::getUsedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writeOffset;
+}
@@ -0,0 +1,283 @@
+#include "LockManager.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using WaitForGraph = std::unordered_map<std::uint64_t, std::vector<std::uint64_t>>;
+
+// Some cycle in the wait-for graph (iterative DFS), empty if there is none
+std::vector<std::uint64_t> findCycle(const WaitForGraph& edges) {
+    enum : std::uint8_t { UNVISITED, ON_PATH, DONE };
+    std::unordered_map<std::uint64_t, std::uint8_t> color;
+    std::vector<std::pair<std::uint64_t, std::size_t>> path;   // Node, next edge to follow
+
+    for (const auto& start : edges) {
+        if (color[start.first] != UNVISITED) continue;
+        color[start.first] = ON_PATH;
+        path.assign(1, {start.first, 0});
+        while (!path.empty()) {
+            const std::uint64_t node = path.back().first;
+            const auto out = edges.find(node);
+            if (out == edges.end() || path.back().second >= out->second.size()) {
+                color[node] = DONE;
+                path.pop_back();
+                continue;
+            }
+            const std::uint64_t next = out->second[path.back().second++];
+            std::uint8_t& state = color[next];
+            if (state == ON_PATH) {
+                std::vector<std::uint64_t> cycle;
+                bool inCycle = false;
+                for (const auto& step : path) {
+                    if (step.first == next) inCycle = true;
+                    if (inCycle) cycle.push_back(step.first);
+                }
+                return cycle;
+            }
+            if (state == UNVISITED) {
+                state = ON_PATH;
+                path.push_back({next, 0});
+            }
+        }
+    }
+    return {};
+}
+
+thread_local std::vector<std::uint64_t> blocking;   // acquire() scratch
+
+} // namespace
+
+// ============ LockWaitStats ============
+
+const char* LockWaitStats::bucketLabel(std::size_t bucket) {
+    static const char* const labels[BUCKETS] = {"<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s"};
+    return bucket < BUCKETS ? labels[bucket] : "";
+}
+
+double LockWaitStats::percentileMs(double percentile) const {
+    if (waits == 0) return 0.0;
+    const auto target = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(percentile * static_cast<double>(waits))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i + 1 < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= target) return BUCKET_LIMIT_US[i] / 1000.0;
+    }
+    return BUCKET_LIMIT_US[BUCKETS - 2] / 1000.0;   // Open-ended bucket: its lower bound
+}
+
+// ============ LockManager ============
+
+LockManager& LockManager::instance() {
+    // Never destroyed: lock holders may still release during static teardown
+    static LockManager* manager = new LockManager();
+    return *manager;
+}
+
+void LockManager::blockers(const Entry& entry, const Request& request, std::vector<std::uint64_t>& out) const {
+    bool upgrade = false;
+    for (const auto& holder : entry.holders) {
+        if (holder.txId == request.txId) {
+            upgrade = true;
+        } else if (request.mode == LockMode::EXCLUSIVE || holder.mode == LockMode::EXCLUSIVE) {
+            out.push_back(holder.txId);
+        }
+    }
+    if (upgrade) return;   // Upgrades jump the queue
+
+    // FIFO: conflicting requests queued earlier go first
+    for (const auto& waiter : entry.waiters) {
+        if (waiter.txId == request.txId) break;
+        if (request.mode == LockMode::EXCLUSIVE || waiter.mode == LockMode::EXCLUSIVE) {
+            out.push_back(waiter.txId);
+        }
+    }
+}
+
+void LockManager::grant(Entry& entry, std::uint64_t key, const Request& request) {
+    for (auto& holder : entry.holders) {
+        if (holder.txId == request.txId) {
+            holder.mode = LockMode::EXCLUSIVE;   // Upgrade
+            return;
+        }
+    }
+    entry.holders.push_back(request);
+    transactions[request.txId].held.push_back(key);
+}
+
+void LockManager::dequeue(Entry& entry, std::uint64_t txId) {
+    for (auto it = entry.waiters.begin(); it != entry.waiters.end(); ++it) {
+        if (it->txId == txId) {
+            entry.waiters.erase(it);
+            return;
+        }
+    }
+}
+
+void LockManager::recordWait(std::chrono::steady_clock::duration waited) {
+    const auto us = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(waited).count());
+    std::size_t bucket = 0;
+    while (bucket < LockWaitStats::BUCKETS - 1 && us >= LockWaitStats::BUCKET_LIMIT_US[bucket]) ++bucket;
+    waitBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+LockResult LockManager::acquire(std::uint64_t txId, EntityType type, int id, LockMode mode,
+                                std::chrono::milliseconds timeout) {
+    const std::uint64_t key = keyOf(type, id);
+    const Request request{txId, mode};
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto& slot = table[key];
+    if (!slot) slot = std::make_unique<Entry>();
+    Entry& entry = *slot;
+
+    for (const auto& holder : entry.holders) {
+        if (holder.txId == txId && (holder.mode == LockMode::EXCLUSIVE || mode == LockMode::SHARED)) {
+            return LockResult::GRANTED;
+        }
+    }
+    blocking.clear();
+    blockers(entry, request, blocking);
+    if (blocking.empty()) {
+        grant(entry, key, request);
+        return LockResult::GRANTED;
+    }
+
+    // Wait; the deadlock detector may pick this transaction as its victim
+    entry.waiters.push_back(request);
+    TxLocks& tx = transactions[txId];
+    tx.waiting = true;
+    tx.waitingOn = key;
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + timeout;
+
+    LockResult result;
+    for (;;) {
+        if (tx.victim) {
+            result = LockResult::DEADLOCK;
+            break;
+        }
+        blocking.clear();
+        blockers(entry, request, blocking);
+        if (blocking.empty()) {
+            result = LockResult::GRANTED;
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            result = LockResult::TIMEOUT;
+            break;
+        }
+        entry.cv.wait_until(lock, deadline);
+    }
+
+    dequeue(entry, txId);
+    tx.waiting = false;
+    tx.victim = false;
+    recordWait(std::chrono::steady_clock::now() - start);
+    if (result == LockResult::GRANTED) {
+        grant(entry, key, request);
+    } else {
+        (result == LockResult::DEADLOCK ? deadlockCount : timeoutCount).fetch_add(1, std::memory_order_relaxed);
+        if (tx.held.empty()) transactions.erase(txId);
+    }
+    entry.cv.notify_all();   // The queue changed
+    if (entry.holders.empty() && entry.waiters.empty()) table.erase(key);
+    return result;
+}
+
+void LockManager::releaseAll(std::uint64_t txId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto tx = transactions.find(txId);
+    if (tx == transactions.end()) return;
+
+    for (const std::uint64_t key : tx->second.held) {
+        auto it = table.find(key);
+        if (it == table.end()) continue;
+        Entry& entry = *it->second;
+        entry.holders.erase(std::remove_if(entry.holders.begin(), entry.holders.end(),
+                                           [txId](const Request& r) { return r.txId == txId; }),
+                            entry.holders.end());
+        if (entry.holders.empty() && entry.waiters.empty()) {
+            table.erase(it);
+        } else {
+            entry.cv.notify_all();
+        }
+    }
+    transactions.erase(tx);
+}
+
+std::size_t LockManager::detectDeadlocks() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    WaitForGraph edges;
+    for (const auto& [txId, tx] : transactions) {
+        if (!tx.waiting || tx.victim) continue;
+        const Entry& entry = *table.at(tx.waitingOn);
+        for (const auto& waiter : entry.waiters) {
+            if (waiter.txId == txId) {
+                blockers(entry, waiter, edges[txId]);
+                break;
+            }
+        }
+    }
+
+    // Youngest member of each cycle stops waiting, which breaks the cycle
+    std::size_t victims = 0;
+    for (;;) {
+        const std::vector<std::uint64_t> cycle = findCycle(edges);
+        if (cycle.empty()) break;
+        const std::uint64_t victim = *std::max_element(cycle.begin(), cycle.end());
+        edges.erase(victim);
+        TxLocks& tx = transactions[victim];
+        tx.victim = true;
+        table.at(tx.waitingOn)->cv.notify_all();
+        victims++;
+        LOGF_WARN("LockManager: Deadlock among ", cycle.size(), " transactions, aborting transaction ", victim);
+    }
+    return victims;
+}
+
+void LockManager::detectorLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(detectorMutex);
+    while (!detectorCv.wait_for(lock, interval, [this] { return detectorStopping; })) {
+        lock.unlock();
+        detectDeadlocks();
+        lock.lock();
+    }
+}
+
+void LockManager::startDeadlockDetector(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(detectorMutex);
+    if (detector.joinable()) return;
+    detectorStopping = false;
+    detector = std::thread(&LockManager::detectorLoop, this, interval);
+    LOGF_INFO("LockManager: Deadlock detector running every ", interval.count(), " ms");
+}
+
+void LockManager::stopDeadlockDetector() {
+    {
+        std::lock_guard<std::mutex> lock(detectorMutex);
+        detectorStopping = true;
+    }
+    detectorCv.notify_all();
+    if (detector.joinable()) detector.join();
+}
+
+LockWaitStats LockManager::getWaitStats() const {
+    LockWaitStats stats;
+    for (std::size_t i = 0; i < LockWaitStats::BUCKETS; ++i) {
+        stats.buckets[i] = waitBuckets[i].load(std::memory_order_relaxed);
+        stats.waits += stats.buckets[i];
+    }
+    stats.deadlocks = deadlockCount.load(std::memory_order_relaxed);
+    stats.timeouts = timeoutCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::size_t LockManager::getLockedEntityCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return table.size();
+}
@@ -2,26 +2,439 @@
 #include <fstream>
 #include <iostream>
 #include <ctime>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 static std::ofstream logFile;
-static LogLevel currentLevel = LogLevel::INFO;
+static std::string logPath = "restaurant.log";
+static std::mutex syncMutex;   // Synchronous writes; producers fall back to them during shutdown()
+
+static const char* levelTag(LogLevel level) {
+    return level == LogLevel::INFO ? "[INFO]" :
+           level == LogLevel::WARNING ? "[WARN]" :
+           level == LogLevel::ERROR ? "[ERROR]" : "[DEBUG]";
+}
+
+// Same line layout in sync, async and decoded-binary output
+void Logger::formatLine(std::string& out, LogLevel level, std::time_t when, const std::string& msg) {
+    // ctime() dominates formatting cost; reformat only when the second changes
+    thread_local std::time_t cachedTime = -1;
+    thread_local std::string cachedStamp;
+    if (when != cachedTime) {
+        cachedTime = when;
+        char stamp[26];   // ctime() shares one static buffer across threads
+        cachedStamp = ::ctime_r(&when, stamp);
+    }
+    out += levelTag(level);
+    out += ' ';
+    out += cachedStamp;
+    out += ' ';
+    out += msg;
+    out += '\n';
+}
+
+// ============================================================================
+// Async backend
+// ============================================================================
+
+namespace {
+
+struct LogEntry {
+    LogLevel level = LogLevel::INFO;
+    std::time_t time = 0;
+    std::string message;   // Capacity is reused once the slot has warmed up
+};
+
+// Single-producer/single-consumer ring owned by one logging thread
+struct LogRing {
+    explicit LogRing(std::size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+    bool tryPush(LogLevel level, std::time_t when, const std::string& msg) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size()) return false;
+        LogEntry& e = slots[t & mask];
+        e.level = level;
+        e.time = when;
+        e.message.assign(msg);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: format everything currently published into `out`
+    bool drainInto(std::string& out) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        const std::size_t t = tail.load(std::memory_order_acquire);
+        for (std::size_t i = h; i != t; ++i) {
+            const LogEntry& e = slots[i & mask];
+            Logger::formatLine(out, e.level, e.time, e.message);
+        }
+        head.store(t, std::memory_order_release);
+        return h != t;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    std::vector<LogEntry> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head{0};   // Next slot the writer reads
+    alignas(64) std::atomic<std::size_t> tail{0};   // Next slot the producer fills
+    std::atomic<bool> retired{false};               // Owning thread has exited
+    std::atomic<bool> pushing{false};               // Owner is inside enqueue()
+};
+
+struct RingHandle {
+    std::shared_ptr<LogRing> ring;
+    unsigned generation = 0;
+    ~RingHandle() {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+thread_local RingHandle localRing;
+
+std::atomic<bool> asyncEnabled{false};
+std::atomic<unsigned> asyncGeneration{0};
+std::atomic<std::size_t> droppedCount{0};
+std::size_t ringCapacity = 4096;
+LogOverflowPolicy overflowPolicy = LogOverflowPolicy::DROP;
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<LogRing>> rings;
+
+std::mutex wakeMutex;
+std::condition_variable wakeCv;
+std::condition_variable flushedCv;
+bool stopRequested = false;
+std::uint64_t flushRequested = 0;
+std::uint64_t flushCompleted = 0;
+
+std::thread writerThread;
+int fileFd = -1;
+
+void writeAll(int fd, const std::string& data) {
+    std::size_t off = 0;
+    while (off < data.size()) {
+        auto n = ::write(fd, data.data() + off, data.size() - off);
+        if (n <= 0) return;
+        off += static_cast<std::size_t>(n);
+    }
+}
+
+LogRing& threadRing() {
+    const unsigned gen = asyncGeneration.load(std::memory_order_acquire);
+    if (!localRing.ring || localRing.generation != gen) {
+        if (localRing.ring) localRing.ring->retired.store(true, std::memory_order_release);
+        localRing.ring = std::make_shared<LogRing>(ringCapacity);
+        localRing.generation = gen;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        rings.push_back(localRing.ring);
+    }
+    return *localRing.ring;
+}
+
+// False once shutdown() has begun: the caller writes synchronously instead.
+// `pushing` and asyncEnabled are both seq_cst, so shutdown() either sees
+// this push in flight and waits for it, or the push sees async mode off
+bool enqueue(LogLevel level, std::time_t when, const std::string& msg) {
+    LogRing& ring = threadRing();
+    ring.pushing.store(true);
+    if (!asyncEnabled.load()) {
+        ring.pushing.store(false, std::memory_order_release);
+        return false;
+    }
+    while (!ring.tryPush(level, when, msg)) {
+        if (overflowPolicy == LogOverflowPolicy::DROP) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        wakeCv.notify_one();
+        std::this_thread::yield();
+    }
+    ring.pushing.store(false, std::memory_order_release);
+    return true;
+}
+
+void drainAll(std::string& batch) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto it = rings.begin(); it != rings.end();) {
+        (*it)->drainInto(batch);
+        if ((*it)->retired.load(std::memory_order_acquire) && (*it)->empty()) {
+            it = rings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void writerLoop() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    for (;;) {
+        wakeCv.wait_for(lock, std::chrono::milliseconds(5),
+                        [] { return stopRequested || flushRequested != flushCompleted; });
+        const bool stopping = stopRequested;
+        const std::uint64_t target = flushRequested;
+        lock.unlock();
+
+        batch.clear();
+        drainAll(batch);
+        if (!batch.empty()) {
+            writeAll(STDOUT_FILENO, batch);
+            if (fileFd >= 0) writeAll(fileFd, batch);
+        }
+
+        lock.lock();
+        flushCompleted = target;
+        flushedCv.notify_all();
+        if (stopping) break;
+    }
+}
+
+// ============================================================================
+// Binary backend
+// ============================================================================
+
+struct FormatEntry {
+    LogLevel level;
+    std::string text;
+};
+
+constexpr std::size_t BINARY_FLUSH_BYTES = 64 * 1024;
+constexpr std::size_t FORMAT_CHUNK = 256;
+
+// Registered formats, published once and never changed or freed, so the
+// text fallback reads them without a lock; chunks appear as IDs need them
+struct FormatChunk {
+    std::atomic<const FormatEntry*> entries[FORMAT_CHUNK] = {};
+};
+std::atomic<FormatChunk*> formatChunks[(UINT16_MAX + 1) / FORMAT_CHUNK] = {};
+
+std::mutex binaryMutex;
+std::size_t formatCount = 1;   // ID 0 is reserved
+std::atomic<bool> binaryEnabled{false};
+std::string binaryBuffer;
+std::uint64_t lastBinaryNanos = 0;   // Timestamps are stored as deltas
+int binaryFd = -1;
+
+const FormatEntry* findFormat(std::uint16_t id) {
+    const FormatChunk* chunk = formatChunks[id / FORMAT_CHUNK].load(std::memory_order_acquire);
+    return chunk ? chunk->entries[id % FORMAT_CHUNK].load(std::memory_order_acquire) : nullptr;
+}
+
+void appendFormatDef(std::uint16_t id) {
+    const FormatEntry& f = *findFormat(id);
+    binaryBuffer += static_cast<char>(BinaryLog::FORMAT_DEF);
+    BinaryLog::put<std::uint16_t>(binaryBuffer, id);
+    BinaryLog::put<std::uint8_t>(binaryBuffer, static_cast<std::uint8_t>(f.level));
+    BinaryLog::put<std::uint16_t>(binaryBuffer, static_cast<std::uint16_t>(f.text.size()));
+    binaryBuffer += f.text;
+}
+
+void flushBinaryLocked() {
+    if (binaryFd >= 0 && !binaryBuffer.empty()) writeAll(binaryFd, binaryBuffer);
+    binaryBuffer.clear();
+}
+
+// Stops the writer before statics are torn down if shutdown() was never called
+struct AsyncShutdownGuard {
+    ~AsyncShutdownGuard() { Logger::shutdown(); }
+} asyncShutdownGuard;
+
+} // namespace
 
 void Logger::initialize(const std::string& file) {
+    logPath = file;
     logFile.open(file, std::ios::app);
 }
 
-void Logger::log(LogLevel level, const std::string& msg) {
-    if (level < currentLevel) return;
+LogLevel Logger::minLevel = LogLevel::INFO;
 
-    const char* tag =
-        level == LogLevel::INFO ? "[INFO]" :
-        level == LogLevel::WARNING ? "[WARN]" :
-        level == LogLevel::ERROR ? "[ERROR]" : "[DEBUG]";
+void Logger::setLevel(LogLevel level) {
+    minLevel = level;
+}
+
+LogLevel Logger::getLevel() {
+    return minLevel;
+}
+
+void Logger::log(LogLevel level, const std::string& msg) {
+    if (!isEnabled(level)) return;
 
     std::time_t now = std::time(nullptr);
-    std::cout << tag << " " << std::ctime(&now) << " " << msg << "\n";
+    if (asyncEnabled.load(std::memory_order_acquire) && enqueue(level, now, msg)) return;
+
+    std::string line;
+    formatLine(line, level, now, msg);
+    std::lock_guard<std::mutex> lock(syncMutex);
+    std::cout << line;
 
     if (logFile.is_open()) {
-        logFile << tag << " " << std::ctime(&now) << " " << msg << "\n";
+        logFile << line;
+    }
+}
+
+void Logger::enableAsync(std::size_t capacity, LogOverflowPolicy policy) {
+    if (asyncEnabled.load()) return;
+
+    std::size_t rounded = 2;
+    while (rounded < capacity) rounded <<= 1;
+    ringCapacity = rounded;
+    overflowPolicy = policy;
+
+    if (logFile.is_open()) logFile.flush();
+    std::cout.flush();
+    fileFd = ::open(logPath.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopRequested = false;
+    }
+    asyncGeneration.fetch_add(1, std::memory_order_release);
+    writerThread = std::thread(writerLoop);
+    asyncEnabled.store(true, std::memory_order_release);
+    log(LogLevel::INFO, "Logger: async mode enabled (ring=" + std::to_string(ringCapacity) +
+                        (policy == LogOverflowPolicy::DROP ? ", policy=DROP)" : ", policy=BLOCK)"));
+}
+
+void Logger::flush() {
+    if (binaryEnabled.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(binaryMutex);
+        flushBinaryLocked();
+    }
+    if (!asyncEnabled.load(std::memory_order_acquire)) {
+        std::cout.flush();
+        if (logFile.is_open()) logFile.flush();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    const std::uint64_t target = ++flushRequested;
+    wakeCv.notify_one();
+    flushedCv.wait(lock, [target] { return flushCompleted >= target || stopRequested; });
+}
+
+void Logger::shutdown() {
+    disableBinary();
+    if (!asyncEnabled.exchange(false)) return;
+
+    // New messages now go out synchronously. Pushes already under way finish
+    // while the writer still drains (a BLOCK producer may need it to), so
+    // its final pass picks up everything queued
+    std::vector<std::shared_ptr<LogRing>> live;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        live = rings;
+    }
+    for (const auto& ring : live) {
+        while (ring->pushing.load()) std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopRequested = true;
     }
+    wakeCv.notify_all();
+    if (writerThread.joinable()) writerThread.join();
+
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        rings.clear();
+    }
+    if (fileFd >= 0) {
+        ::close(fileFd);
+        fileFd = -1;
+    }
+
+    const std::size_t dropped = droppedCount.load();
+    if (dropped > 0) {
+        log(LogLevel::WARNING, "Logger: " + std::to_string(dropped) + " messages dropped while async");
+    }
+}
+
+bool Logger::isAsync() {
+    return asyncEnabled.load(std::memory_order_acquire);
+}
+
+std::size_t Logger::getDroppedCount() {
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+void Logger::enableBinary(const std::string& file) {
+    std::lock_guard<std::mutex> lock(binaryMutex);
+    if (binaryEnabled.load()) return;
+
+    binaryFd = ::open(file.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (binaryFd < 0) return;
+
+    // Every segment starts with the header and the full format table so a
+    // file appended across restarts stays decodable
+    binaryBuffer.assign(BinaryLog::MAGIC, sizeof(BinaryLog::MAGIC));
+    lastBinaryNanos = 0;
+    for (std::size_t id = 1; id < formatCount; ++id) {
+        appendFormatDef(static_cast<std::uint16_t>(id));
+    }
+    binaryEnabled.store(true, std::memory_order_release);
+}
+
+void Logger::disableBinary() {
+    std::lock_guard<std::mutex> lock(binaryMutex);
+    if (!binaryEnabled.exchange(false)) return;
+    flushBinaryLocked();
+    ::close(binaryFd);
+    binaryFd = -1;
+}
+
+bool Logger::isBinary() {
+    return binaryEnabled.load(std::memory_order_acquire);
+}
+
+std::uint16_t Logger::registerFormat(LogLevel level, const char* format) {
+    std::lock_guard<std::mutex> lock(binaryMutex);
+    if (formatCount > UINT16_MAX) return 0;
+    const auto id = static_cast<std::uint16_t>(formatCount++);
+    std::atomic<FormatChunk*>& chunk = formatChunks[id / FORMAT_CHUNK];
+    if (!chunk.load(std::memory_order_relaxed)) chunk.store(new FormatChunk, std::memory_order_release);
+    chunk.load(std::memory_order_relaxed)->entries[id % FORMAT_CHUNK].store(new FormatEntry{level, format},
+                                                                           std::memory_order_release);
+    if (binaryEnabled.load(std::memory_order_relaxed)) appendFormatDef(id);
+    return id;
+}
+
+void Logger::writeBinary(std::uint16_t formatId, std::uint8_t argc, const std::string& payload) {
+    if (binaryEnabled.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(binaryMutex);
+        if (!binaryEnabled.load(std::memory_order_relaxed)) return;
+
+        // Sampled under the lock so deltas are never negative
+        const auto nanos = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        const std::uint64_t delta = nanos > lastBinaryNanos ? nanos - lastBinaryNanos : 0;
+        lastBinaryNanos += delta;
+
+        binaryBuffer += static_cast<char>(BinaryLog::RECORD);
+        BinaryLog::put<std::uint16_t>(binaryBuffer, formatId);
+        BinaryLog::putVarint(binaryBuffer, delta);
+        BinaryLog::put<std::uint8_t>(binaryBuffer, argc);
+        binaryBuffer += payload;
+        if (binaryBuffer.size() >= BINARY_FLUSH_BYTES) flushBinaryLocked();
+        return;
+    }
+
+    // Text fallback renders exactly what logdecode would produce
+    static const FormatEntry unregistered{LogLevel::INFO, "<unregistered>"};
+    const FormatEntry* entry = findFormat(formatId);
+    if (!entry) entry = &unregistered;
+    thread_local std::string message;
+    message.clear();
+    BinaryLog::render(entry->text, payload.data(), payload.size(), argc, message);
+    log(entry->level, message);
 }
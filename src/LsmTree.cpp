@@ -0,0 +1,825 @@
+#include "LsmTree.h"
+#include "BinaryLog.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char RUN_MAGIC[8] = {'R', 'M', 'S', 'S', 'S', 'T', '0', '1'};
+constexpr const char* MANIFEST_MAGIC = "RMSLSM01";
+constexpr std::uint8_t FLAG_DELETED = 1;
+constexpr std::uint8_t LOG_PUT = 1;
+constexpr std::uint8_t LOG_DELETE = 2;
+constexpr std::size_t MAX_IMMUTABLES = 2;
+constexpr std::size_t SLOT_OVERHEAD = 48;   // Map node and bookkeeping, for memtable sizing
+constexpr std::size_t BLOOM_BLOCK_BITS = 512;
+constexpr std::size_t BLOOM_BLOCK_WORDS = BLOOM_BLOCK_BITS / 64;
+constexpr std::size_t SCAN_RELEASE_BYTES = 8 * 1024 * 1024;   // Cursors drop run pages behind them this often
+
+struct IndexEntry {
+    std::int32_t firstKey;
+    std::uint32_t size;
+    std::uint64_t offset;
+};
+
+struct Footer {
+    std::uint64_t indexOffset;
+    std::uint64_t blockCount;
+    std::uint64_t bloomOffset;
+    std::uint64_t bloomBlocks;
+    std::uint32_t probes;
+    std::uint32_t checksum;
+    char magic[8];
+};
+static_assert(sizeof(Footer) == 48, "run footer layout");
+
+thread_local std::string scratchBody;    // Log record under construction
+thread_local std::string scratchFrame;
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+std::uint64_t mixKey(int key) {
+    std::uint64_t h = static_cast<std::uint32_t>(key) + 0x9e3779b97f4a7c15ull;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+// Blocked Bloom filter: one 512-bit block per key, `probes` 9-bit positions in it
+std::uint64_t bloomBlockOf(std::uint64_t hash, std::uint64_t blocks) {
+    return ((hash >> 32) * blocks) >> 32;
+}
+
+void bloomAdd(std::uint64_t* words, std::uint64_t blocks, unsigned probes, int key) {
+    const std::uint64_t hash = mixKey(key);
+    std::uint64_t* block = words + bloomBlockOf(hash, blocks) * BLOOM_BLOCK_WORDS;
+    const std::uint64_t bits = hash * 0x9e3779b97f4a7c15ull;
+    for (unsigned i = 0; i < probes; ++i) {
+        const auto pos = static_cast<unsigned>((bits >> (9 * i)) & (BLOOM_BLOCK_BITS - 1));
+        block[pos / 64] |= 1ull << (pos % 64);
+    }
+}
+
+bool bloomMayContain(const std::uint64_t* words, std::uint64_t blocks, unsigned probes, int key) {
+    const std::uint64_t hash = mixKey(key);
+    const std::uint64_t* block = words + bloomBlockOf(hash, blocks) * BLOOM_BLOCK_WORDS;
+    const std::uint64_t bits = hash * 0x9e3779b97f4a7c15ull;
+    for (unsigned i = 0; i < probes; ++i) {
+        const auto pos = static_cast<unsigned>((bits >> (9 * i)) & (BLOOM_BLOCK_BITS - 1));
+        if (!(block[pos / 64] & (1ull << (pos % 64)))) return false;
+    }
+    return true;
+}
+
+/**
+ * Streams sorted entries into a run file: blocks, then index, Bloom
+ * filter and footer; fdatasync and rename into place on finish()
+ */
+class RunWriter {
+public:
+    RunWriter(std::string finalPath, const LsmOptions& options)
+        : path(std::move(finalPath)), tmpPath(path + ".tmp"), options(options) {}
+
+    ~RunWriter() {
+        if (fd >= 0) {
+            ::close(fd);
+            ::unlink(tmpPath.c_str());
+        }
+    }
+
+    bool begin() {
+        fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) Logger::log(LogLevel::ERROR, "LsmTree: Cannot create " + tmpPath + ": " + std::strerror(errno));
+        return fd >= 0;
+    }
+
+    bool add(int key, bool deleted, std::string_view value) {
+        const std::size_t entryBytes = sizeof(std::int32_t) + 1 + 10 + value.size();
+        if (!block.empty() && block.size() + entryBytes > options.blockBytes && !finishBlock()) return false;
+        if (block.empty()) blockFirstKey = key;
+        BinaryLog::put<std::int32_t>(block, key);
+        block += static_cast<char>(deleted ? FLAG_DELETED : 0);
+        BinaryLog::putVarint(block, value.size());
+        block.append(value.data(), value.size());
+        keys.push_back(key);
+        return true;
+    }
+
+    std::size_t entries() const { return keys.size(); }
+
+    bool finish() {
+        if (!finishBlock()) return false;
+        Footer footer{};
+        footer.indexOffset = align();
+        footer.blockCount = index.size();
+        std::string tail(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(IndexEntry));
+
+        // Bloom filter sized like CountingBloomFilter, with the same 25% headroom
+        const double ln2 = std::log(2.0);
+        const double bits = -static_cast<double>(std::max<std::size_t>(keys.size(), 1)) *
+                            std::log(options.bloomFalsePositiveRate) / (ln2 * ln2);
+        footer.bloomBlocks = std::max<std::uint64_t>(
+            1, static_cast<std::uint64_t>(std::ceil(1.25 * bits / BLOOM_BLOCK_BITS)));
+        footer.probes = static_cast<std::uint32_t>(
+            std::clamp(std::round(-std::log2(options.bloomFalsePositiveRate)), 1.0, 7.0));   // 9 bits per probe
+        std::vector<std::uint64_t> bloom(footer.bloomBlocks * BLOOM_BLOCK_WORDS, 0);
+        for (int key : keys) bloomAdd(bloom.data(), footer.bloomBlocks, footer.probes, key);
+        footer.bloomOffset = footer.indexOffset + tail.size();
+        tail.append(reinterpret_cast<const char*>(bloom.data()), bloom.size() * sizeof(std::uint64_t));
+
+        footer.checksum = BinaryLog::checksum(tail.data(), tail.size());
+        std::memcpy(footer.magic, RUN_MAGIC, sizeof(RUN_MAGIC));
+        tail.append(reinterpret_cast<const char*>(&footer), sizeof(footer));
+        if (!writeAll(fd, tail.data(), tail.size()) || ::fdatasync(fd) != 0) {
+            Logger::log(LogLevel::ERROR, "LsmTree: Cannot write " + tmpPath + ": " + std::strerror(errno));
+            return false;
+        }
+        ::close(fd);
+        fd = -1;
+        std::error_code ec;
+        fs::rename(tmpPath, path, ec);
+        if (ec) {
+            Logger::log(LogLevel::ERROR, "LsmTree: Cannot rename " + tmpPath + ": " + ec.message());
+            fs::remove(tmpPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool finishBlock() {
+        if (block.empty()) return true;
+        index.push_back({blockFirstKey, static_cast<std::uint32_t>(block.size()), offset});
+        if (!writeAll(fd, block.data(), block.size())) {
+            Logger::log(LogLevel::ERROR, "LsmTree: Cannot write " + tmpPath + ": " + std::strerror(errno));
+            return false;
+        }
+        offset += block.size();
+        block.clear();
+        return true;
+    }
+
+    // Pad to 8 bytes so the mapped index and filter are aligned
+    std::uint64_t align() {
+        static const char zeros[8] = {};
+        const std::size_t pad = (8 - offset % 8) % 8;
+        if (pad) writeAll(fd, zeros, pad);
+        offset += pad;
+        return offset;
+    }
+
+    const std::string path;
+    const std::string tmpPath;
+    const LsmOptions& options;
+    int fd = -1;
+    std::string block;
+    std::int32_t blockFirstKey = 0;
+    std::uint64_t offset = 0;
+    std::vector<IndexEntry> index;
+    std::vector<int> keys;
+};
+
+/**
+ * Newest-wins merge of sorted cursors (index 0 is the newest source)
+ * Calls out(key, deleted, value) once per key in ascending order until
+ * it returns false
+ */
+template <typename Cursor, typename Out>
+void mergeCursors(std::vector<Cursor>& cursors, Out&& out) {
+    for (;;) {
+        const Cursor* newest = nullptr;
+        for (const Cursor& c : cursors) {
+            if (c.valid && (!newest || c.key < newest->key)) newest = &c;
+        }
+        if (!newest) return;
+        const int key = newest->key;
+        if (!out(key, newest->deleted, newest->value)) return;
+        for (Cursor& c : cursors) {
+            if (c.valid && c.key == key) c.next();
+        }
+    }
+}
+
+} // namespace
+
+// ============ Run ============
+
+class LsmTree::Run {
+public:
+    ~Run() {
+        if (obsolete.load(std::memory_order_acquire)) ::unlink(file.path().c_str());
+    }
+
+    bool open(const std::string& path, std::uint64_t runNumber) {
+        number = runNumber;
+        if (!file.openReadOnly(path) || file.size() < sizeof(Footer)) {
+            Logger::log(LogLevel::ERROR, "LsmTree: Cannot open run " + path);
+            return false;
+        }
+        Footer footer;
+        std::memcpy(&footer, file.data() + file.size() - sizeof(Footer), sizeof(Footer));
+        const std::uint64_t tailEnd = file.size() - sizeof(Footer);
+        if (std::memcmp(footer.magic, RUN_MAGIC, sizeof(RUN_MAGIC)) != 0 || footer.indexOffset > tailEnd ||
+            footer.indexOffset % 8 != 0 ||
+            footer.bloomOffset != footer.indexOffset + footer.blockCount * sizeof(IndexEntry) ||
+            footer.bloomOffset + footer.bloomBlocks * BLOOM_BLOCK_WORDS * sizeof(std::uint64_t) != tailEnd ||
+            footer.bloomBlocks == 0 ||
+            BinaryLog::checksum(file.data() + footer.indexOffset, tailEnd - footer.indexOffset) != footer.checksum) {
+            Logger::log(LogLevel::ERROR, "LsmTree: Corrupt run " + path);
+            return false;
+        }
+        index = reinterpret_cast<const IndexEntry*>(file.data() + footer.indexOffset);
+        blockCount = footer.blockCount;
+        bloom = reinterpret_cast<const std::uint64_t*>(file.data() + footer.bloomOffset);
+        bloomBlocks = footer.bloomBlocks;
+        probes = footer.probes;
+        return true;
+    }
+
+    bool mayContain(int key) const { return bloomMayContain(bloom, bloomBlocks, probes, key); }
+
+    // Decode the entry at `pos`, returning the position after it (0 if malformed)
+    std::size_t decode(std::size_t pos, std::size_t end, int& key, bool& deleted, std::string_view& value) const {
+        const char* data = file.data();
+        if (pos + sizeof(std::int32_t) + 1 > end) return 0;
+        std::int32_t k;
+        std::memcpy(&k, data + pos, sizeof(k));
+        deleted = data[pos + sizeof(k)] & FLAG_DELETED;
+        pos += sizeof(k) + 1;
+        std::uint64_t len;
+        if (!BinaryLog::getVarint(data, end, pos, len) || len > end - pos) return 0;
+        key = k;
+        value = std::string_view(data + pos, static_cast<std::size_t>(len));
+        return pos + static_cast<std::size_t>(len);
+    }
+
+    // true if the run holds `key` (possibly as a deletion)
+    bool find(int key, bool& deleted, std::string_view& value) const {
+        const IndexEntry* end = index + blockCount;
+        const IndexEntry* block = std::upper_bound(index, end, key,
+                                                   [](int k, const IndexEntry& e) { return k < e.firstKey; });
+        if (block == index) return false;
+        --block;
+        std::size_t pos = static_cast<std::size_t>(block->offset);
+        const std::size_t blockEnd = pos + block->size;
+        int k;
+        while (pos < blockEnd && (pos = decode(pos, blockEnd, k, deleted, value)) != 0) {
+            if (k == key) return true;
+            if (k > key) return false;
+        }
+        return false;
+    }
+
+    MappedFile file;
+    std::uint64_t number = 0;
+    const IndexEntry* index = nullptr;
+    std::uint64_t blockCount = 0;
+    const std::uint64_t* bloom = nullptr;
+    std::uint64_t bloomBlocks = 0;
+    unsigned probes = 0;
+    mutable std::atomic<bool> obsolete{false};   // Merged away: unlink once the last reader lets go
+};
+
+// ============ Cursors ============
+
+namespace {
+
+// Ascending walk over a run's entries
+struct RunCursor {
+    std::shared_ptr<const LsmTree::Run> run;
+    std::uint64_t block = 0;
+    std::size_t pos = 0;
+    std::size_t blockEnd = 0;
+    std::size_t released = 0;   // Pages before this offset were dropped from memory
+    bool valid = false;
+    int key = 0;
+    bool deleted = false;
+    std::string_view value;
+
+    explicit RunCursor(std::shared_ptr<const LsmTree::Run> r) : run(std::move(r)) {
+        if (run->blockCount > 0) {
+            enterBlock();
+            next();
+        }
+    }
+
+    void enterBlock() {
+        pos = static_cast<std::size_t>(run->index[block].offset);
+        blockEnd = pos + run->index[block].size;
+        if (pos - released >= SCAN_RELEASE_BYTES) {
+            run->file.release(released, pos - released);
+            released = pos;
+        }
+    }
+
+    void next() {
+        while (pos >= blockEnd) {
+            if (++block >= run->blockCount) {
+                valid = false;
+                return;
+            }
+            enterBlock();
+        }
+        pos = run->decode(pos, blockEnd, key, deleted, value);
+        valid = pos != 0;
+    }
+};
+
+// Ascending walk over a memtable's map
+template <typename Map>
+struct MapCursor {
+    typename Map::const_iterator it, end;
+    bool valid = false;
+    int key = 0;
+    bool deleted = false;
+    std::string_view value;
+
+    MapCursor(const Map& map) : it(map.begin()), end(map.end()) { load(); }
+
+    void load() {
+        valid = it != end;
+        if (valid) {
+            key = it->first;
+            deleted = it->second.deleted;
+            value = it->second.value;
+        }
+    }
+
+    void next() {
+        ++it;
+        load();
+    }
+};
+
+// Either kind of cursor behind one interface, for mixed merges
+struct AnyCursor {
+    std::function<void(AnyCursor&)> advance;
+    bool valid = false;
+    int key = 0;
+    bool deleted = false;
+    std::string_view value;
+
+    void next() { advance(*this); }
+};
+
+template <typename Source>
+AnyCursor wrap(std::shared_ptr<Source> source) {
+    AnyCursor cursor;
+    auto sync = [](AnyCursor& c, const Source& s) {
+        c.valid = s.valid;
+        c.key = s.key;
+        c.deleted = s.deleted;
+        c.value = s.value;
+    };
+    sync(cursor, *source);
+    cursor.advance = [source, sync](AnyCursor& c) {
+        source->next();
+        sync(c, *source);
+    };
+    return cursor;
+}
+
+} // namespace
+
+// ============ LsmTree ============
+
+LsmTree::~LsmTree() {
+    close();
+}
+
+std::string LsmTree::fileName(const char* prefix, std::uint64_t number, const char* suffix) const {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%s-%06llu%s", prefix, static_cast<unsigned long long>(number), suffix);
+    return directory + "/" + name;
+}
+
+bool LsmTree::openLog(std::uint64_t number) {
+    const std::string path = fileName("log", number, ".wal");
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        Logger::log(LogLevel::ERROR, "LsmTree: Cannot open log " + path + ": " + std::strerror(errno));
+        return false;
+    }
+    if (logFd >= 0) ::close(logFd);
+    logFd = fd;
+    return true;
+}
+
+bool LsmTree::replayLog(const std::string& path, Memtable& into) {
+    MappedFile log;
+    if (!log.openReadOnly(path)) return true;   // Empty log
+    std::size_t records = 0;
+    BinaryLog::scanFrames(log.data(), 0, log.size(), [&](const char* body, std::size_t len) {
+        std::int32_t key;
+        if (len < 1 + sizeof(key)) return false;
+        std::memcpy(&key, body + 1, sizeof(key));
+        Slot& slot = into.entries[key];
+        slot.deleted = body[0] == LOG_DELETE;
+        slot.value.assign(body + 1 + sizeof(key), len - 1 - sizeof(key));
+        into.bytes += slot.value.size() + SLOT_OVERHEAD;
+        records++;
+        return true;
+    });
+    LOGF_INFO("LsmTree: Replayed ", records, " records from ", path);
+    return true;
+}
+
+bool LsmTree::writeRun(const Memtable& memtable, std::shared_ptr<const Run>& out) {
+    std::uint64_t number;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        number = nextFileNumber++;
+    }
+    const std::string path = fileName("run", number, ".sst");
+    RunWriter writer(path, options);
+    if (!writer.begin()) return false;
+    for (const auto& [key, slot] : memtable.entries) {
+        if (!writer.add(key, slot.deleted, slot.value)) return false;
+    }
+    auto run = std::make_shared<Run>();
+    if (!writer.finish() || !run->open(path, number)) return false;
+    out = std::move(run);
+    return true;
+}
+
+bool LsmTree::mergeRuns(const RunList& inputs, std::shared_ptr<const Run>& out) {
+    std::uint64_t number;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        number = nextFileNumber++;
+    }
+    const std::string path = fileName("run", number, ".sst");
+    RunWriter writer(path, options);
+    if (!writer.begin()) return false;
+
+    // The inputs always include the oldest run, so deletions have nothing left to hide
+    std::vector<RunCursor> cursors;
+    for (const auto& run : inputs) cursors.emplace_back(run);
+    bool ok = true;
+    mergeCursors(cursors, [&](int key, bool deleted, std::string_view value) {
+        if (!deleted) ok = writer.add(key, false, value);
+        return ok;
+    });
+    if (!ok) return false;
+    if (writer.entries() == 0) {
+        out.reset();   // Everything was deleted
+        return true;
+    }
+    auto run = std::make_shared<Run>();
+    if (!writer.finish() || !run->open(path, number)) return false;
+    out = std::move(run);
+    return true;
+}
+
+bool LsmTree::writeManifestLocked() {
+    std::string text = std::string(MANIFEST_MAGIC) + "\n";
+    text += "next " + std::to_string(nextFileNumber) + "\n";
+    const std::uint64_t oldestLog = immutables.empty() ? active->logNumber : immutables.back()->logNumber;
+    text += "log " + std::to_string(oldestLog) + "\n";
+    for (const auto& run : *runs) text += "run " + std::to_string(run->number) + "\n";
+
+    const std::string path = directory + "/MANIFEST";
+    const std::string tmpPath = path + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    const bool written = fd >= 0 && writeAll(fd, text.data(), text.size()) && ::fdatasync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+    std::error_code ec;
+    if (written) fs::rename(tmpPath, path, ec);
+    if (!written || ec) {
+        Logger::log(LogLevel::ERROR, "LsmTree: Cannot write " + path);
+        return false;
+    }
+    return true;
+}
+
+bool LsmTree::open(const std::string& dir, const LsmOptions& opts) {
+    close();
+    directory = dir;
+    options = opts;
+    stopping = false;
+    backgroundFailed = false;
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    // MANIFEST: live runs (newest first) and the oldest log still needed
+    std::uint64_t oldestLog = 0;
+    auto live = std::make_shared<RunList>();
+    std::ifstream manifest(directory + "/MANIFEST");
+    std::string word;
+    if (manifest >> word && word == MANIFEST_MAGIC) {
+        std::uint64_t number;
+        while (manifest >> word >> number) {
+            if (word == "next") {
+                nextFileNumber = std::max(nextFileNumber, number);
+            } else if (word == "log") {
+                oldestLog = number;
+            } else if (word == "run") {
+                auto run = std::make_shared<Run>();
+                if (!run->open(fileName("run", number, ".sst"), number)) return false;
+                live->push_back(std::move(run));
+            }
+        }
+    }
+
+    // Sweep leftovers of interrupted flushes and merges; collect the logs to replay
+    std::vector<std::pair<std::uint64_t, std::string>> logs;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        const std::string name = entry.path().filename().string();
+        unsigned long long number = 0;
+        char suffix[8] = {};
+        if (std::sscanf(name.c_str(), "log-%llu%7s", &number, suffix) == 2 && std::strcmp(suffix, ".wal") == 0) {
+            if (number >= oldestLog) logs.push_back({number, entry.path().string()});
+            else fs::remove(entry.path(), ec);
+        } else if (std::sscanf(name.c_str(), "run-%llu%7s", &number, suffix) == 2) {
+            const bool isLive = std::any_of(live->begin(), live->end(),
+                                            [&](const auto& run) { return run->number == number; });
+            if (!isLive) fs::remove(entry.path(), ec);
+        }
+        nextFileNumber = std::max<std::uint64_t>(nextFileNumber, number + 1);
+    }
+    std::sort(logs.begin(), logs.end());
+
+    Memtable recovered;
+    for (const auto& log : logs) replayLog(log.second, recovered);
+    runs = live;
+    if (!recovered.entries.empty()) {
+        std::shared_ptr<const Run> run;
+        if (!writeRun(recovered, run)) return false;
+        auto withRecovered = std::make_shared<RunList>();
+        withRecovered->push_back(run);
+        withRecovered->insert(withRecovered->end(), live->begin(), live->end());
+        runs = withRecovered;
+    }
+
+    active = std::make_shared<Memtable>();
+    active->logNumber = nextFileNumber++;
+    if (!openLog(active->logNumber)) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!writeManifestLocked()) {
+            ::close(logFd);
+            logFd = -1;
+            return false;
+        }
+    }
+    for (const auto& log : logs) fs::remove(log.second, ec);
+
+    background = std::thread(&LsmTree::backgroundLoop, this);
+    LOGF_INFO("LsmTree: Opened ", directory, " with ", runs->size(), " runs");
+    return true;
+}
+
+void LsmTree::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workCv.notify_all();
+    if (background.joinable()) background.join();   // Writes out pending immutables first
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (logFd >= 0) {
+        ::close(logFd);
+        logFd = -1;
+    }
+    active.reset();
+    immutables.clear();
+    runs.reset();
+}
+
+bool LsmTree::rotateLocked() {
+    const std::uint64_t number = nextFileNumber++;
+    if (!openLog(number)) return false;
+    immutables.push_front(active);
+    active = std::make_shared<Memtable>();
+    active->logNumber = number;
+    workCv.notify_one();
+    return true;
+}
+
+bool LsmTree::write(int key, std::string_view value, bool deleted) {
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this] { return immutables.size() < MAX_IMMUTABLES || backgroundFailed || logFd < 0; });
+    if (logFd < 0 || backgroundFailed) return false;
+
+    std::string& body = scratchBody;
+    std::string& frame = scratchFrame;
+    body.clear();
+    body += static_cast<char>(deleted ? LOG_DELETE : LOG_PUT);
+    BinaryLog::put<std::int32_t>(body, key);
+    body.append(value.data(), value.size());
+    frame.clear();
+    BinaryLog::appendFrame(frame, body);
+    if (!writeAll(logFd, frame.data(), frame.size()) || (options.syncWrites && ::fdatasync(logFd) != 0)) {
+        Logger::log(LogLevel::ERROR, "LsmTree: Log write failed in " + directory + ": " + std::strerror(errno));
+        return false;
+    }
+
+    auto [it, inserted] = active->entries.try_emplace(key);
+    if (inserted) {
+        active->bytes += SLOT_OVERHEAD;
+    } else {
+        active->bytes -= it->second.value.size();
+    }
+    it->second.value.assign(value.data(), value.size());
+    it->second.deleted = deleted;
+    active->bytes += value.size();
+    if (active->bytes >= options.memtableBytes) rotateLocked();
+    return true;
+}
+
+bool LsmTree::put(int key, std::string_view value) {
+    return write(key, value, false);
+}
+
+bool LsmTree::remove(int key) {
+    return write(key, std::string_view(), true);
+}
+
+bool LsmTree::get(int key, std::string& value) const {
+    std::deque<std::shared_ptr<const Memtable>> frozen;
+    std::shared_ptr<const RunList> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!active) return false;
+        const auto it = active->entries.find(key);
+        if (it != active->entries.end()) {
+            if (it->second.deleted) return false;
+            value = it->second.value;
+            return true;
+        }
+        frozen = immutables;
+        snapshot = runs;
+    }
+
+    for (const auto& memtable : frozen) {
+        const auto it = memtable->entries.find(key);
+        if (it != memtable->entries.end()) {
+            if (it->second.deleted) return false;
+            value = it->second.value;
+            return true;
+        }
+    }
+    for (const auto& run : *snapshot) {
+        if (!run->mayContain(key)) {
+            bloomSkipCount.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        blockReadCount.fetch_add(1, std::memory_order_relaxed);
+        bool deleted;
+        std::string_view stored;
+        if (run->find(key, deleted, stored)) {
+            if (deleted) return false;
+            value.assign(stored.data(), stored.size());
+            return true;
+        }
+    }
+    return false;
+}
+
+void LsmTree::forEach(const std::function<bool(int key, std::string_view value)>& fn) const {
+    std::shared_ptr<const Memtable> current;
+    std::deque<std::shared_ptr<const Memtable>> frozen;
+    std::shared_ptr<const RunList> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!active) return;
+        current = std::make_shared<const Memtable>(*active);   // The active memtable keeps changing
+        frozen = immutables;
+        snapshot = runs;
+    }
+
+    using Map = std::map<int, Slot>;
+    std::vector<AnyCursor> cursors;
+    cursors.push_back(wrap(std::make_shared<MapCursor<Map>>(current->entries)));
+    for (const auto& memtable : frozen) cursors.push_back(wrap(std::make_shared<MapCursor<Map>>(memtable->entries)));
+    for (const auto& run : *snapshot) cursors.push_back(wrap(std::make_shared<RunCursor>(run)));
+    mergeCursors(cursors, [&](int key, bool deleted, std::string_view value) {
+        return deleted || fn(key, value);
+    });
+}
+
+bool LsmTree::flushOldestImmutable() {
+    std::shared_ptr<const Memtable> memtable;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memtable = immutables.back();
+    }
+    std::shared_ptr<const Run> run;
+    if (!writeRun(*memtable, run)) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto updated = std::make_shared<RunList>();
+        updated->push_back(run);
+        updated->insert(updated->end(), runs->begin(), runs->end());
+        runs = updated;
+        immutables.pop_back();
+        flushCount++;
+        if (!writeManifestLocked()) return false;   // Keep the log: the run is not recorded yet
+    }
+    std::error_code ec;
+    fs::remove(fileName("log", memtable->logNumber, ".wal"), ec);
+    doneCv.notify_all();
+    return true;
+}
+
+bool LsmTree::compactOnce() {
+    std::lock_guard<std::mutex> merging(compactionMutex);
+    std::shared_ptr<const RunList> inputs;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inputs = runs;
+    }
+    if (!inputs || inputs->size() < 2) return true;
+
+    std::shared_ptr<const Run> merged;
+    if (!mergeRuns(*inputs, merged)) return false;
+
+    {
+        // Flushes only prepend, so the inputs are still the oldest runs
+        std::lock_guard<std::mutex> lock(mutex);
+        auto updated = std::make_shared<RunList>(runs->begin(), runs->end() - inputs->size());
+        if (merged) updated->push_back(merged);
+        runs = updated;
+        compactionCount++;
+        if (!writeManifestLocked()) return false;
+    }
+    for (const auto& run : *inputs) run->obsolete.store(true, std::memory_order_release);
+    LOGF_INFO("LsmTree: Merged ", inputs->size(), " runs in ", directory);
+    return true;
+}
+
+void LsmTree::backgroundLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        workCv.wait(lock, [this] {
+            return stopping ||
+                   (!backgroundFailed && (!immutables.empty() || runs->size() >= options.compactionTrigger));
+        });
+        if (!immutables.empty() && !backgroundFailed) {
+            lock.unlock();
+            const bool ok = flushOldestImmutable();
+            lock.lock();
+            if (!ok) {
+                backgroundFailed = true;   // Memtables stay in their logs; writers get errors
+                doneCv.notify_all();
+                Logger::log(LogLevel::ERROR, "LsmTree: Memtable flush failed in " + directory);
+            }
+            continue;
+        }
+        if (stopping) return;
+        if (!backgroundFailed && runs->size() >= options.compactionTrigger) {
+            lock.unlock();
+            const bool ok = compactOnce();
+            lock.lock();
+            if (!ok) backgroundFailed = true;
+            doneCv.notify_all();
+        }
+    }
+}
+
+bool LsmTree::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (logFd < 0) return false;
+    if (!active->entries.empty() && !rotateLocked()) return false;
+    doneCv.wait(lock, [this] { return immutables.empty() || backgroundFailed; });
+    return !backgroundFailed;
+}
+
+bool LsmTree::compact() {
+    return flush() && compactOnce();
+}
+
+LsmStats LsmTree::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    LsmStats stats;
+    stats.memtableEntries = active ? active->entries.size() : 0;
+    stats.immutableMemtables = immutables.size();
+    stats.runs = runs ? runs->size() : 0;
+    stats.flushes = flushCount;
+    stats.compactions = compactionCount;
+    stats.bloomSkips = bloomSkipCount.load(std::memory_order_relaxed);
+    stats.blockReads = blockReadCount.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,118 @@
+#include "MappedFile.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : fd(std::exchange(other.fd, -1)),
+      base(std::exchange(other.base, nullptr)),
+      length(std::exchange(other.length, 0)),
+      filePath(std::move(other.filePath)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+        filePath = std::move(other.filePath);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path, std::size_t size) {
+    close();
+    filePath = path;
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    return map(PROT_READ | PROT_WRITE, size, true);
+}
+
+bool MappedFile::openReadOnly(const std::string& path) {
+    close();
+    filePath = path;
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    return map(PROT_READ, 0, false);
+}
+
+bool MappedFile::map(int prot, std::size_t size, bool writable) {
+    if (fd < 0) {
+        Logger::log(LogLevel::ERROR, "MappedFile: Cannot open " + filePath + ": " + std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        Logger::log(LogLevel::ERROR, "MappedFile: Cannot stat " + filePath + ": " + std::strerror(errno));
+        close();
+        return false;
+    }
+    length = static_cast<std::size_t>(st.st_size);
+    if (writable && length < size) {
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            Logger::log(LogLevel::ERROR, "MappedFile: Cannot size " + filePath + ": " + std::strerror(errno));
+            close();
+            return false;
+        }
+        length = size;
+    }
+    if (length == 0) {
+        close();   // mmap rejects empty ranges; treat as nothing to read
+        return false;
+    }
+
+    void* addr = ::mmap(nullptr, length, prot, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        Logger::log(LogLevel::ERROR, "MappedFile: Cannot map " + filePath + ": " + std::strerror(errno));
+        close();
+        return false;
+    }
+    base = static_cast<char*>(addr);
+    return true;
+}
+
+bool MappedFile::sync(std::size_t offset, std::size_t len) {
+    if (!base || len == 0) return true;
+    // msync wants a page-aligned start
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t start = offset & ~(page - 1);
+    const std::size_t end = std::min(offset + len, length);
+    if (::msync(base + start, end - start, MS_SYNC) != 0) {
+        Logger::log(LogLevel::ERROR, "MappedFile: msync failed for " + filePath + ": " + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::adviseSequential() const {
+    if (base) ::madvise(base, length, MADV_SEQUENTIAL);
+}
+
+void MappedFile::release(std::size_t offset, std::size_t len) const {
+    if (!base) return;
+    const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t start = offset & ~(page - 1);
+    const std::size_t end = std::min(offset + len, length) & ~(page - 1);   // Keep a partial last page
+    if (end > start) ::madvise(base + start, end - start, MADV_DONTNEED);
+}
+
+void MappedFile::close() {
+    if (base) {
+        ::munmap(base, length);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    length = 0;
+}
@@ -1,91 +1,258 @@
 #include "OrderCommandService.h"
-#include "ServiceLocator.h"
-#include "EventSystem.h"
-#include "BusinessRules.h"
+#include "IdempotencyService.h"
 #include "Logger.h"
+#include "StorageStrategy.h"
+#include "TransactionManager.h"
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr const char* ORDER_RESOURCE = "order";
+
+// Cached result for an idempotent createOrder, and the write-ahead log's
+// redo/undo image of an order:
+// "OrderID=<id>|CustomerID=<id>|Total=<total>|Timestamp=<t>|Priority=<p>|State=<s>"
+std::string orderResult(const Order& order) {
+    std::ostringstream result;
+    result.precision(17);
+    result << "OrderID=" << order.orderId << "|CustomerID=" << order.customerId << "|Total=" << order.total
+           << "|Timestamp=" << order.timestamp << "|Priority=" << order.priority
+           << "|State=" << static_cast<int>(order.state);
+    return result.str();
+}
+
+Order orderFromResult(const std::string& result) {
+    Order order{};
+    order.state = OrderState::CREATED;
+
+    std::stringstream fields(result);
+    std::string field;
+    while (std::getline(fields, field, '|')) {
+        const auto eq = field.find('=');
+        if (eq == std::string::npos) continue;
+        const std::string key = field.substr(0, eq);
+        const std::string value = field.substr(eq + 1);
+        if (key == "OrderID") order.orderId = std::stoi(value);
+        else if (key == "CustomerID") order.customerId = std::stoi(value);
+        else if (key == "Total") order.total = std::stod(value);
+        else if (key == "Timestamp") order.timestamp = static_cast<std::time_t>(std::stoll(value));
+        else if (key == "Priority") order.priority = std::stoi(value);
+        else if (key == "State") order.state = static_cast<OrderState>(std::stoi(value));
+    }
+    return order;
+}
+
+/**
+ * Run body(Transaction&) in a fresh transaction; it commits if body
+ * returns true and rolls back otherwise. True if it committed
+ */
+template <typename Body>
+bool inTransaction(Body&& body) {
+    auto& tm = TransactionManager::instance();
+    Transaction* tx = tm.createTransaction();
+    tx->begin();
+    bool proceed = false;
+    try {
+        proceed = body(*tx);
+    } catch (const std::exception& e) {
+        Logger::log(LogLevel::ERROR, "COMMAND: " + std::string(e.what()));
+    }
+    if (proceed) {
+        tx->commit();
+    } else {
+        tx->rollback();
+    }
+    const bool committed = tx->isSuccessful();
+    tm.removeTransaction(tx);
+    return committed;
+}
+
+// Log the change from `before` (orderId 0: not stored yet) to `after`, then store it
+void storeLogged(Transaction& tx, const Order& before, const Order& after) {
+    StorageStrategy& storage = StorageManager::instance().getStrategy();
+    tx.logChange(ORDER_RESOURCE, orderResult(after), before.orderId != 0 ? orderResult(before) : "");
+    tx.execute([&storage, &after] {
+        if (!storage.saveOrder(after)) {
+            throw std::runtime_error("Could not store order " + std::to_string(after.orderId));
+        }
+    }, [&storage, &before, &after] {
+        if (before.orderId != 0) {
+            storage.saveOrder(before);
+        } else {
+            storage.deleteOrder(after.orderId);
+        }
+    });
+}
+
+// Recovery: store the logged image (empty undo: the order did not exist)
+bool applyLogged(const WalChange& change, std::string_view image) {
+    if (change.resource != ORDER_RESOURCE) {
+        Logger::log(LogLevel::ERROR, "COMMAND: No recovery for " + std::string(change.resource) + " changes");
+        return false;
+    }
+    const Order order = orderFromResult(std::string(image.empty() ? change.redo : image));
+    if (order.orderId == 0) {
+        Logger::log(LogLevel::ERROR, "COMMAND: Unreadable order change in transaction " +
+                                     std::to_string(change.transactionId));
+        return false;
+    }
+    StorageStrategy& storage = StorageManager::instance().getStrategy();
+    const bool stored = image.empty() ? storage.deleteOrder(order.orderId) : storage.saveOrder(order);
+    return stored && storage.flush();
+}
+
+// Next free order ID; seeded once from the highest stored one
+int nextOrderId() {
+    static std::atomic<int> lastId{[] {
+        int highest = 0;
+        StorageManager::instance().getStrategy().forEachOrder(nullptr, [&](const Order& order) {
+            highest = std::max(highest, order.orderId);
+            return true;
+        });
+        return highest;
+    }()};
+    return ++lastId;
+}
+
+} // namespace
+
+bool OrderCommandService::redoChange(const WalChange& change) {
+    return applyLogged(change, change.redo);
+}
+
+bool OrderCommandService::undoChange(const WalChange& change) {
+    return applyLogged(change, change.undo);
+}
 
 OrderCommandService& OrderCommandService::instance() {
     static OrderCommandService ocs;
     return ocs;
 }
 
-Order OrderCommandService::createOrder(const std::string& customerId, 
+Order OrderCommandService::createOrder(int customerId, 
                                        const std::vector<MenuItem>& items,
                                        const std::string& requestId) {
-    Logger::log("COMMAND: Creating order for customer " + customerId);
+    // Single flight: a retry of a running or finished request gets the
+    // first attempt's order instead of creating another one
+    while (!requestId.empty()) {
+        IdempotencyClaim claim = IdempotencyService::claim(requestId);
+        if (claim.owner) break;
+        const IdempotencyOutcome outcome = claim.result.get();
+        if (outcome.status == IdempotencyOutcome::Status::ABANDONED) continue;   // Take over
+        if (outcome.status == IdempotencyOutcome::Status::FAILED) {
+            LOGF_WARN("COMMAND: Request ", requestId, " failed in another attempt");
+            return Order{};   // A later retry claims it again and re-runs
+        }
+        LOGF_INFO("COMMAND: Request ", requestId, " already handled, returning its order");
+        return orderFromResult(outcome.resultData);
+    }
     
-    Order order;
-    order.id = "ORD-" + std::to_string(std::time(nullptr));
-    order.customerId = customerId;
-    order.items = items;
-    order.status = OrderStatus::CREATED;
-    order.createdAt = std::time(nullptr);
+    try {
+        Order order = buildOrder(customerId, items);
+        if (!requestId.empty()) {
+            if (order.orderId != 0) {
+                IdempotencyService::recordSuccess(requestId, "create_order", orderResult(order));
+            } else {
+                IdempotencyService::recordFailure(requestId, "create_order");
+            }
+        }
+        return order;
+    } catch (...) {
+        if (!requestId.empty()) IdempotencyService::abandonRequest(requestId);
+        throw;
+    }
+}
+
+Order OrderCommandService::buildOrder(int customerId, const std::vector<MenuItem>& items) {
+    LOGF_INFO("COMMAND: Creating order for customer ", customerId);
+    if (items.empty()) {
+        Logger::log(LogLevel::ERROR, "COMMAND: Order for customer " + std::to_string(customerId) + " has no items");
+        return Order{};
+    }
     
     double subtotal = 0.0;
     for (const auto& item : items) {
         subtotal += item.price;
     }
-    order.subtotal = subtotal;
-    order.tax = subtotal * 0.08;
-    order.total = order.subtotal + order.tax;
     
-    Logger::log("COMMAND: Order created with ID " + order.id);
+    Order order{};
+    order.orderId = nextOrderId();
+    order.customerId = customerId;
+    order.total = subtotal + subtotal * 0.08;   // Tax
+    order.timestamp = std::time(nullptr);
+    order.state = OrderState::CREATED;
+    const Order none{};
+    if (!inTransaction([&](Transaction& tx) {
+            storeLogged(tx, none, order);
+            return true;
+        })) {
+        Logger::log(LogLevel::ERROR, "COMMAND: Could not store order " + std::to_string(order.orderId));
+        return Order{};
+    }
+    
+    LOGF_INFO("COMMAND: Order created with ID ", order.orderId);
     
     // Emit event
-    OrderCreatedEvent event;
-    event.orderId = order.id;
-    event.total = order.total;
-    ServiceLocator::instance().getEventSystem().publish(event);
+    static const EventSourceId source = EventSources::intern("OrderCommandService");
+    Event event{EventType::ORDER_PLACED, EntityType::ORDER, source, order.orderId, order.timestamp,
+                OrderPayload{order.customerId, order.total}};
+    EventBus::getInstance().emit(event);
     
     return order;
 }
 
-void OrderCommandService::confirmOrder(const std::string& orderId) {
-    Logger::log("COMMAND: Confirming order " + orderId);
-    
-    // In a real system, verify payment, update inventory, etc.
-    // For this demo, just log the command
+bool OrderCommandService::transition(int orderId, OrderState next, EventType type) {
+    Order before{}, order{};   // Outlive the transaction's rollback
+    const bool committed = inTransaction([&](Transaction& tx) {
+        if (!tx.lock(EntityType::ORDER, orderId, LockMode::EXCLUSIVE)) return false;
+        before = StorageManager::instance().getStrategy().loadOrder(orderId);
+        if (before.orderId != orderId) {
+            Logger::log(LogLevel::ERROR, "COMMAND: Order " + std::to_string(orderId) + " not found");
+            return false;
+        }
+        order = before;
+        if (!order.updateState(next)) return false;
+        storeLogged(tx, before, order);
+        return true;
+    });
+    if (!committed) return false;
     
-    OrderConfirmedEvent event;
-    event.orderId = orderId;
-    ServiceLocator::instance().getEventSystem().publish(event);
+    static const EventSourceId source = EventSources::intern("OrderCommandService");
+    Event event{type, EntityType::ORDER, source, orderId, std::time(nullptr),
+                OrderPayload{order.customerId, order.total}};
+    EventBus::getInstance().emit(event);
+    return true;
 }
 
-void OrderCommandService::markAsServing(const std::string& orderId) {
-    Logger::log("COMMAND: Marking order " + orderId + " as SERVING");
-    
-    OrderServingEvent event;
-    event.orderId = orderId;
-    ServiceLocator::instance().getEventSystem().publish(event);
+bool OrderCommandService::confirmOrder(int orderId) {
+    LOGF_INFO("COMMAND: Confirming order ", orderId);
+    return transition(orderId, OrderState::CONFIRMED, EventType::ORDER_CONFIRMED);
 }
 
-void OrderCommandService::markAsReady(const std::string& orderId) {
-    Logger::log("COMMAND: Marking order " + orderId + " as READY");
-    
-    // No specific event for ready, but tracked in OrderReadyEvent
+bool OrderCommandService::markAsServing(int orderId) {
+    LOGF_INFO("COMMAND: Marking order ", orderId, " as PREPARING");
+    return transition(orderId, OrderState::PREPARING, EventType::ORDER_PREPARING);
 }
 
-void OrderCommandService::markAsServed(const std::string& orderId) {
-    Logger::log("COMMAND: Marking order " + orderId + " as SERVED");
-    
-    OrderServedEvent event;
-    event.orderId = orderId;
-    ServiceLocator::instance().getEventSystem().publish(event);
+bool OrderCommandService::markAsReady(int orderId) {
+    LOGF_INFO("COMMAND: Marking order ", orderId, " as READY");
+    return transition(orderId, OrderState::READY, EventType::ORDER_READY);
 }
 
-void OrderCommandService::cancelOrder(const std::string& orderId) {
-    Logger::log("COMMAND: Cancelling order " + orderId);
-    
-    OrderCancelledEvent event;
-    event.orderId = orderId;
-    ServiceLocator::instance().getEventSystem().publish(event);
+bool OrderCommandService::markAsServed(int orderId) {
+    LOGF_INFO("COMMAND: Marking order ", orderId, " as SERVED");
+    return transition(orderId, OrderState::SERVED, EventType::ORDER_SERVED);
 }
 
-void OrderCommandService::issueRefund(const std::string& orderId, const std::string& reason) {
-    Logger::log("COMMAND: Issuing refund for order " + orderId + " - Reason: " + reason);
-    
-    RefundProcessedEvent event;
-    event.orderId = orderId;
-    event.reason = reason;
-    ServiceLocator::instance().getEventSystem().publish(event);
+bool OrderCommandService::cancelOrder(int orderId) {
+    LOGF_INFO("COMMAND: Cancelling order ", orderId);
+    return transition(orderId, OrderState::CANCELLED, EventType::ORDER_CANCELLED);
+}
+
+bool OrderCommandService::issueRefund(int orderId, const std::string& reason) {
+    LOGF_INFO("COMMAND: Issuing refund for order ", orderId, " - Reason: ", reason);
+    return transition(orderId, OrderState::REFUNDED, EventType::ORDER_REFUNDED);
 }
@@ -1,104 +1,63 @@
 #include "OrderQueryService.h"
 #include "Logger.h"
-#include <algorithm>
-#include <fstream>
-#include <sstream>
 
 OrderQueryService& OrderQueryService::instance() {
     static OrderQueryService oqs;
     return oqs;
 }
 
-Order OrderQueryService::getOrder(const std::string& orderId) {
-    Logger::log("QUERY: Getting order " + orderId);
-    
-    // Simulate querying (in real system, read from optimized index)
-    Order order;
-    order.id = orderId;
-    return order;
+std::vector<Order> OrderQueryService::collect(const RecordPredicate<Order>& predicate) {
+    std::vector<Order> matches;
+    StorageManager::instance().getStrategy().forEachOrder(predicate, [&](const Order& order) {
+        matches.push_back(order);
+        return true;
+    });
+    return matches;
+}
+
+Order OrderQueryService::getOrder(int orderId) {
+    LOGF_INFO("QUERY: Getting order ", orderId);
+    return StorageManager::instance().getStrategy().loadOrder(orderId);
 }
 
 std::vector<Order> OrderQueryService::getAllOrders() {
-    Logger::log("QUERY: Getting all orders");
-    
-    // Simulate reading all orders (in real system, read from indexed view)
-    std::vector<Order> orders;
-    
-    try {
-        std::ifstream file("data/orders.txt");
-        if (file.is_open()) {
-            std::string line;
-            while (std::getline(file, line)) {
-                if (!line.empty()) {
-                    Order order;
-                    order.id = line;
-                    orders.push_back(order);
-                }
-            }
-            file.close();
-        }
-    } catch (...) {
-        Logger::log("Error reading orders");
-    }
-    
-    return orders;
+    LOGF_INFO("QUERY: Getting all orders");
+    return StorageManager::instance().getStrategy().loadAllOrders();
 }
 
 std::vector<Order> OrderQueryService::getActiveOrders() {
-    Logger::log("QUERY: Getting active orders");
+    LOGF_INFO("QUERY: Getting active orders");
     
-    // In real CQRS, this would hit a materialized view
     // Active = not SERVED, not REFUNDED, not CANCELLED
-    std::vector<Order> active;
-    auto all = getAllOrders();
-    
-    for (const auto& order : all) {
-        if (order.status != OrderStatus::SERVED && 
-            order.status != OrderStatus::REFUNDED && 
-            order.status != OrderStatus::CANCELLED) {
-            active.push_back(order);
-        }
-    }
-    
-    return active;
+    return collect([](const Order& order) {
+        return order.state != OrderState::SERVED &&
+               order.state != OrderState::REFUNDED &&
+               order.state != OrderState::CANCELLED;
+    });
 }
 
-std::vector<Order> OrderQueryService::getOrdersByCustomer(const std::string& customerId) {
-    Logger::log("QUERY: Getting orders for customer " + customerId);
-    
-    std::vector<Order> customerOrders;
-    auto all = getAllOrders();
-    
-    for (const auto& order : all) {
-        if (order.customerId == customerId) {
-            customerOrders.push_back(order);
-        }
-    }
-    
-    return customerOrders;
+std::vector<Order> OrderQueryService::getOrdersByCustomer(int customerId) {
+    LOGF_INFO("QUERY: Getting orders for customer ", customerId);
+    return collect([customerId](const Order& order) { return order.customerId == customerId; });
 }
 
-std::vector<Order> OrderQueryService::getOrdersByStatus(OrderStatus status) {
-    Logger::log("QUERY: Getting orders by status");
-    
-    std::vector<Order> statusOrders;
-    auto all = getAllOrders();
-    
-    for (const auto& order : all) {
-        if (order.status == status) {
-            statusOrders.push_back(order);
-        }
-    }
-    
-    return statusOrders;
+std::vector<Order> OrderQueryService::getOrdersByStatus(OrderState state) {
+    LOGF_INFO("QUERY: Getting orders in state ", OrderFSM::name(state));
+    return collect([state](const Order& order) { return order.state == state; });
 }
 
 Order OrderQueryService::getLastOrder() {
-    Logger::log("QUERY: Getting last order");
-    
-    auto orders = getAllOrders();
-    if (orders.empty()) {
-        return Order();
-    }
-    return orders.back();
+    LOGF_INFO("QUERY: Getting last order");
+    
+    // Newest = highest ID; file order would put any order updated since last
+    Order last{};
+    StorageManager::instance().getStrategy().forEachOrder(nullptr, [&](const Order& order) {
+        if (order.orderId > last.orderId) last = order;
+        return true;
+    });
+    return last;
+}
+
+std::size_t OrderQueryService::countOrders(const RecordPredicate<Order>& predicate) {
+    return StorageManager::instance().getStrategy().forEachOrder(predicate, [](const Order&) { return true; });
 }
@@ -21,8 +21,8 @@ bool PermissionService::canPerform(Action action) {
     };
 
     const bool permitted = std::find(allowed.begin(), allowed.end(), action) != allowed.end();
-    Logger::log(LogLevel::DEBUG, "Permission check: " + actionToString(action) +
-                                   (permitted ? " -> ALLOWED" : " -> DENIED"));
+    LOGF_DEBUG("Permission check: ", actionToString(action),
+               permitted ? " -> ALLOWED" : " -> DENIED");
     return permitted;
 }
 
@@ -1,306 +1,613 @@
 #include "StorageStrategy.h"
+#include "CachingStorageStrategy.h"
+#include "Config.h"
+#include "CsvReader.h"
 #include "Logger.h"
+#include <charconv>
 #include <fstream>
-#include <sstream>
 #include <filesystem>
+#include <sstream>
+#include <utility>
 
 namespace fs = std::filesystem;
 
-// ============ CSVStorageStrategy Implementation ============
+namespace {
 
-bool CSVStorageStrategy::saveCustomer(const CustomerRecord& customer) {
-    Logger::log("STORAGE: Saving customer " + customer.id + " (CSV)");
-    
-    try {
-        std::ofstream file("data/customers.txt", std::ios::app);
-        if (!file.is_open()) return false;
-        
-        file << customer.id << "," << customer.name << "," 
-             << customer.email << "," << (customer.isActive ? "1" : "0") << "\n";
-        file.close();
-        return true;
-    } catch (...) {
+constexpr const char* CUSTOMERS_FILE = "customers.txt";
+constexpr const char* MENU_ITEMS_FILE = "menu_items.txt";
+constexpr const char* ORDERS_FILE = "orders.txt";
+
+// Row decoders; false for rows without a numeric ID (headers, damage).
+// Strings are assigned in place so a reused record keeps its buffers
+bool parseCustomer(const CsvRow& row, CustomerRecord& customer) {
+    if (!row.get(0, customer.id)) return false;
+    customer.name.assign(row[1]);
+    customer.phone.assign(row[2]);
+    customer.email.assign(row[3]);
+    customer.loyaltyPoints = 0;
+    row.get(4, customer.loyaltyPoints);
+    customer.isActive = row[5] != "0";
+    customer.deletedAt = 0;
+    row.get(6, customer.deletedAt);
+    return true;
+}
+
+bool parseMenuItem(const CsvRow& row, MenuItem& item) {
+    if (!row.get(0, item.id)) return false;
+    item.name.assign(row[1]);
+    item.category.assign(row[2]);
+    item.price = 0.0;
+    row.get(3, item.price);
+    return true;
+}
+
+bool parseOrder(const CsvRow& row, Order& order) {
+    int state = 0;
+    if (!row.get(0, order.orderId) || !row.get(1, order.customerId) || !row.get(2, order.total) ||
+        !row.get(3, state) || state < 0 || state > static_cast<int>(OrderState::REFUNDED)) {
         return false;
     }
+    order.state = static_cast<OrderState>(state);
+    order.priority = 0;
+    order.timestamp = 0;
+    row.get(4, order.priority);
+    row.get(5, order.timestamp);
+    return true;
 }
 
-CustomerRecord CSVStorageStrategy::loadCustomer(const std::string& id) {
-    Logger::log("STORAGE: Loading customer " + id + " (CSV)");
-    
-    CustomerRecord customer;
-    try {
-        std::ifstream file("data/customers.txt");
-        if (!file.is_open()) return customer;
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string cid, name, email, active;
-            
-            if (std::getline(ss, cid, ',') && cid == id) {
-                std::getline(ss, name, ',');
-                std::getline(ss, email, ',');
-                std::getline(ss, active, ',');
-                
-                customer.id = cid;
-                customer.name = name;
-                customer.email = email;
-                customer.isActive = (active == "1");
-                return customer;
-            }
-        }
-        file.close();
-    } catch (...) {
-        Logger::log("Error loading customer from CSV");
+// Latest row stored under `id`, decoded into `out`
+template <typename Record, typename Parse>
+bool findById(CsvIndex& index, int id, Record& out, Parse&& parse) {
+    std::string line;
+    if (!index.find(id, line)) return false;
+    CsvRow row;
+    CsvReader::splitLine(line.data(), line.data() + line.size(), row);
+    return parse(row, out);
+}
+
+// One pass over the mapped file that decodes each ID's latest row only
+// (older versions stay in the file until compaction), in file order
+template <typename Record, typename Parse, typename Fn>
+void forEachLatest(CsvIndex& index, bool stream, Parse&& parse, Fn&& fn) {
+    CsvReader reader;
+    std::vector<std::uint64_t> latest;
+    if (!index.openLatest(reader, latest)) return;
+    Record record{};
+    std::size_t next = 0;
+    const auto visit = [&](const CsvRow& row) {
+        while (next < latest.size() && latest[next] < row.offset) ++next;
+        if (next == latest.size()) return false;
+        if (latest[next] != row.offset) return true;   // Superseded version
+        return !parse(row, record) || fn(record);
+    };
+    if (stream) {
+        reader.streamRows(visit);
+    } else {
+        reader.forEachRow(visit);
+    }
+}
+
+template <typename Record, typename Parse>
+std::vector<Record> loadAll(CsvIndex& index, Parse&& parse) {
+    std::vector<Record> records;
+    forEachLatest<Record>(index, false, parse, [&](const Record& record) {
+        records.push_back(record);
+        return true;
+    });
+    return records;
+}
+
+// Hand each decoded record that passes `predicate` to `visitor`
+template <typename Record>
+bool offer(const Record& record, const RecordPredicate<Record>& predicate, const RecordVisitor<Record>& visitor,
+           std::size_t& visited) {
+    if (predicate && !predicate(record)) return true;
+    ++visited;
+    return visitor(record);
+}
+
+// Streams, releasing the pages behind the cursor
+template <typename Record, typename Parse>
+std::size_t scanFile(CsvIndex& index, const RecordPredicate<Record>& predicate,
+                     const RecordVisitor<Record>& visitor, Parse&& parse) {
+    std::size_t visited = 0;
+    forEachLatest<Record>(index, true, parse, [&](const Record& record) {
+        return offer(record, predicate, visitor, visited);
+    });
+    return visited;
+}
+
+template <typename Record>
+std::size_t scanVector(const std::vector<Record>& records, const RecordPredicate<Record>& predicate,
+                       const RecordVisitor<Record>& visitor) {
+    std::size_t visited = 0;
+    for (const Record& record : records) {
+        if (!offer(record, predicate, visitor, visited)) break;
     }
+    return visited;
+}
+
+// Shortest text that parses back to the same double (the stream default
+// keeps 6 significant digits, so 12345.67 would reload as 12345.7)
+void writeAmount(std::ostringstream& line, double amount) {
+    char text[32];
+    const auto res = std::to_chars(text, text + sizeof(text), amount);
+    line.write(text, res.ptr - text);
+}
+
+int formatCustomer(std::ostringstream& line, const CustomerRecord& customer) {
+    line << customer.id << "," << customer.name << "," << customer.phone << ","
+         << customer.email << "," << customer.loyaltyPoints << "," << (customer.isActive ? "1" : "0") << ","
+         << customer.deletedAt;
+    return customer.id;
+}
+
+int formatMenuItem(std::ostringstream& line, const MenuItem& item) {
+    line << item.id << "," << item.name << "," << item.category << ",";
+    writeAmount(line, item.price);
+    return item.id;
+}
+
+int formatOrder(std::ostringstream& line, const Order& order) {
+    line << order.orderId << "," << order.customerId << ",";
+    writeAmount(line, order.total);
+    line << "," << static_cast<int>(order.state) << "," << order.priority << "," << order.timestamp;
+    return order.orderId;
+}
+
+// Compaction rule: a customer soft-deleted before the retention horizon
+bool customerExpired(const CsvRow& row, std::time_t horizon) {
+    std::time_t deletedAt = 0;
+    return row[5] == "0" && row.get(6, deletedAt) && deletedAt > 0 && deletedAt < horizon;
+}
+
+// Buffer each record as a row, then flush once if every call must reach the file
+template <typename Record, typename Format>
+bool appendRows(CsvIndex& index, const Record* records, std::size_t count, bool flushEachCall, Format&& format) {
+    std::ostringstream line;
+    bool ok = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        line.str("");
+        const int id = format(line, records[i]);
+        ok = index.append(id, line.str()) && ok;
+    }
+    return (!flushEachCall || index.flush()) && ok;
+}
+
+// Store each record under its ID, with the CSV row as the value
+template <typename Record, typename Format>
+bool putRows(LsmTree& tree, const Record* records, std::size_t count, Format&& format) {
+    std::ostringstream line;
+    bool ok = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        line.str("");
+        const int id = format(line, records[i]);
+        ok = tree.put(id, line.str()) && ok;
+    }
+    return ok;
+}
+
+template <typename Record, typename Parse>
+bool getRow(const LsmTree& tree, int id, Record& out, Parse&& parse) {
+    std::string value;
+    if (!tree.get(id, value)) return false;
+    CsvRow row;
+    CsvReader::splitLine(value.data(), value.data() + value.size(), row);
+    return parse(row, out);
+}
+
+template <typename Record, typename Parse>
+std::vector<Record> getAllRows(const LsmTree& tree, Parse&& parse) {
+    std::vector<Record> records;
+    Record record{};
+    CsvRow row;
+    tree.forEach([&](int, std::string_view value) {
+        CsvReader::splitLine(value.data(), value.data() + value.size(), row);
+        if (parse(row, record)) records.push_back(record);
+        return true;
+    });
+    return records;
+}
+
+template <typename Record, typename Parse>
+std::size_t scanTree(const LsmTree& tree, const RecordPredicate<Record>& predicate,
+                     const RecordVisitor<Record>& visitor, Parse&& parse) {
+    Record record{};
+    CsvRow row;
+    std::size_t visited = 0;
+    tree.forEach([&](int, std::string_view value) {
+        CsvReader::splitLine(value.data(), value.data() + value.size(), row);
+        return !parse(row, record) || offer(record, predicate, visitor, visited);
+    });
+    return visited;
+}
+
+} // namespace
+
+// ============ StorageStrategy batch defaults ============
+
+bool StorageStrategy::saveCustomers(const CustomerRecord* customers, std::size_t count) {
+    bool ok = true;
+    for (std::size_t i = 0; i < count; ++i) ok = saveCustomer(customers[i]) && ok;
+    return ok;
+}
+
+bool StorageStrategy::saveMenuItems(const MenuItem* items, std::size_t count) {
+    bool ok = true;
+    for (std::size_t i = 0; i < count; ++i) ok = saveMenuItem(items[i]) && ok;
+    return ok;
+}
+
+bool StorageStrategy::saveOrders(const Order* orders, std::size_t count) {
+    bool ok = true;
+    for (std::size_t i = 0; i < count; ++i) ok = saveOrder(orders[i]) && ok;
+    return ok;
+}
+
+std::size_t StorageStrategy::forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                             const RecordVisitor<CustomerRecord>& visitor) {
+    return scanVector(loadAllCustomers(), predicate, visitor);
+}
+
+std::size_t StorageStrategy::forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                             const RecordVisitor<MenuItem>& visitor) {
+    return scanVector(loadAllMenuItems(), predicate, visitor);
+}
+
+std::size_t StorageStrategy::forEachOrder(const RecordPredicate<Order>& predicate,
+                                          const RecordVisitor<Order>& visitor) {
+    return scanVector(loadAllOrders(), predicate, visitor);
+}
+
+// ============ CSVStorageStrategy Implementation ============
+
+CSVStorageStrategy::CSVStorageStrategy(std::string dir)
+    : dataDirectory(std::move(dir)),
+      customerIndex(filePath(CUSTOMERS_FILE)),
+      menuItemIndex(filePath(MENU_ITEMS_FILE)),
+      orderIndex(filePath(ORDERS_FILE)) {}
+
+void CSVStorageStrategy::setWritePolicy(const CsvWritePolicy& policy) {
+    customerIndex.setWritePolicy(policy);
+    menuItemIndex.setWritePolicy(policy);
+    orderIndex.setWritePolicy(policy);
+    flushEachCall = policy.flushEachCall;
+}
+
+bool CSVStorageStrategy::flush() {
+    const bool customers = customerIndex.flush();
+    const bool menuItems = menuItemIndex.flush();
+    return orderIndex.flush() && customers && menuItems;
+}
+
+bool CSVStorageStrategy::rebuildIndexes() {
+    LOGF_INFO("STORAGE: Rebuilding CSV indexes in ", dataDirectory);
+    return customerIndex.rebuild() && menuItemIndex.rebuild() && orderIndex.rebuild();
+}
+
+CsvCompactor& CSVStorageStrategy::getCompactor(const CsvCompactionOptions& options) {
+    if (!compactor) {
+        compactor = std::make_unique<CsvCompactor>(options);
+        compactor->addFile(customerIndex, customerExpired);
+        compactor->addFile(menuItemIndex);
+        compactor->addFile(orderIndex);
+    }
+    return *compactor;
+}
+
+void CSVStorageStrategy::startCompaction(const CsvCompactionOptions& options) {
+    LOGF_INFO("STORAGE: Background compaction on for ", dataDirectory);
+    compactor.reset();
+    getCompactor(options).start();
+}
+
+void CSVStorageStrategy::stopCompaction() {
+    if (compactor) compactor->stop();
+}
+
+bool CSVStorageStrategy::compact() {
+    LOGF_INFO("STORAGE: Compacting ", dataDirectory, " (CSV)");
+    return getCompactor().compactAll();
+}
+
+CsvCompactionStats CSVStorageStrategy::getCompactionStats() const {
+    return compactor ? compactor->getStats() : CsvCompactionStats();
+}
+
+std::string CSVStorageStrategy::filePath(const char* name) const {
+    return dataDirectory + "/" + name;
+}
+
+bool CSVStorageStrategy::saveCustomer(const CustomerRecord& customer) {
+    LOGF_INFO("STORAGE: Saving customer ", customer.id, " (CSV)");
     
+    return appendRows(customerIndex, &customer, 1, flushEachCall, formatCustomer);
+}
+
+CustomerRecord CSVStorageStrategy::loadCustomer(int id) {
+    LOGF_INFO("STORAGE: Loading customer ", id, " (CSV)");
+    
+    CustomerRecord customer{};
+    findById(customerIndex, id, customer, parseCustomer);
     return customer;
 }
 
 std::vector<CustomerRecord> CSVStorageStrategy::loadAllCustomers() {
-    Logger::log("STORAGE: Loading all customers (CSV)");
-    
-    std::vector<CustomerRecord> customers;
-    try {
-        std::ifstream file("data/customers.txt");
-        if (!file.is_open()) return customers;
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string cid, name, email, active;
-            
-            if (std::getline(ss, cid, ',')) {
-                std::getline(ss, name, ',');
-                std::getline(ss, email, ',');
-                std::getline(ss, active, ',');
-                
-                CustomerRecord customer;
-                customer.id = cid;
-                customer.name = name;
-                customer.email = email;
-                customer.isActive = (active == "1");
-                customers.push_back(customer);
-            }
-        }
-        file.close();
-    } catch (...) {
-        Logger::log("Error loading customers from CSV");
-    }
-    
-    return customers;
+    LOGF_INFO("STORAGE: Loading all customers (CSV)");
+    return loadAll<CustomerRecord>(customerIndex, parseCustomer);
 }
 
-bool CSVStorageStrategy::deleteCustomer(const std::string& id) {
-    Logger::log("STORAGE: Deleting customer " + id + " (CSV)");
+bool CSVStorageStrategy::deleteCustomer(int id) {
+    LOGF_INFO("STORAGE: Deleting customer ", id, " (CSV)");
     
-    // For CSV, soft delete would mark as inactive
-    // Hard delete would remove the line (not typical for this pattern)
-    return true;
+    // Soft delete: append an inactive version; compaction drops it after the retention period
+    CustomerRecord customer{};
+    if (!findById(customerIndex, id, customer, parseCustomer)) return false;
+    if (!customer.isActive) return true;
+    customer.softDelete();
+    return appendRows(customerIndex, &customer, 1, flushEachCall, formatCustomer);
 }
 
 bool CSVStorageStrategy::saveMenuItem(const MenuItem& item) {
-    Logger::log("STORAGE: Saving menu item " + item.id + " (CSV)");
+    LOGF_INFO("STORAGE: Saving menu item ", item.id, " (CSV)");
     
-    try {
-        std::ofstream file("data/menu_items.txt", std::ios::app);
-        if (!file.is_open()) return false;
-        
-        file << item.id << "," << item.name << "," << item.price << ","
-             << item.quantityAvailable << "\n";
-        file.close();
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return appendRows(menuItemIndex, &item, 1, flushEachCall, formatMenuItem);
 }
 
-MenuItem CSVStorageStrategy::loadMenuItem(const std::string& id) {
-    Logger::log("STORAGE: Loading menu item " + id + " (CSV)");
-    
-    MenuItem item;
-    try {
-        std::ifstream file("data/menu_items.txt");
-        if (!file.is_open()) return item;
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string iid, name, price, qty;
-            
-            if (std::getline(ss, iid, ',') && iid == id) {
-                std::getline(ss, name, ',');
-                std::getline(ss, price, ',');
-                std::getline(ss, qty, ',');
-                
-                item.id = iid;
-                item.name = name;
-                item.price = std::stod(price);
-                item.quantityAvailable = std::stoi(qty);
-                return item;
-            }
-        }
-        file.close();
-    } catch (...) {
-        Logger::log("Error loading menu item from CSV");
-    }
+MenuItem CSVStorageStrategy::loadMenuItem(int id) {
+    LOGF_INFO("STORAGE: Loading menu item ", id, " (CSV)");
     
+    MenuItem item{};
+    findById(menuItemIndex, id, item, parseMenuItem);
     return item;
 }
 
 std::vector<MenuItem> CSVStorageStrategy::loadAllMenuItems() {
-    Logger::log("STORAGE: Loading all menu items (CSV)");
-    
-    std::vector<MenuItem> items;
-    try {
-        std::ifstream file("data/menu_items.txt");
-        if (!file.is_open()) return items;
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string iid, name, price, qty;
-            
-            if (std::getline(ss, iid, ',')) {
-                std::getline(ss, name, ',');
-                std::getline(ss, price, ',');
-                std::getline(ss, qty, ',');
-                
-                MenuItem item;
-                item.id = iid;
-                item.name = name;
-                item.price = std::stod(price);
-                item.quantityAvailable = std::stoi(qty);
-                items.push_back(item);
-            }
-        }
-        file.close();
-    } catch (...) {
-        Logger::log("Error loading menu items from CSV");
-    }
-    
-    return items;
+    LOGF_INFO("STORAGE: Loading all menu items (CSV)");
+    return loadAll<MenuItem>(menuItemIndex, parseMenuItem);
 }
 
-bool CSVStorageStrategy::deleteMenuItem(const std::string& id) {
-    Logger::log("STORAGE: Deleting menu item " + id + " (CSV)");
+bool CSVStorageStrategy::deleteMenuItem(int id) {
+    LOGF_INFO("STORAGE: Deleting menu item ", id, " (CSV)");
     return true;
 }
 
 bool CSVStorageStrategy::saveOrder(const Order& order) {
-    Logger::log("STORAGE: Saving order " + order.id + " (CSV)");
+    LOGF_INFO("STORAGE: Saving order ", order.orderId, " (CSV)");
     
-    try {
-        std::ofstream file("data/orders.txt", std::ios::app);
-        if (!file.is_open()) return false;
-        
-        file << order.id << "," << order.customerId << "," 
-             << order.total << "," << static_cast<int>(order.status) << "\n";
-        file.close();
-        return true;
-    } catch (...) {
-        return false;
-    }
+    return appendRows(orderIndex, &order, 1, flushEachCall, formatOrder);
 }
 
-Order CSVStorageStrategy::loadOrder(const std::string& id) {
-    Logger::log("STORAGE: Loading order " + id + " (CSV)");
-    
-    Order order;
-    try {
-        std::ifstream file("data/orders.txt");
-        if (!file.is_open()) return order;
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string oid, cid, total, status;
-            
-            if (std::getline(ss, oid, ',') && oid == id) {
-                std::getline(ss, cid, ',');
-                std::getline(ss, total, ',');
-                std::getline(ss, status, ',');
-                
-                order.id = oid;
-                order.customerId = cid;
-                order.total = std::stod(total);
-                order.status = static_cast<OrderStatus>(std::stoi(status));
-                return order;
-            }
-        }
-        file.close();
-    } catch (...) {
-        Logger::log("Error loading order from CSV");
-    }
+Order CSVStorageStrategy::loadOrder(int id) {
+    LOGF_INFO("STORAGE: Loading order ", id, " (CSV)");
     
+    Order order{};
+    findById(orderIndex, id, order, parseOrder);
     return order;
 }
 
 std::vector<Order> CSVStorageStrategy::loadAllOrders() {
-    Logger::log("STORAGE: Loading all orders (CSV)");
-    
-    std::vector<Order> orders;
-    try {
-        std::ifstream file("data/orders.txt");
-        if (!file.is_open()) return orders;
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            if (line.empty()) continue;
-            
-            std::stringstream ss(line);
-            std::string oid, cid, total, status;
-            
-            if (std::getline(ss, oid, ',')) {
-                std::getline(ss, cid, ',');
-                std::getline(ss, total, ',');
-                std::getline(ss, status, ',');
-                
-                Order order;
-                order.id = oid;
-                order.customerId = cid;
-                order.total = std::stod(total);
-                order.status = static_cast<OrderStatus>(std::stoi(status));
-                orders.push_back(order);
-            }
-        }
-        file.close();
-    } catch (...) {
-        Logger::log("Error loading orders from CSV");
-    }
-    
-    return orders;
+    LOGF_INFO("STORAGE: Loading all orders (CSV)");
+    return loadAll<Order>(orderIndex, parseOrder);
 }
 
-bool CSVStorageStrategy::deleteOrder(const std::string& id) {
-    Logger::log("STORAGE: Deleting order " + id + " (CSV)");
+bool CSVStorageStrategy::deleteOrder(int id) {
+    LOGF_INFO("STORAGE: Deleting order ", id, " (CSV)");
     return true;
 }
 
+bool CSVStorageStrategy::saveCustomers(const CustomerRecord* customers, std::size_t count) {
+    LOGF_INFO("STORAGE: Saving ", count, " customers (CSV)");
+    return appendRows(customerIndex, customers, count, flushEachCall, formatCustomer);
+}
+
+bool CSVStorageStrategy::saveMenuItems(const MenuItem* items, std::size_t count) {
+    LOGF_INFO("STORAGE: Saving ", count, " menu items (CSV)");
+    return appendRows(menuItemIndex, items, count, flushEachCall, formatMenuItem);
+}
+
+bool CSVStorageStrategy::saveOrders(const Order* orders, std::size_t count) {
+    LOGF_INFO("STORAGE: Saving ", count, " orders (CSV)");
+    return appendRows(orderIndex, orders, count, flushEachCall, formatOrder);
+}
+
+std::size_t CSVStorageStrategy::forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                                const RecordVisitor<CustomerRecord>& visitor) {
+    LOGF_INFO("STORAGE: Scanning customers (CSV)");
+    return scanFile(customerIndex, predicate, visitor, parseCustomer);
+}
+
+std::size_t CSVStorageStrategy::forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                                const RecordVisitor<MenuItem>& visitor) {
+    LOGF_INFO("STORAGE: Scanning menu items (CSV)");
+    return scanFile(menuItemIndex, predicate, visitor, parseMenuItem);
+}
+
+std::size_t CSVStorageStrategy::forEachOrder(const RecordPredicate<Order>& predicate,
+                                             const RecordVisitor<Order>& visitor) {
+    LOGF_INFO("STORAGE: Scanning orders (CSV)");
+    return scanFile(orderIndex, predicate, visitor, parseOrder);
+}
+
 bool CSVStorageStrategy::isHealthy() {
     try {
         // Test write access
-        std::ofstream test("data/.storage_health_check.txt");
+        const std::string probe = filePath(".storage_health_check.txt");
+        std::ofstream test(probe);
         if (!test.is_open()) return false;
         test << "ok";
         test.close();
         
         // Test read access
-        std::ifstream verify("data/.storage_health_check.txt");
+        std::ifstream verify(probe);
         if (!verify.is_open()) return false;
         verify.close();
         
-        fs::remove("data/.storage_health_check.txt");
+        fs::remove(probe);
         return true;
     } catch (...) {
         return false;
     }
 }
 
+// ============ LSMStorageStrategy Implementation ============
+
+LSMStorageStrategy::LSMStorageStrategy(std::string dir, const LsmOptions& options)
+    : dataDirectory(std::move(dir)) {
+    const bool opened = customers.open(dataDirectory + "/customers", options) &&
+                        menuItems.open(dataDirectory + "/menu_items", options) &&
+                        orders.open(dataDirectory + "/orders", options);
+    if (!opened) Logger::log(LogLevel::ERROR, "STORAGE: Cannot open LSM storage in " + dataDirectory);
+}
+
+bool LSMStorageStrategy::saveCustomer(const CustomerRecord& customer) {
+    LOGF_INFO("STORAGE: Saving customer ", customer.id, " (LSM)");
+    return putRows(customers, &customer, 1, formatCustomer);
+}
+
+CustomerRecord LSMStorageStrategy::loadCustomer(int id) {
+    LOGF_INFO("STORAGE: Loading customer ", id, " (LSM)");
+    CustomerRecord customer{};
+    getRow(customers, id, customer, parseCustomer);
+    return customer;
+}
+
+std::vector<CustomerRecord> LSMStorageStrategy::loadAllCustomers() {
+    LOGF_INFO("STORAGE: Loading all customers (LSM)");
+    return getAllRows<CustomerRecord>(customers, parseCustomer);
+}
+
+bool LSMStorageStrategy::deleteCustomer(int id) {
+    LOGF_INFO("STORAGE: Deleting customer ", id, " (LSM)");
+    return customers.remove(id);
+}
+
+bool LSMStorageStrategy::saveMenuItem(const MenuItem& item) {
+    LOGF_INFO("STORAGE: Saving menu item ", item.id, " (LSM)");
+    return putRows(menuItems, &item, 1, formatMenuItem);
+}
+
+MenuItem LSMStorageStrategy::loadMenuItem(int id) {
+    LOGF_INFO("STORAGE: Loading menu item ", id, " (LSM)");
+    MenuItem item{};
+    getRow(menuItems, id, item, parseMenuItem);
+    return item;
+}
+
+std::vector<MenuItem> LSMStorageStrategy::loadAllMenuItems() {
+    LOGF_INFO("STORAGE: Loading all menu items (LSM)");
+    return getAllRows<MenuItem>(menuItems, parseMenuItem);
+}
+
+bool LSMStorageStrategy::deleteMenuItem(int id) {
+    LOGF_INFO("STORAGE: Deleting menu item ", id, " (LSM)");
+    return menuItems.remove(id);
+}
+
+bool LSMStorageStrategy::saveOrder(const Order& order) {
+    LOGF_INFO("STORAGE: Saving order ", order.orderId, " (LSM)");
+    return putRows(orders, &order, 1, formatOrder);
+}
+
+Order LSMStorageStrategy::loadOrder(int id) {
+    LOGF_INFO("STORAGE: Loading order ", id, " (LSM)");
+    Order order{};
+    getRow(orders, id, order, parseOrder);
+    return order;
+}
+
+std::vector<Order> LSMStorageStrategy::loadAllOrders() {
+    LOGF_INFO("STORAGE: Loading all orders (LSM)");
+    return getAllRows<Order>(orders, parseOrder);
+}
+
+bool LSMStorageStrategy::deleteOrder(int id) {
+    LOGF_INFO("STORAGE: Deleting order ", id, " (LSM)");
+    return orders.remove(id);
+}
+
+bool LSMStorageStrategy::saveCustomers(const CustomerRecord* records, std::size_t count) {
+    LOGF_INFO("STORAGE: Saving ", count, " customers (LSM)");
+    return putRows(customers, records, count, formatCustomer);
+}
+
+bool LSMStorageStrategy::saveMenuItems(const MenuItem* items, std::size_t count) {
+    LOGF_INFO("STORAGE: Saving ", count, " menu items (LSM)");
+    return putRows(menuItems, items, count, formatMenuItem);
+}
+
+bool LSMStorageStrategy::saveOrders(const Order* records, std::size_t count) {
+    LOGF_INFO("STORAGE: Saving ", count, " orders (LSM)");
+    return putRows(orders, records, count, formatOrder);
+}
+
+std::size_t LSMStorageStrategy::forEachCustomer(const RecordPredicate<CustomerRecord>& predicate,
+                                                const RecordVisitor<CustomerRecord>& visitor) {
+    LOGF_INFO("STORAGE: Scanning customers (LSM)");
+    return scanTree(customers, predicate, visitor, parseCustomer);
+}
+
+std::size_t LSMStorageStrategy::forEachMenuItem(const RecordPredicate<MenuItem>& predicate,
+                                                const RecordVisitor<MenuItem>& visitor) {
+    LOGF_INFO("STORAGE: Scanning menu items (LSM)");
+    return scanTree(menuItems, predicate, visitor, parseMenuItem);
+}
+
+std::size_t LSMStorageStrategy::forEachOrder(const RecordPredicate<Order>& predicate,
+                                             const RecordVisitor<Order>& visitor) {
+    LOGF_INFO("STORAGE: Scanning orders (LSM)");
+    return scanTree(orders, predicate, visitor, parseOrder);
+}
+
+bool LSMStorageStrategy::isHealthy() {
+    return customers.isOpen() && menuItems.isOpen() && orders.isOpen();
+}
+
+bool LSMStorageStrategy::compact() {
+    const bool customersOk = customers.compact();
+    const bool menuItemsOk = menuItems.compact();
+    return orders.compact() && customersOk && menuItemsOk;
+}
+
 // ============ StorageManager Implementation ============
 
-StorageManager::StorageManager() 
-    : strategy(std::make_unique<CSVStorageStrategy>()) {}
+StorageManager::StorageManager() {
+    if (Config::getString("STORAGE_BACKEND", "csv") == "lsm") {
+        LsmOptions options;
+        options.memtableBytes = static_cast<std::size_t>(Config::getInt("LSM_MEMTABLE_KB", 4096)) * 1024;
+        options.compactionTrigger = static_cast<std::size_t>(Config::getInt("LSM_COMPACTION_TRIGGER", 4));
+        options.syncWrites = Config::getBool("LSM_SYNC_WRITES", false);
+        strategy = std::make_unique<LSMStorageStrategy>(Config::getString("LSM_DIR", "data/lsm"), options);
+    } else {
+        auto csv = std::make_unique<CSVStorageStrategy>();
+        CsvWritePolicy policy;
+        policy.bufferBytes = static_cast<std::size_t>(Config::getInt("STORAGE_CSV_BUFFER_KB", 64)) * 1024;
+        policy.flushEachCall = Config::getBool("STORAGE_CSV_FLUSH_EACH_SAVE", true);
+        policy.syncOnFlush = Config::getBool("STORAGE_CSV_SYNC", false);
+        csv->setWritePolicy(policy);
+        if (Config::getBool("STORAGE_CSV_COMPACTION", true)) {
+            CsvCompactionOptions compaction;
+            compaction.interval = std::chrono::seconds(Config::getInt("STORAGE_CSV_COMPACTION_INTERVAL_SEC", 60));
+            compaction.minBytes = static_cast<std::uint64_t>(Config::getInt("STORAGE_CSV_COMPACTION_MIN_KB", 1024)) * 1024;
+            compaction.bytesPerSecond =
+                static_cast<std::uint64_t>(Config::getInt("STORAGE_CSV_COMPACTION_MB_PER_SEC", 16)) * 1024 * 1024;
+            compaction.retentionSeconds = static_cast<std::time_t>(Config::getInt("SOFT_DELETE_RETENTION_DAYS", 30)) * 24 * 3600;
+            csv->startCompaction(compaction);
+        }
+        strategy = std::move(csv);
+    }
+    
+    if (Config::getBool("STORAGE_CACHE_ENABLED", false)) {
+        StorageCacheOptions cache;
+        cache.durability = Config::getString("STORAGE_CACHE_DURABILITY", "periodic") == "sync"
+                               ? StorageCacheOptions::Durability::SYNC_ON_COMMIT
+                               : StorageCacheOptions::Durability::PERIODIC;
+        cache.flushInterval = std::chrono::milliseconds(Config::getInt("STORAGE_CACHE_FLUSH_MS", 100));
+        cache.capacity = static_cast<std::size_t>(Config::getInt("STORAGE_CACHE_CAPACITY", 100000));
+        cache.maxDirty = static_cast<std::size_t>(Config::getInt("STORAGE_CACHE_MAX_DIRTY", 10000));
+        enableCache(cache);
+    }
+}
 
 StorageManager& StorageManager::instance() {
     static StorageManager sm;
@@ -310,7 +617,7 @@ StorageManager& StorageManager::instance() {
 void StorageManager::setStrategy(std::unique_ptr<StorageStrategy> newStrategy) {
     if (newStrategy) {
         strategy = std::move(newStrategy);
-        Logger::log("Storage strategy changed to: " + strategy->getName());
+        LOGF_INFO("Storage strategy changed to: ", strategy->getName());
     }
 }
 
@@ -321,3 +628,16 @@ StorageStrategy& StorageManager::getStrategy() {
 std::string StorageManager::getStorageType() const {
     return strategy->getName();
 }
+
+void StorageManager::enableCache(const StorageCacheOptions& options) {
+    if (dynamic_cast<CachingStorageStrategy*>(strategy.get())) return;   // Already cached
+    strategy = std::make_unique<CachingStorageStrategy>(std::move(strategy), options);
+    LOGF_INFO("Storage strategy changed to: ", strategy->getName());
+}
+
+bool StorageManager::getCacheStats(StorageCacheStats& stats) const {
+    const auto* cache = dynamic_cast<const CachingStorageStrategy*>(strategy.get());
+    if (!cache) return false;
+    stats = cache->getStats();
+    return true;
+}
@@ -1,67 +1,220 @@
 #include "TransactionManager.h"
 #include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <stdexcept>
 
 // ============ Transaction Implementation ============
 
+namespace {
+std::atomic<std::uint64_t> nextTransactionId{1};
+}
+
 Transaction::Transaction() 
     : state(State::READY), 
       startTime(std::chrono::system_clock::now()) {}
 
 void Transaction::begin() {
     state = State::ACTIVE;
-    Logger::log("Transaction started");
+    id = nextTransactionId.fetch_add(1, std::memory_order_relaxed);
+    LOGF_INFO("Transaction started");
 }
 
-void Transaction::execute(std::function<void()> operation, std::function<void()> rollbackOp) {
+void Transaction::requireActive() const {
     if (state != State::ACTIVE) {
         throw std::runtime_error("Cannot execute operation: transaction not active");
     }
-    
-    try {
-        operation();
-        operations.push_back({operation, rollbackOp, true});
-        Logger::log("Transaction operation completed");
-    } catch (const std::exception& e) {
-        state = State::FAILED;
-        errorMessage = std::string("Operation failed: ") + e.what();
-        Logger::log("Transaction operation failed: " + errorMessage);
-        throw;
+}
+
+void Transaction::fail(const char* what) {
+    state = State::FAILED;
+    errorMessage = std::string("Operation failed: ") + what;
+    LOGF_INFO("Transaction operation failed: ", errorMessage);
+}
+
+void Transaction::recordOperation(Rollback&& rollbackOp) {
+    operations.emplace_back(Operation{std::move(rollbackOp), true});
+    LOGF_DEBUG("Transaction operation completed");
+}
+
+void Transaction::logChange(std::string_view resource, std::string_view redo, std::string_view undo) {
+    requireActive();
+    if (TransactionManager::instance().getWriteAheadLog().appendChange(id, resource, redo, undo) != 0) {
+        logged = true;
     }
 }
 
 void Transaction::commit() {
     if (state == State::ACTIVE) {
+        const CommitResult result = readSet.empty() && writeSet.empty()
+            ? (logCommit() ? CommitResult::OK : CommitResult::LOG_FAILED)
+            : validateAndInstall();
+        if (result == CommitResult::CONFLICT) {
+            conflict = true;
+            failCommit("Optimistic validation failed: a record read was changed by another transaction");
+            return;
+        }
+        if (result == CommitResult::LOG_FAILED) {
+            failCommit("Commit record could not be written to the write-ahead log");
+            return;
+        }
         state = State::COMMITTED;
-        Logger::log("Transaction committed with " + std::to_string(operations.size()) + " operations");
+        releaseLocks();
+        LOGF_INFO("Transaction committed with ", operations.size(), " operations");
     } else if (state == State::FAILED) {
         applyRollbacks();
-        Logger::log("Transaction failed, rollback applied");
+        logOutcome();
+        releaseLocks();
+        LOGF_INFO("Transaction failed, rollback applied");
     }
 }
 
 void Transaction::rollback() {
     if (state == State::ACTIVE || state == State::FAILED) {
         applyRollbacks();
+        logOutcome();
+        releaseLocks();
         state = State::ROLLED_BACK;
-        Logger::log("Transaction rolled back");
+        LOGF_INFO("Transaction rolled back");
     }
 }
 
 void Transaction::applyRollbacks() {
-    Logger::log("Applying " + std::to_string(operations.size()) + " rollback operations");
+    LOGF_INFO("Applying ", operations.size(), " rollback operations");
     
     // Rollback in reverse order (LIFO)
-    for (int i = operations.size() - 1; i >= 0; --i) {
+    for (size_t i = operations.size(); i-- > 0;) {
         if (operations[i].rollback) {
             try {
                 operations[i].rollback();
             } catch (const std::exception& e) {
-                Logger::log("Warning: Rollback operation " + std::to_string(i) + " failed: " + e.what());
+                LOGF_WARN("Warning: Rollback operation ", i, " failed: ", e.what());
             }
         }
     }
 }
 
+// Not committed: undo the steps already applied
+void Transaction::failCommit(const char* reason) {
+    state = State::FAILED;
+    errorMessage = reason;
+    if (conflict) {
+        LOGF_DEBUG("Transaction ", id, ": ", errorMessage);
+    } else {
+        LOGF_ERROR("Transaction ", id, ": ", errorMessage);
+    }
+    applyRollbacks();
+    logOutcome();
+    releaseLocks();
+}
+
+bool Transaction::lock(EntityType type, int entityId, LockMode mode, std::chrono::milliseconds timeout) {
+    requireActive();
+    const LockResult result = LockManager::instance().acquire(id, type, entityId, mode, timeout);
+    if (result == LockResult::GRANTED) {
+        holdsLocks = true;
+        return true;
+    }
+    
+    // The caller's commit()/rollback() undoes the steps so far and releases held locks
+    state = State::FAILED;
+    conflict = result == LockResult::DEADLOCK;
+    errorMessage = std::string(conflict ? "Deadlock victim" : "Lock timeout") + " waiting for " +
+                   ENTITY_TYPE_NAMES[static_cast<std::size_t>(type)] + " #" + std::to_string(entityId);
+    LOGF_WARN("Transaction ", id, ": ", errorMessage);
+    return false;
+}
+
+void Transaction::releaseLocks() {
+    if (holdsLocks) {
+        LockManager::instance().releaseAll(id);
+        holdsLocks = false;
+    }
+}
+
+bool Transaction::logCommit() {
+    return !logged || TransactionManager::instance().getWriteAheadLog().commit(id);
+}
+
+void Transaction::trackRead(VersionedRecordBase* record, std::uint64_t version) {
+    // Validation compares against the first version seen
+    for (const auto& entry : readSet) {
+        if (entry.record == record) return;
+    }
+    readSet.emplace_back(ReadEntry{record, version});
+}
+
+Transaction::WriteEntry* Transaction::findWrite(const VersionedRecordBase* record) {
+    for (auto& entry : writeSet) {
+        if (entry.record == record) return &entry;
+    }
+    return nullptr;
+}
+
+Transaction::CommitResult Transaction::validateAndInstall() {
+    // Lock the write set in address order so concurrent committers cannot deadlock
+    SmallVector<VersionedRecordBase*, 8> locked;
+    for (const auto& entry : writeSet) locked.emplace_back(entry.record);
+    std::sort(locked.begin(), locked.end());
+    for (auto* record : locked) record->mutex.lock();
+    auto unlockAll = [&locked] {
+        for (auto* record : locked) record->mutex.unlock();
+    };
+    
+    // Validation never blocks: a read record another committer holds counts as changed
+    for (const auto& entry : readSet) {
+        const bool own = std::binary_search(locked.begin(), locked.end(), entry.record);
+        if (!own && !entry.record->mutex.try_lock()) {
+            unlockAll();
+            return CommitResult::CONFLICT;
+        }
+        const bool unchanged = entry.record->version == entry.version;
+        if (!own) entry.record->mutex.unlock();
+        if (!unchanged) {
+            unlockAll();
+            return CommitResult::CONFLICT;
+        }
+    }
+    
+    // Durable before visible
+    if (!logCommit()) {
+        unlockAll();
+        return CommitResult::LOG_FAILED;
+    }
+    for (auto& entry : writeSet) {
+        entry.value->install();
+        entry.record->version++;
+    }
+    unlockAll();
+    return CommitResult::OK;
+}
+
+// Rolled back: recovery must not undo these changes again
+void Transaction::logOutcome() {
+    if (logged) {
+        TransactionManager::instance().getWriteAheadLog().abort(id);
+        logged = false;
+    }
+}
+
+void Transaction::reset() {
+    // Keeps the operation buffer and error string capacity for the next user
+    state = State::READY;
+    id = 0;
+    logged = false;
+    conflict = false;
+    holdsLocks = false;
+    operations.clear();
+    readSet.clear();
+    writeSet.clear();
+    errorMessage.clear();
+    startTime = std::chrono::system_clock::now();
+    prevActive = nullptr;
+    nextActive = nullptr;
+}
+
 Transaction::State Transaction::getState() const {
     return state;
 }
@@ -81,6 +234,10 @@ bool Transaction::isSuccessful() const {
     return state == State::COMMITTED;
 }
 
+bool Transaction::hasConflict() const {
+    return conflict;
+}
+
 const std::string& Transaction::getErrorMessage() const {
     return errorMessage;
 }
@@ -89,6 +246,10 @@ std::chrono::system_clock::time_point Transaction::getStartTime() const {
     return startTime;
 }
 
+std::uint64_t Transaction::getId() const {
+    return id;
+}
+
 size_t Transaction::getOperationCount() const {
     return operations.size();
 }
@@ -101,33 +262,95 @@ TransactionManager& TransactionManager::instance() {
 }
 
 Transaction* TransactionManager::createTransaction() {
-    auto tx = new Transaction();
-    activeTransactions.push_back(tx);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!freeList) {
+        chunks.emplace_back(new Transaction[POOL_CHUNK]);
+        Transaction* chunk = chunks.back().get();
+        for (size_t i = POOL_CHUNK; i-- > 0;) {
+            chunk[i].nextActive = freeList;
+            freeList = &chunk[i];
+        }
+    }
+    
+    Transaction* tx = freeList;
+    freeList = tx->nextActive;
+    tx->reset();
+    
+    tx->nextActive = activeHead;
+    if (activeHead) activeHead->prevActive = tx;
+    activeHead = tx;
+    activeCount++;
     return tx;
 }
 
 void TransactionManager::removeTransaction(Transaction* tx) {
-    if (tx->isSuccessful()) {
+    // Release rollback captures before taking the lock; the slot is reset
+    // again when it is handed out
+    const bool committed = tx->isSuccessful();
+    const bool conflicted = tx->conflict;
+    tx->releaseLocks();   // Removed without commit/rollback
+    tx->operations.clear();
+    tx->readSet.clear();
+    tx->writeSet.clear();
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    if (committed) {
         totalCommitted++;
     } else {
         totalFailed++;
     }
+    if (conflicted) totalConflicts++;
+    
+    if (tx->prevActive) tx->prevActive->nextActive = tx->nextActive;
+    else activeHead = tx->nextActive;
+    if (tx->nextActive) tx->nextActive->prevActive = tx->prevActive;
+    activeCount--;
     
-    activeTransactions.erase(
-        std::remove(activeTransactions.begin(), activeTransactions.end(), tx),
-        activeTransactions.end()
-    );
-    delete tx;
+    tx->prevActive = nullptr;
+    tx->nextActive = freeList;
+    freeList = tx;
 }
 
 size_t TransactionManager::getActiveTransactionCount() const {
-    return activeTransactions.size();
+    std::lock_guard<std::mutex> lock(mutex);
+    return activeCount;
 }
 
 size_t TransactionManager::getTotalCommittedTransactions() const {
+    std::lock_guard<std::mutex> lock(mutex);
     return totalCommitted;
 }
 
 size_t TransactionManager::getTotalFailedTransactions() const {
+    std::lock_guard<std::mutex> lock(mutex);
     return totalFailed;
 }
+
+size_t TransactionManager::getTotalConflicts() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalConflicts;
+}
+
+// Randomised exponential backoff so conflicting retries stop colliding
+void TransactionManager::backoff(int attempt) {
+    if (attempt <= 2) {
+        std::this_thread::yield();
+        return;
+    }
+    thread_local std::minstd_rand rng(std::random_device{}());
+    const int ceilingUs = 1 << std::min(attempt, 10);
+    std::this_thread::sleep_for(std::chrono::microseconds(rng() % ceilingUs + 1));
+}
+
+bool TransactionManager::enableWriteAheadLog(const std::string& path,
+                                             std::chrono::microseconds groupCommitWindow,
+                                             const WriteAheadLog::ChangeHandler& redo,
+                                             const WriteAheadLog::ChangeHandler& undo,
+                                             WalRecoveryStats* stats) {
+    wal.setGroupCommitWindow(groupCommitWindow);
+    return wal.open(path, redo, undo, stats);
+}
+
+void TransactionManager::disableWriteAheadLog() {
+    wal.close();
+}
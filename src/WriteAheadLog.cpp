@@ -0,0 +1,257 @@
+#include "WriteAheadLog.h"
+#include "BinaryLog.h"
+#include "Logger.h"
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char WAL_MAGIC[8] = {'R', 'M', 'S', 'W', 'A', 'L', '0', '1'};
+
+thread_local std::string scratch;   // Record body under construction
+
+void putBytes(std::string& out, std::string_view bytes) {
+    BinaryLog::putVarint(out, bytes.size());
+    out.append(bytes.data(), bytes.size());
+}
+
+bool getBytes(const char* data, std::size_t size, std::size_t& pos, std::string_view& bytes) {
+    std::uint64_t len;
+    if (!BinaryLog::getVarint(data, size, pos, len) || len > size - pos) return false;
+    bytes = std::string_view(data + pos, static_cast<std::size_t>(len));
+    pos += static_cast<std::size_t>(len);
+    return true;
+}
+
+bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// The log stays as it is so the next open() replays it again
+bool recoveryFailed(const std::string& logPath, const char* step, const WalChange& change) {
+    Logger::log(LogLevel::ERROR, "WriteAheadLog: Could not " + std::string(step) + " " +
+                                 std::string(change.resource) + " change of transaction " +
+                                 std::to_string(change.transactionId) + "; keeping " + logPath);
+    return false;
+}
+
+} // namespace
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open(const std::string& logPath, const ChangeHandler& redo, const ChangeHandler& undo,
+                         WalRecoveryStats* stats) {
+    if (isOpen()) return true;
+
+    // Handlers run before the log accepts appends, with no lock held
+    WalRecoveryStats recovered;
+    if (!recover(logPath, redo, undo, recovered)) return false;
+    if (stats) *stats = recovered;
+
+    std::error_code ec;
+    const fs::path parent = fs::path(logPath).parent_path();
+    if (!parent.empty()) fs::create_directories(parent, ec);
+
+    const int newFd = ::open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (newFd < 0) {
+        Logger::log(LogLevel::ERROR, "WriteAheadLog: Cannot open " + logPath + ": " + std::strerror(errno));
+        return false;
+    }
+    if (!writeAll(newFd, WAL_MAGIC, sizeof(WAL_MAGIC)) || ::fdatasync(newFd) != 0) {
+        Logger::log(LogLevel::ERROR, "WriteAheadLog: Cannot initialise " + logPath + ": " + std::strerror(errno));
+        ::close(newFd);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    path = logPath;
+    fd = newFd;
+    pending.clear();
+    appendedPosition = durablePosition = sizeof(WAL_MAGIC);
+    failed = false;
+    accepting.store(true, std::memory_order_release);
+    LOGF_INFO("WriteAheadLog: Opened ", logPath, " (recovered ", recovered.committed, " committed, ",
+              recovered.incomplete, " incomplete transactions)");
+    return true;
+}
+
+bool WriteAheadLog::recover(const std::string& logPath, const ChangeHandler& redo, const ChangeHandler& undo,
+                            WalRecoveryStats& stats) {
+    std::error_code ec;
+    if (!fs::exists(logPath, ec) || fs::file_size(logPath, ec) == 0) return true;
+
+    MappedFile file;
+    if (!file.openReadOnly(logPath)) return false;
+    if (file.size() < sizeof(WAL_MAGIC) || std::memcmp(file.data(), WAL_MAGIC, sizeof(WAL_MAGIC)) != 0) {
+        Logger::log(LogLevel::ERROR, "WriteAheadLog: " + logPath + " is not a transaction log");
+        return false;
+    }
+
+    struct Record {
+        Kind kind;
+        WalChange change;
+    };
+    std::vector<Record> records;
+    std::unordered_map<std::uint64_t, Kind> outcomes;
+    BinaryLog::scanFrames(file.data(), sizeof(WAL_MAGIC), file.size(), [&](const char* body, std::uint32_t len) {
+        std::size_t pos = 1;
+        Record record{static_cast<Kind>(body[0]), WalChange{}};
+        if (!BinaryLog::getVarint(body, len, pos, record.change.transactionId)) return false;
+        if (record.kind == CHANGE) {
+            if (!getBytes(body, len, pos, record.change.resource) ||
+                !getBytes(body, len, pos, record.change.redo) ||
+                !getBytes(body, len, pos, record.change.undo)) {
+                return false;
+            }
+            records.push_back(record);
+        } else if (record.kind == COMMIT || record.kind == ABORT) {
+            outcomes[record.change.transactionId] = record.kind;
+        } else {
+            return false;
+        }
+        return true;
+    });
+
+    // Redo committed work in log order, collect the rest for undo
+    std::vector<const WalChange*> toUndo;
+    std::unordered_map<std::uint64_t, bool> incomplete;
+    for (const auto& record : records) {
+        const auto it = outcomes.find(record.change.transactionId);
+        if (it == outcomes.end()) {
+            toUndo.push_back(&record.change);
+            incomplete.emplace(record.change.transactionId, true);
+        } else if (it->second == COMMIT) {
+            if (redo && !redo(record.change)) return recoveryFailed(logPath, "redo", record.change);
+            stats.redone++;
+        }
+    }
+    for (auto it = toUndo.rbegin(); it != toUndo.rend(); ++it) {
+        if (undo && !undo(**it)) return recoveryFailed(logPath, "undo", **it);
+        stats.undone++;
+    }
+    for (const auto& outcome : outcomes) {
+        if (outcome.second == COMMIT) stats.committed++;
+    }
+    stats.incomplete = incomplete.size();
+    return true;
+}
+
+void WriteAheadLog::close() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (fd < 0) return;
+    accepting.store(false, std::memory_order_release);
+    durableCv.wait(lock, [this] { return !flushing; });
+
+    if (!pending.empty() && !failed) {
+        if (writeAll(fd, pending.data(), pending.size()) && ::fdatasync(fd) == 0) {
+            durablePosition = appendedPosition;
+        } else {
+            Logger::log(LogLevel::ERROR, "WriteAheadLog: Final flush of " + path + " failed: " + std::strerror(errno));
+        }
+    }
+    pending.clear();
+    ::close(fd);
+    fd = -1;
+    durableCv.notify_all();
+}
+
+void WriteAheadLog::setGroupCommitWindow(std::chrono::microseconds window) {
+    std::lock_guard<std::mutex> lock(mutex);
+    groupCommitWindow = window;
+}
+
+std::uint64_t WriteAheadLog::appendRecord(const std::string& body) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd < 0) return 0;
+    BinaryLog::appendFrame(pending, body);
+    appendedPosition += BinaryLog::FRAME_HEADER + body.size();
+    return appendedPosition;
+}
+
+std::uint64_t WriteAheadLog::appendChange(std::uint64_t transactionId, std::string_view resource,
+                                          std::string_view redo, std::string_view undo) {
+    if (!isOpen()) return 0;
+    scratch.clear();
+    scratch += static_cast<char>(CHANGE);
+    BinaryLog::putVarint(scratch, transactionId);
+    putBytes(scratch, resource);
+    putBytes(scratch, redo);
+    putBytes(scratch, undo);
+    return appendRecord(scratch);
+}
+
+bool WriteAheadLog::commit(std::uint64_t transactionId) {
+    if (!isOpen()) return false;
+    scratch.clear();
+    scratch += static_cast<char>(COMMIT);
+    BinaryLog::putVarint(scratch, transactionId);
+    const std::uint64_t position = appendRecord(scratch);
+    if (position == 0 || !flush(position)) return false;
+    commits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void WriteAheadLog::abort(std::uint64_t transactionId) {
+    if (!isOpen()) return;
+    scratch.clear();
+    scratch += static_cast<char>(ABORT);
+    BinaryLog::putVarint(scratch, transactionId);
+    appendRecord(scratch);
+}
+
+// Group commit: whoever finds no flush in progress writes the whole
+// pending buffer; commits that arrive meanwhile wait for the next round
+bool WriteAheadLog::flush(std::uint64_t position) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (durablePosition < position) {
+        if (failed || fd < 0) return false;
+        if (flushing) {
+            durableCv.wait(lock);
+            continue;
+        }
+
+        flushing = true;
+        if (groupCommitWindow.count() > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(groupCommitWindow);
+            lock.lock();
+        }
+        writing.swap(pending);
+        const std::uint64_t target = appendedPosition;
+        lock.unlock();
+
+        const bool ok = writeAll(fd, writing.data(), writing.size()) && ::fdatasync(fd) == 0;
+        const int error = errno;
+
+        lock.lock();
+        writing.clear();
+        flushing = false;
+        if (ok) {
+            durablePosition = target;
+            syncs.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            failed = true;
+            Logger::log(LogLevel::ERROR, "WriteAheadLog: Flush of " + path + " failed: " + std::strerror(error));
+        }
+        durableCv.notify_all();
+    }
+    return true;
+}
@@ -13,12 +13,28 @@
 #include "BusinessRules.h"
 #include "ServiceLocator.h"
 #include "EventSystem.h"
+#include "EventLog.h"
 #include "IdempotencyService.h"
+#include "BloomFilter.h"
+#include "TimingWheel.h"
 #include "SnapshotManager.h"
 #include "CommandPattern.h"
 #include "ValidationDSL.h"
+#include "TransactionManager.h"
+#include "StorageStrategy.h"
+#include "CachingStorageStrategy.h"
+#include "HealthService.h"
+#include "CsvReader.h"
+#include "OrderCommandService.h"
+#include "OrderQueryService.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <thread>
 
 // ============================================================================
 // Test Infrastructure
@@ -120,10 +136,238 @@ void testEventSystem() {
     
     assertTrue("Event system emits without exception", true);
     
+    const EventSourceId source = EventSources::intern("OrderService");
+    assertTrue("Event sources are interned once", source != 0 && EventSources::intern("OrderService") == source &&
+                                                  std::string(EventSources::name(source)) == "OrderService");
+    
     extern void cleanupEventListeners();
     cleanupEventListeners();
 }
 
+class CountingListener : public EventListener {
+public:
+    int calls = 0;
+    void onEvent(const Event&) override { calls++; }
+    std::string getName() const override { return "CountingListener"; }
+};
+
+void testTypedEventSubscription() {
+    std::cout << "\n[TEST SUITE] Typed Event Subscription\n";
+    
+    EventBus& bus = EventBus::getInstance();
+    CountingListener orderListener;
+    CountingListener inventoryListener;
+    bus.subscribe(EventType::ORDER_PLACED, &orderListener);
+    bus.subscribe(EventType::INVENTORY_LOW, &inventoryListener);
+    
+    Event evt;
+    evt.type = EventType::ORDER_PLACED;
+    evt.timestamp = std::time(nullptr);
+    bus.emit(evt);
+    
+    assertTrue("ORDER_PLACED reaches order listener", orderListener.calls == 1);
+    assertTrue("ORDER_PLACED skips inventory listener", inventoryListener.calls == 0);
+    assertTrue("Event names come from constexpr table", 
+        std::string(eventTypeName(EventType::INVENTORY_LOW)) == "INVENTORY_LOW");
+    
+    bus.unsubscribe(&orderListener);
+    bus.unsubscribe(&inventoryListener);
+    bus.emit(evt);
+    assertTrue("Unsubscribed listener no longer called", orderListener.calls == 1);
+}
+
+void testAsyncEventDispatch() {
+    std::cout << "\n[TEST SUITE] Async Event Dispatch\n";
+    
+    EventBus& bus = EventBus::getInstance();
+    CountingListener asyncListener;
+    bus.subscribe(EventType::ORDER_PLACED, &asyncListener, DispatchMode::ASYNC, 16);
+    
+    Event evt;
+    evt.type = EventType::ORDER_PLACED;
+    evt.timestamp = std::time(nullptr);
+    for (int i = 0; i < 100; ++i) bus.emit(evt);
+    bus.drainAsync();
+    
+    assertTrue("Async listener receives every event after drain", asyncListener.calls == 100);
+    
+    auto stats = bus.getQueueStats();
+    assertTrue("Queue stats reported for async listener", stats.size() == 1 && stats[0].processed == 100);
+    assertTrue("Queue depth is zero after drain", bus.getQueuedEventCount() == 0);
+    
+    bus.unsubscribe(&asyncListener);
+    assertTrue("Async queue removed on unsubscribe", bus.getQueueStats().empty());
+}
+
+class AtomicCountingListener : public EventListener {
+public:
+    std::atomic<int> calls{0};
+    void onEvent(const Event&) override { calls.fetch_add(1, std::memory_order_relaxed); }
+    std::string getName() const override { return "AtomicCountingListener"; }
+};
+
+void testConcurrentEventBus() {
+    std::cout << "\n[TEST SUITE] Concurrent EventBus Access\n";
+    
+    EventBus& bus = EventBus::getInstance();
+    AtomicCountingListener stable;
+    bus.subscribe(EventType::ORDER_SERVED, &stable);
+    
+    Event evt;
+    evt.type = EventType::ORDER_SERVED;
+    evt.timestamp = std::time(nullptr);
+    
+    // Emit from several threads while another thread churns subscriptions
+    std::atomic<bool> done{false};
+    std::thread churn([&] {
+        while (!done.load()) {
+            AtomicCountingListener transient;
+            bus.subscribe(EventType::ORDER_SERVED, &transient);
+            bus.unsubscribe(&transient);   // Must not be called after this returns
+        }
+    });
+    std::vector<std::thread> emitters;
+    for (int t = 0; t < 4; ++t) {
+        emitters.emplace_back([&] { for (int i = 0; i < 1000; ++i) bus.emit(evt); });
+    }
+    for (auto& th : emitters) th.join();
+    done.store(true);
+    churn.join();
+    
+    assertTrue("Stable listener sees every concurrent emit", stable.calls.load() == 4000);
+    
+    bus.unsubscribe(&stable);
+    assertTrue("Listener table empty after concurrent churn", bus.getListenerCount(EventType::ORDER_SERVED) == 0);
+}
+
+class BatchCountingListener : public EventListener {
+public:
+    int batches = 0;
+    int events = 0;
+    int lastQuantityOf7 = -1;
+    void onEvent(const Event&) override { events++; }
+    bool acceptsBatches() const override { return true; }
+    void onEventBatch(const Event* batch, std::size_t count) override {
+        batches++;
+        for (std::size_t i = 0; i < count; ++i) {
+            events++;
+            if (batch[i].entityId == 7) lastQuantityOf7 = std::get<InventoryPayload>(batch[i].payload).quantity;
+        }
+    }
+    std::string getName() const override { return "BatchCountingListener"; }
+};
+
+// Emits 40 more distinct updates from inside its first batch
+class ReemittingListener : public BatchCountingListener {
+public:
+    void onEventBatch(const Event* batch, std::size_t count) override {
+        BatchCountingListener::onEventBatch(batch, count);
+        if (batches > 1) return;
+        for (int i = 0; i < 40; ++i) {
+            EventBus::getInstance().emit(Event{EventType::INVENTORY_UPDATED, EntityType::INVENTORY, 0, 1000 + i,
+                                               std::time(nullptr), InventoryPayload{i, 10}});
+        }
+    }
+    std::string getName() const override { return "ReemittingListener"; }
+};
+
+void testEventCoalescing() {
+    std::cout << "\n[TEST SUITE] Event Coalescing\n";
+    
+    EventBus& bus = EventBus::getInstance();
+    bus.setCoalescing(EventType::INVENTORY_UPDATED, 1000, std::chrono::milliseconds(1000));
+    BatchCountingListener batchListener;
+    CountingListener plainListener;
+    bus.subscribe(EventType::INVENTORY_UPDATED, &batchListener);
+    bus.subscribe(EventType::INVENTORY_UPDATED, &plainListener);
+    
+    // 5000 updates over 100 items inside one bulk operation
+    {
+        EventBus::BatchScope batch(bus);
+        for (int i = 0; i < 5000; ++i) {
+            Event evt{EventType::INVENTORY_UPDATED, EntityType::INVENTORY, 0, i % 100, std::time(nullptr),
+                      InventoryPayload{i, 10}};
+            bus.emit(evt);
+        }
+        assertTrue("Coalesced events held while batch scope is open", batchListener.batches == 0);
+    }
+    
+    assertTrue("Batch listener gets one span at scope end", batchListener.batches == 1);
+    assertTrue("Events collapsed per entityId", batchListener.events == 100);
+    assertTrue("Latest update per entity wins", batchListener.lastQuantityOf7 == 4907);
+    assertTrue("Non-batch listener still sees every event", plainListener.calls == 5000);
+    
+    // Still pending when coalescing is switched off
+    for (int i = 0; i < 10; ++i) {
+        Event evt{EventType::INVENTORY_UPDATED, EntityType::INVENTORY, 0, i, std::time(nullptr),
+                  InventoryPayload{i, 10}};
+        bus.emit(evt);
+    }
+    bus.disableCoalescing(EventType::INVENTORY_UPDATED);
+    assertTrue("Pending events reach batch listener on disable", batchListener.events == 110);
+    assertTrue("Non-batch listener gets no duplicates on disable", plainListener.calls == 5010);
+    
+    bus.unsubscribe(&batchListener);
+    bus.unsubscribe(&plainListener);
+    
+    // A batch listener emitting more than the slot table holds, mid-delivery
+    bus.setCoalescing(EventType::INVENTORY_UPDATED, 4, std::chrono::milliseconds(1000));
+    ReemittingListener reemitter;
+    bus.subscribe(EventType::INVENTORY_UPDATED, &reemitter);
+    for (int i = 0; i < 4; ++i) {
+        bus.emit(Event{EventType::INVENTORY_UPDATED, EntityType::INVENTORY, 0, i, std::time(nullptr),
+                       InventoryPayload{i, 10}});
+    }
+    assertTrue("Re-entrant emits delivered after the outer batch",
+               reemitter.batches == 2 && reemitter.events == 44);
+    bus.unsubscribe(&reemitter);
+    bus.disableCoalescing(EventType::INVENTORY_UPDATED);
+}
+
+void testEventLog() {
+    std::cout << "\n[TEST SUITE] Persistent Event Log\n";
+    
+    const std::string dir = "data/test_eventlog";
+    std::filesystem::remove_all(dir);
+    EventLog& log = EventLog::getInstance();
+    assertTrue("Event log opens", log.open(dir, 64 * 1024, 1));
+    
+    const EventSourceId source = EventSources::intern("OrderService");
+    Event evt{EventType::ORDER_PLACED, EntityType::ORDER, source, 7, std::time(nullptr), OrderPayload{101, 24.5}};
+    for (int i = 0; i < 1000; ++i) log.append(evt);   // Spans several 64 KB segments
+    log.sync();
+    assertTrue("Durable sequence catches up after sync", log.getDurableSequence() == 1000);
+    log.close();
+    
+    // Reopen: sequence numbers continue after recovery
+    log.open(dir, 64 * 1024, 1);
+    evt.entityId = 8;
+    assertTrue("Sequence continues after reopen", log.append(evt) == 1001);
+    
+    int seen = 0;
+    bool intact = true;
+    log.replay(995, [&](std::uint64_t seq, const Event& e) {
+        ++seen;
+        const auto* order = std::get_if<OrderPayload>(&e.payload);
+        intact = intact && e.type == EventType::ORDER_PLACED && e.source == source &&
+                 order && order->customerId == 101 && order->amount == 24.5 &&
+                 e.entityId == (seq == 1001 ? 8 : 7);
+    });
+    assertTrue("Replay from sequence delivers the tail", seen == 7 && intact);
+    
+    CountingListener counter;
+    EventBus::getInstance().subscribe(&counter);
+    EventBus::getInstance().subscribe(&log);
+    assertTrue("Replay into bus reaches listeners", log.replay(1, EventBus::getInstance()) == 1001 &&
+                                                    counter.calls == 1001);
+    assertTrue("Replayed events are not re-appended", log.getLastSequence() == 1001);
+    EventBus::getInstance().unsubscribe(&log);
+    EventBus::getInstance().unsubscribe(&counter);
+    
+    log.close();
+    std::filesystem::remove_all(dir);
+}
+
 void testIdempotencyService() {
     std::cout << "\n[TEST SUITE] Idempotent Operations\n";
     
@@ -146,6 +390,245 @@ void testIdempotencyService() {
         cached.find("OrderID=1") != std::string::npos);
 }
 
+void testConcurrentIdempotency() {
+    std::cout << "\n[TEST SUITE] Concurrent Idempotency Registry\n";
+    
+    const int threads = 8;
+    const int perThread = 2000;
+    const int before = IdempotencyService::getTrackedCount();
+    std::atomic<int> firstSeen{0};
+    std::atomic<int> badResults{0};
+    
+    // Every thread races over the same key range: each key must be claimed once
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::string cached;
+            for (int i = 0; i < perThread; ++i) {
+                const int key = (i * 7 + t * 131) % perThread;
+                const std::string requestId = "conc-req-" + std::to_string(key);
+                if (!IdempotencyService::isDuplicate(requestId, cached)) {
+                    IdempotencyService::recordSuccess(requestId, "place_order",
+                                                      "OrderID=" + std::to_string(key));
+                    firstSeen.fetch_add(1);
+                } else if (cached != "OrderID=" + std::to_string(key)) {
+                    badResults.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    
+    assertTrue("All keys tracked once", IdempotencyService::getTrackedCount() - before == perThread);
+    assertTrue("Every key recorded at least once", firstSeen.load() >= perThread);
+    assertTrue("Cached results never cross keys", badResults.load() == 0);
+    
+    IdempotencyRecord* record = IdempotencyService::getRecord("conc-req-42");
+    assertTrue("Record lookup by ID", record && record->resultData == "OrderID=42" && record->succeeded);
+    assertTrue("Unknown ID has no record", IdempotencyService::getRecord("conc-req-missing") == nullptr);
+}
+
+void testIdempotencyExpiry() {
+    std::cout << "\n[TEST SUITE] Idempotency TTL Expiry\n";
+    
+    // Wheel fires each entry on its deadline second, across every level
+    TimingWheel wheel;
+    const std::time_t start = 1700000000;
+    wheel.advance(start, [](std::uint32_t, std::time_t) {});
+    const std::time_t deadlines[] = {start - 5, start + 1, start + 63, start + 64, start + 4100,
+                                     start + 300000, start + 20000000};
+    for (std::uint32_t i = 0; i < 7; ++i) wheel.schedule(i, deadlines[i]);
+    
+    bool onTime = true;
+    std::size_t fired = wheel.advance(start, [&](std::uint32_t id, std::time_t) { onTime = onTime && id == 0; });
+    for (std::time_t now = start + 1; wheel.size() > 0 && now <= start + 20000000; now += 1) {
+        fired += wheel.advance(now, [&](std::uint32_t id, std::time_t deadline) {
+            onTime = onTime && deadline == deadlines[id] && deadline == now;
+        });
+    }
+    assertTrue("Timing wheel fires every entry", fired == 7 && wheel.size() == 0);
+    assertTrue("Timing wheel fires on the deadline", onTime);
+    
+    // Records past their TTL are reclaimed without touching live ones
+    const int before = IdempotencyService::getTrackedCount();
+    IdempotencyService::setDefaultTTL(-1);
+    IdempotencyService::recordSuccess("expiry-req-1", "place_order", "OrderID=9");
+    IdempotencyService::recordSuccess("expiry-req-2", "place_order", "OrderID=10");
+    IdempotencyService::setDefaultTTL(86400);
+    IdempotencyService::recordSuccess("expiry-req-live", "place_order", "OrderID=11");
+    
+    std::string cached;
+    assertFalse("Expired request is not duplicate", IdempotencyService::isDuplicate("expiry-req-1", cached));
+    IdempotencyService::cleanupExpired();
+    assertTrue("Expired records reclaimed", IdempotencyService::getTrackedCount() - before == 1);
+    assertTrue("Live record kept", IdempotencyService::isDuplicate("expiry-req-live", cached) &&
+                                   cached == "OrderID=11");
+}
+
+void testIdempotencyFilter() {
+    std::cout << "\n[TEST SUITE] Idempotency Fast-Negative Filter\n";
+    
+    IdempotencyService::configureFilter(20000, 0.01);
+    for (int i = 0; i < 2000; ++i) {
+        IdempotencyService::recordSuccess("filter-req-" + std::to_string(i), "place_order", "OK");
+    }
+    
+    std::string cached;
+    bool allFound = true;
+    for (int i = 0; i < 2000; ++i) {
+        allFound = allFound && IdempotencyService::isDuplicate("filter-req-" + std::to_string(i), cached);
+    }
+    assertTrue("Filter never hides a recorded request", allFound);
+    
+    const IdempotencyFilterStats before = IdempotencyService::getFilterStats();
+    for (int i = 0; i < 10000; ++i) {
+        IdempotencyService::isDuplicate("filter-new-" + std::to_string(i), cached);
+    }
+    const IdempotencyFilterStats after = IdempotencyService::getFilterStats();
+    const std::uint64_t newAnswered = after.definitelyNew - before.definitelyNew;
+    const std::uint64_t wrong = after.falsePositives - before.falsePositives;
+    assertTrue("New requests answered by the filter", newAnswered + wrong == 10000 && newAnswered > 9500);
+    assertTrue("False-positive rate reported", after.falsePositiveRate() < 0.05 && after.memoryBytes > 0);
+    
+    // Removing a key (as expiry does) clears it from the filter again
+    CountingBloomFilter filter(100, 0.01);
+    const std::uint64_t hash = IdempotencyService::hashRequestId("filter-expiring");
+    filter.add(hash);
+    filter.add(hash);
+    filter.remove(hash);
+    assertTrue("Counting filter keeps a key added twice", filter.mayContain(hash));
+    filter.remove(hash);
+    assertFalse("Counting filter forgets a removed key", filter.mayContain(hash));
+}
+
+void testIdempotencyPersistence() {
+    std::cout << "\n[TEST SUITE] Durable Idempotency Store\n";
+    
+    const std::string dir = "test_idempotency_store";
+    const std::string path = dir + "/idempotency.log";
+    std::filesystem::remove_all(dir);
+    auto ignore = [](const IdempotencyStore::RecordView&) {};
+    const std::time_t now = std::time(nullptr);
+    
+    // Write as the previous process would have
+    {
+        IdempotencyStore store;
+        assertTrue("Store opens", store.open(path, 64 * 1024, ignore));
+        for (int i = 0; i < 100; ++i) {
+            store.append({"durable-req-" + std::to_string(i), "place_order", true, "OrderID=1", now, 86400});
+        }
+        store.append({"durable-req-7", "place_order", true, "OrderID=7", now, 86400});      // Supersedes
+        store.append({"durable-req-expired", "place_order", true, "OrderID=0", now - 100, 10});
+        store.close();
+    }
+    
+    // Reopen: one sequential pass sees every record in write order
+    {
+        IdempotencyStore store;
+        int seen = 0;
+        std::string last7;
+        store.open(path, 64 * 1024, [&](const IdempotencyStore::RecordView& view) {
+            ++seen;
+            if (view.requestId == "durable-req-7") last7 = std::string(view.resultData);
+        });
+        assertTrue("Reopen replays all records", seen == 102 && last7 == "OrderID=7");
+        
+        const std::size_t before = store.getUsedBytes();
+        assertTrue("Compaction reclaims superseded and expired records",
+                   store.compact(now) > 0 && store.getUsedBytes() < before);
+        store.close();
+        
+        IdempotencyStore reopened;
+        seen = 0;
+        bool expiredKept = false;
+        reopened.open(path, 64 * 1024, [&](const IdempotencyStore::RecordView& view) {
+            ++seen;
+            expiredKept = expiredKept || view.requestId == "durable-req-expired";
+        });
+        assertTrue("Compacted log keeps one live record per ID", seen == 100 && !expiredKept);
+    }
+    
+    // A full store remaps larger; superseded records wait for compaction
+    {
+        IdempotencyStore store;
+        store.open(dir + "/grow.log", 4096, ignore);
+        bool appended = true;
+        for (int i = 0; i < 2000; ++i) {
+            appended = store.append({"grow-req", "place_order", true, "OrderID=" + std::to_string(i), now, 86400}) &&
+                       appended;
+        }
+        assertTrue("Full store grows without compacting", appended && store.getUsedBytes() > 2000 * 30);
+    }
+    
+    // Startup: the registry is rebuilt from the log
+    assertTrue("Persistence enabled", IdempotencyService::enablePersistence(path, 64 * 1024));
+    std::string cached;
+    assertTrue("Request from before restart is duplicate",
+               IdempotencyService::isDuplicate("durable-req-7", cached) && cached == "OrderID=7");
+    assertFalse("Expired request not restored", IdempotencyService::isDuplicate("durable-req-expired", cached));
+    
+    IdempotencyService::recordSuccess("durable-req-new", "process_payment", "TxnID=42");
+    IdempotencyService::disablePersistence();
+    bool newLogged = false;
+    {
+        IdempotencyStore store;
+        store.open(path, 64 * 1024, [&](const IdempotencyStore::RecordView& view) {
+            newLogged = newLogged || (view.requestId == "durable-req-new" && view.resultData == "TxnID=42");
+        });
+    }
+    assertTrue("New outcomes are appended", newLogged);
+    std::filesystem::remove_all(dir);
+}
+
+void testSingleFlightRequests() {
+    std::cout << "\n[TEST SUITE] Single-Flight Request Coalescing\n";
+    
+    // One owner runs; concurrent retries wait for its result
+    std::atomic<int> owners{0};
+    std::atomic<int> sharedResults{0};
+    std::vector<std::thread> retries;
+    for (int i = 0; i < 6; ++i) {
+        retries.emplace_back([&] {
+            IdempotencyClaim claim = IdempotencyService::claim("flight-req-1");
+            if (claim.owner) {
+                owners.fetch_add(1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));   // The real work
+                IdempotencyService::recordSuccess("flight-req-1", "create_order", "OrderID=ORD-1");
+                return;
+            }
+            const IdempotencyOutcome outcome = claim.result.get();
+            if (outcome.status == IdempotencyOutcome::Status::SUCCEEDED && outcome.resultData == "OrderID=ORD-1") {
+                sharedResults.fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : retries) t.join();
+    assertTrue("Exactly one caller runs the operation", owners.load() == 1);
+    assertTrue("Retries receive the first result", sharedResults.load() == 5);
+    
+    IdempotencyClaim late = IdempotencyService::claim("flight-req-1");
+    assertTrue("Finished request resolves at once",
+               !late.owner && late.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    
+    // An abandoned claim lets a waiter take over
+    IdempotencyClaim first = IdempotencyService::claim("flight-req-2");
+    IdempotencyClaim second = IdempotencyService::claim("flight-req-2");
+    assertTrue("Second caller waits", first.owner && !second.owner &&
+               second.result.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+    IdempotencyService::abandonRequest("flight-req-2");
+    assertTrue("Waiter sees abandonment", second.result.get().status == IdempotencyOutcome::Status::ABANDONED);
+    assertTrue("Abandoned request can be claimed again", IdempotencyService::claim("flight-req-2").owner);
+    IdempotencyClaim waiter = IdempotencyService::claim("flight-req-2");
+    IdempotencyService::recordFailure("flight-req-2", "create_order");
+    assertTrue("Waiter sees the failure", waiter.result.get().status == IdempotencyOutcome::Status::FAILED);
+    
+    // A retry after a failure runs the operation again
+    IdempotencyClaim retry = IdempotencyService::claim("flight-req-2");
+    assertTrue("Failed request is claimed again", retry.owner);
+    IdempotencyService::recordSuccess("flight-req-2", "create_order", "OrderID=ORD-2");
+    assertTrue("Retry's success is kept", !IdempotencyService::claim("flight-req-2").owner);
+}
+
 void testSoftDelete() {
     std::cout << "\n[TEST SUITE] Soft Delete System\n";
     
@@ -240,6 +723,786 @@ void testValidationDSL() {
 // Order Lifecycle Tests
 // ============================================================================
 
+void testTransactionManager() {
+    std::cout << "\n[TEST SUITE] Pooled Transactions\n";
+    
+    auto& tm = TransactionManager::instance();
+    const size_t committedBefore = tm.getTotalCommittedTransactions();
+    const size_t failedBefore = tm.getTotalFailedTransactions();
+    
+    // Rollbacks run LIFO, including ones past the inline operation capacity
+    std::vector<int> undone;
+    Transaction* failing = tm.createTransaction();
+    failing->begin();
+    for (int i = 0; i < 6; ++i) {
+        failing->execute([] {}, [&undone, i] { undone.push_back(i); });
+    }
+    try {
+        failing->execute([] { throw std::runtime_error("inventory"); });
+    } catch (const std::exception&) {}
+    failing->commit();
+    assertTrue("Failed transaction rolls back in reverse order",
+               undone == std::vector<int>({5, 4, 3, 2, 1, 0}));
+    assertTrue("Failure message kept", failing->getErrorMessage().find("inventory") != std::string::npos);
+    
+    // Removal from the middle of the active list; slots are reused clean
+    Transaction* a = tm.createTransaction();
+    Transaction* b = tm.createTransaction();
+    Transaction* c = tm.createTransaction();
+    assertTrue("Active count tracks created transactions", tm.getActiveTransactionCount() == 4);
+    tm.removeTransaction(failing);
+    b->begin();
+    b->execute([] {});
+    b->commit();
+    tm.removeTransaction(b);
+    Transaction* reused = tm.createTransaction();
+    assertTrue("Pool reuses released transactions", reused == b || reused == failing);
+    assertTrue("Reused transaction starts fresh",
+               reused->getState() == Transaction::State::READY && reused->getOperationCount() == 0 &&
+               reused->getErrorMessage().empty());
+    tm.removeTransaction(a);
+    tm.removeTransaction(c);
+    tm.removeTransaction(reused);
+    assertTrue("Active list empties", tm.getActiveTransactionCount() == 0);
+    assertTrue("Outcomes counted", tm.getTotalCommittedTransactions() == committedBefore + 1 &&
+                                   tm.getTotalFailedTransactions() == failedBefore + 4);
+}
+
+void testWriteAheadLog() {
+    std::cout << "\n[TEST SUITE] Transaction Write-Ahead Log\n";
+    
+    const std::string dir = "test_transaction_wal";
+    const std::string path = dir + "/transactions.wal";
+    std::filesystem::remove_all(dir);
+    auto& tm = TransactionManager::instance();
+    assertTrue("WAL opens", tm.enableWriteAheadLog(path, std::chrono::microseconds(0), nullptr, nullptr));
+    
+    // Committed, interrupted and rolled-back transactions
+    Transaction* committed = tm.createTransaction();
+    committed->begin();
+    committed->logChange("order", "create 42", "delete 42");
+    committed->execute([] {});
+    committed->logChange("inventory", "deduct 3", "restore 3");
+    committed->execute([] {});
+    committed->commit();
+    assertTrue("Logged transaction commits", committed->isSuccessful());
+    
+    Transaction* interrupted = tm.createTransaction();
+    interrupted->begin();
+    interrupted->logChange("billing", "charge 42", "refund 42");
+    interrupted->execute([] {});
+    
+    Transaction* rolledBack = tm.createTransaction();
+    rolledBack->begin();
+    rolledBack->logChange("order", "create 43", "delete 43");
+    rolledBack->rollback();
+    
+    // Concurrent commits share fdatasyncs
+    const std::uint64_t syncsBefore = tm.getWriteAheadLog().getSyncCount();
+    std::vector<std::thread> committers;
+    for (int t = 0; t < 4; ++t) {
+        committers.emplace_back([&tm, t] {
+            for (int i = 0; i < 25; ++i) {
+                Transaction* tx = tm.createTransaction();
+                tx->begin();
+                tx->logChange("order", "create " + std::to_string(t * 100 + i), "");
+                tx->commit();
+                tm.removeTransaction(tx);
+            }
+        });
+    }
+    for (auto& t : committers) t.join();
+    assertTrue("At most one sync per commit", tm.getWriteAheadLog().getSyncCount() - syncsBefore <= 100);
+    
+    const std::uint64_t committedId = committed->getId();
+    tm.disableWriteAheadLog();   // The process "dies" with one transaction open
+    tm.removeTransaction(committed);
+    tm.removeTransaction(interrupted);
+    tm.removeTransaction(rolledBack);
+    
+    // Recovery: redo committed work, undo the interrupted transaction only
+    std::vector<std::string> redone, undone;
+    WalRecoveryStats stats;
+    WriteAheadLog recovered;
+    assertTrue("Failed handler keeps the log", !recovered.open(path, nullptr,
+        [](const WalChange&) { return false; }) && !recovered.isOpen());
+    assertTrue("WAL recovers", recovered.open(path,
+        [&](const WalChange& c) {
+            if (c.transactionId == committedId) redone.emplace_back(c.redo);
+            return true;
+        },
+        [&](const WalChange& c) {
+            undone.emplace_back(c.undo);
+            return true;
+        }, &stats));
+    assertTrue("Committed changes redone in order",
+               redone == std::vector<std::string>({"create 42", "deduct 3"}) && stats.redone == 102);
+    assertTrue("Interrupted change undone", undone == std::vector<std::string>({"refund 42"}) &&
+                                            stats.incomplete == 1 && stats.committed == 101);
+    recovered.close();
+    
+    WalRecoveryStats again;
+    assertTrue("Log truncated after recovery", recovered.open(path, nullptr, nullptr, &again) &&
+                                               again.redone == 0 && again.undone == 0);
+    recovered.close();
+    
+    // Order changes recover through OrderCommandService's handlers
+    auto& manager = StorageManager::instance();
+    manager.setStrategy(std::make_unique<CSVStorageStrategy>(dir));
+    const WalChange confirm{9, "order",
+                            "OrderID=77|CustomerID=5|Total=12345.67|Timestamp=1700000000|Priority=2|State=1",
+                            "OrderID=77|CustomerID=5|Total=12345.67|Timestamp=1700000000|Priority=2|State=0"};
+    assertTrue("Order redo stores the logged image", OrderCommandService::redoChange(confirm) &&
+               manager.getStrategy().loadOrder(77).state == OrderState::CONFIRMED &&
+               manager.getStrategy().loadOrder(77).total == 12345.67);
+    assertTrue("Order undo restores the prior image", OrderCommandService::undoChange(confirm) &&
+               manager.getStrategy().loadOrder(77).state == OrderState::CREATED);
+    assertTrue("Unknown resource is not recovered",
+               !OrderCommandService::redoChange(WalChange{9, "billing", "charge 42", "refund 42"}));
+    manager.setStrategy(std::make_unique<CSVStorageStrategy>());
+    std::filesystem::remove_all(dir);
+}
+
+void testOptimisticTransactions() {
+    std::cout << "\n[TEST SUITE] Optimistic Concurrency Control\n";
+    
+    auto& tm = TransactionManager::instance();
+    VersionedTable<int> stock;
+    stock.put(1, 10);
+    
+    // A stale read fails validation; the first committer wins
+    Transaction* slow = tm.createTransaction();
+    Transaction* fast = tm.createTransaction();
+    slow->begin();
+    fast->begin();
+    int seenBySlow = 0, seenByFast = 0;
+    slow->read(stock, 1, seenBySlow);
+    fast->read(stock, 1, seenByFast);
+    fast->write(stock, 1, seenByFast - 1);
+    fast->commit();
+    slow->write(stock, 1, seenBySlow - 2);
+    slow->commit();
+    int current = 0;
+    stock.get(1, current);
+    assertTrue("First committer wins", fast->isSuccessful() && current == 9);
+    assertTrue("Stale reader conflicts", !slow->isSuccessful() && slow->hasConflict());
+    tm.removeTransaction(slow);
+    tm.removeTransaction(fast);
+    
+    // Writes stay private until commit; reads see the transaction's own writes
+    Transaction* tx = tm.createTransaction();
+    tx->begin();
+    tx->write(stock, 2, 5);
+    int own = 0;
+    assertTrue("Own write visible", tx->read(stock, 2, own) && own == 5);
+    assertFalse("Uncommitted write invisible", stock.get(2, current));
+    tx->commit();
+    assertTrue("Committed write installed", stock.get(2, current) && current == 5);
+    tm.removeTransaction(tx);
+    
+    // Concurrent transfers conserve the total
+    VersionedTable<int> accounts;
+    for (int id = 0; id < 4; ++id) accounts.put(id, 1000);
+    std::atomic<int> committed{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 200; ++i) {
+                const int from = (t + i) % 4, to = (t + i + 1) % 4;
+                const bool ok = tm.runOptimistic([&](Transaction& txn) {
+                    int a = 0, b = 0;
+                    txn.read(accounts, from, a);
+                    txn.read(accounts, to, b);
+                    txn.write(accounts, from, a - 1);
+                    txn.write(accounts, to, b + 1);
+                }, 1000);
+                if (ok) committed.fetch_add(1);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    int total = 0;
+    for (int id = 0; id < 4; ++id) {
+        int balance = 0;
+        accounts.get(id, balance);
+        total += balance;
+    }
+    assertTrue("Every transfer commits after retries", committed.load() == 800);
+    assertTrue("Concurrent transfers conserve the total", total == 4000);
+}
+
+void testEntityLocks() {
+    std::cout << "\n[TEST SUITE] Entity Lock Manager\n";
+    
+    auto& tm = TransactionManager::instance();
+    auto& locks = LockManager::instance();
+    const LockWaitStats before = locks.getWaitStats();
+    
+    // Shared locks coexist; an exclusive request waits for both to finish
+    Transaction* readerA = tm.createTransaction();
+    Transaction* readerB = tm.createTransaction();
+    readerA->begin();
+    readerB->begin();
+    assertTrue("Shared locks are compatible", readerA->lock(EntityType::ORDER, 1, LockMode::SHARED) &&
+                                              readerB->lock(EntityType::ORDER, 1, LockMode::SHARED));
+    std::atomic<bool> writerGranted{false};
+    std::thread writer([&] {
+        Transaction* tx = tm.createTransaction();
+        tx->begin();
+        writerGranted = tx->lock(EntityType::ORDER, 1, LockMode::EXCLUSIVE);
+        tx->commit();
+        tm.removeTransaction(tx);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assertFalse("Exclusive lock waits for shared holders", writerGranted.load());
+    readerA->commit();
+    readerB->commit();
+    writer.join();
+    assertTrue("Exclusive lock granted after release", writerGranted.load());
+    tm.removeTransaction(readerA);
+    tm.removeTransaction(readerB);
+    
+    // Timeouts fail the transaction without marking it retryable
+    Transaction* holder = tm.createTransaction();
+    Transaction* impatient = tm.createTransaction();
+    holder->begin();
+    impatient->begin();
+    holder->lock(EntityType::PAYMENT, 2, LockMode::EXCLUSIVE);
+    assertFalse("Lock wait times out",
+                impatient->lock(EntityType::PAYMENT, 2, LockMode::SHARED, std::chrono::milliseconds(20)));
+    assertTrue("Timeout is not a conflict", impatient->getState() == Transaction::State::FAILED &&
+                                            !impatient->hasConflict());
+    impatient->rollback();
+    holder->commit();
+    tm.removeTransaction(holder);
+    tm.removeTransaction(impatient);
+    
+    // Opposite lock orders deadlock; the youngest transaction is aborted
+    Transaction* older = tm.createTransaction();
+    Transaction* younger = tm.createTransaction();
+    older->begin();
+    younger->begin();
+    older->lock(EntityType::ORDER, 10, LockMode::EXCLUSIVE);
+    younger->lock(EntityType::PAYMENT, 10, LockMode::EXCLUSIVE);
+    bool olderGranted = false, youngerGranted = true;
+    std::thread first([&] {
+        olderGranted = older->lock(EntityType::PAYMENT, 10, LockMode::EXCLUSIVE);
+        older->commit();
+    });
+    std::thread second([&] {
+        youngerGranted = younger->lock(EntityType::ORDER, 10, LockMode::EXCLUSIVE);
+        younger->rollback();
+    });
+    size_t victims = 0;
+    for (int i = 0; i < 2000 && victims == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        victims = locks.detectDeadlocks();
+    }
+    first.join();
+    second.join();
+    assertTrue("Deadlock detected", victims == 1);
+    assertTrue("Youngest transaction is the victim", !youngerGranted && younger->hasConflict() && olderGranted);
+    tm.removeTransaction(older);
+    tm.removeTransaction(younger);
+    
+    // Refunds and cancellations of one order run safely in parallel
+    std::atomic<int> succeeded{0};
+    std::vector<std::thread> commands;
+    for (int t = 0; t < 4; ++t) {
+        commands.emplace_back([&, t] {
+            for (int i = 0; i < 20; ++i) {
+                const bool ok = (t + i) % 2 ? IssueRefundCommand(77, 5.0, "test").execute()
+                                            : CancelOrderCommand(77, "test").execute();
+                if (ok) succeeded.fetch_add(1);
+            }
+        });
+    }
+    for (auto& c : commands) c.join();
+    assertTrue("Concurrent refunds/cancels all complete", succeeded.load() == 80);
+    
+    const LockWaitStats after = locks.getWaitStats();
+    assertTrue("Lock waits recorded in the histogram", after.waits > before.waits &&
+                                                       after.deadlocks == before.deadlocks + 1);
+    assertTrue("All locks released", locks.getLockedEntityCount() == 0);
+}
+
+void testCsvStorage() {
+    std::cout << "\n[TEST SUITE] CSV Storage\n";
+    
+    const std::string dir = "test_csv_storage";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    CSVStorageStrategy storage(dir);
+    
+    // Missing files load as empty
+    assertTrue("Missing file loads nothing", storage.loadAllOrders().empty());
+    
+    CustomerRecord customer{};
+    customer.id = 12;
+    customer.name = "Asha";
+    customer.phone = "555-0100";
+    customer.email = "asha@example.com";
+    customer.loyaltyPoints = 40;
+    customer.isActive = true;
+    MenuItem item{31, "Paneer Wrap", "Mains", 8.75};
+    Order order{501, 12, 24.5, 2, 1700000000, OrderState::PREPARING};
+    assertTrue("Entities save", storage.saveCustomer(customer) && storage.saveMenuItem(item) &&
+                                storage.saveOrder(order));
+    
+    const CustomerRecord c = storage.loadCustomer(12);
+    assertTrue("Customer round-trips", c.id == 12 && c.name == "Asha" && c.email == "asha@example.com" &&
+                                       c.loyaltyPoints == 40 && c.isActive);
+    const MenuItem m = storage.loadMenuItem(31);
+    assertTrue("Menu item round-trips", m.name == "Paneer Wrap" && m.category == "Mains" && m.price == 8.75);
+    const Order o = storage.loadOrder(501);
+    assertTrue("Order round-trips", o.customerId == 12 && o.total == 24.5 && o.priority == 2 &&
+                                    o.timestamp == 1700000000 && o.state == OrderState::PREPARING);
+    assertTrue("Unknown ID loads a blank record", storage.loadOrder(999).orderId == 0);
+    
+    // Headers and damaged rows are skipped; CRLF, blank lines and a missing final newline are fine
+    {
+        std::ofstream file(dir + "/orders.txt", std::ios::trunc | std::ios::binary);
+        file << "orderId,customerId,total,state,priority,timestamp\r\n"
+             << "1,7,10.5,0,1,100\r\n"
+             << "\n"
+             << "2,seven,3.0,0,1,100\n"
+             << "3,8,4.25,9,1,100\n"
+             << "4,9,99.99,4,3,200";
+    }
+    const std::vector<Order> orders = storage.loadAllOrders();
+    assertTrue("Only well-formed rows load", orders.size() == 2);
+    assertTrue("CRLF and unterminated rows parse", orders.size() == 2 && orders[0].orderId == 1 &&
+                                                   orders[0].timestamp == 100 && orders[1].orderId == 4 &&
+                                                   orders[1].total == 99.99 && orders[1].timestamp == 200);
+    
+    // Amounts keep every digit, not the stream's default six
+    assertTrue("Large amounts save", storage.saveOrder(Order{502, 12, 12345.67, 1, 1700000000, OrderState::CREATED}) &&
+                                     storage.saveMenuItem(MenuItem{32, "Catering Tray", "Events", 1234.56}));
+    assertTrue("Large amounts round-trip exactly", storage.loadOrder(502).total == 12345.67 &&
+                                                   storage.loadMenuItem(32).price == 1234.56);
+    
+    CsvRow row;
+    const std::string line = "alpha,,a-much-longer-field-spanning-a-vector-block,4\nnext";
+    const char* next = CsvReader::splitLine(line.data(), line.data() + line.size(), row);
+    assertTrue("splitLine splits fields", row.count == 4 && row[1].empty() &&
+                                          row[2] == "a-much-longer-field-spanning-a-vector-block" &&
+                                          std::string(next) == "next");
+    
+    std::filesystem::remove_all(dir);
+}
+
+void testCsvIndex() {
+    std::cout << "\n[TEST SUITE] CSV Primary-Key Index\n";
+    
+    const std::string dir = "test_csv_index";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const int orders = static_cast<int>(CsvIndex::MERGE_MIN) + 500;
+    {
+        CSVStorageStrategy storage(dir);
+        for (int id = 1; id <= orders; ++id) {
+            storage.saveOrder(Order{id, id % 40, 10.0 + id, 1, 1700000000 + id, OrderState::CREATED});
+        }
+        assertTrue("Index file written next to the data", std::filesystem::exists(dir + "/orders.txt.idx"));
+        assertTrue("Point load after a tail merge", storage.loadOrder(1234).total == 1244.0 &&
+                                                    storage.loadOrder(orders).customerId == orders % 40);
+        
+        Order updated{1234, 5, 99.0, 3, 1800000000, OrderState::SERVED};
+        storage.saveOrder(updated);
+        const Order latest = storage.loadOrder(1234);
+        assertTrue("Latest saved row wins", latest.total == 99.0 && latest.state == OrderState::SERVED);
+        assertTrue("Unknown ID not found", storage.loadOrder(orders + 1).orderId == 0);
+        
+        // Bulk loads and scans return the same latest rows, once per ID
+        storage.saveOrder(Order{1, 1, 5.0, 1, 1700000000, OrderState::CREATED});
+        storage.saveOrder(Order{1, 1, 5.0, 1, 1700000000, OrderState::SERVED});
+        const auto all = storage.loadAllOrders();
+        const auto first = std::find_if(all.begin(), all.end(), [](const Order& order) { return order.orderId == 1; });
+        assertTrue("Bulk load keeps one row per ID", all.size() == static_cast<std::size_t>(orders) &&
+                                                     first != all.end() && first->state == OrderState::SERVED);
+        const std::size_t rows = storage.forEachOrder(
+            [](const Order& order) { return order.orderId == 1 || order.orderId == 1234; },
+            [](const Order& order) { return order.state == OrderState::SERVED; });   // A stale row stops the scan
+        assertTrue("Scan skips superseded rows", rows == 2);
+    }
+    
+    // Rows appended behind the index's back are picked up incrementally
+    {
+        std::ofstream file(dir + "/orders.txt", std::ios::app);
+        file << "90001,7,55.5,1,2,1700000000\n";
+    }
+    CSVStorageStrategy reopened(dir);
+    assertTrue("Reopened index sees external appends", reopened.loadOrder(90001).total == 55.5 &&
+                                                       reopened.loadOrder(1234).total == 99.0);
+    
+    // A rewritten (shorter) file and a deleted index are both rebuilt
+    {
+        std::ofstream file(dir + "/orders.txt", std::ios::trunc);
+        file << "7,1,1.5,0,1,100\n";
+    }
+    assertTrue("Shrunken data file triggers a rebuild", reopened.loadOrder(7).total == 1.5 &&
+                                                        reopened.loadOrder(1234).orderId == 0);
+    std::filesystem::remove(dir + "/orders.txt.idx");
+    CSVStorageStrategy fresh(dir);
+    assertTrue("Missing index is rebuilt", fresh.loadOrder(7).total == 1.5);
+    assertTrue("Rebuild on demand", fresh.rebuildIndexes() && fresh.loadOrder(7).customerId == 1);
+    
+    std::filesystem::remove_all(dir);
+}
+
+void testCsvBatchWrites() {
+    std::cout << "\n[TEST SUITE] CSV Batch Writes\n";
+    
+    const std::string dir = "test_csv_batch";
+    const std::string ordersPath = dir + "/orders.txt";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    CSVStorageStrategy storage(dir);
+    
+    std::vector<Order> batch;
+    for (int id = 1; id <= 1000; ++id) batch.push_back(Order{id, id % 9, 2.5 * id, 1, 1700000000, OrderState::CREATED});
+    assertTrue("Batch save flushes by default", storage.saveOrders(batch.data(), batch.size()) &&
+                                                std::filesystem::file_size(ordersPath) > 0);
+    
+    // Buffered: nothing reaches the file until a flush, a lookup or a full buffer
+    CsvWritePolicy policy;
+    policy.flushEachCall = false;
+    policy.bufferBytes = 1 << 20;
+    policy.syncOnFlush = true;
+    storage.setWritePolicy(policy);
+    const auto flushedBytes = std::filesystem::file_size(ordersPath);
+    for (auto& order : batch) order.orderId += 1000;
+    storage.saveOrders(batch.data(), batch.size());
+    storage.saveOrder(Order{5000, 3, 7.25, 2, 1700000001, OrderState::CONFIRMED});
+    assertTrue("Buffered rows stay in memory", std::filesystem::file_size(ordersPath) == flushedBytes);
+    assertTrue("Lookups see buffered rows", storage.loadOrder(1500).total == 1250.0 &&
+                                            storage.loadOrder(5000).customerId == 3);
+    storage.saveOrder(Order{5001, 4, 1.0, 1, 1700000002, OrderState::CREATED});
+    assertTrue("Full scans see buffered rows", storage.loadAllOrders().size() == 2002);
+    
+    policy.bufferBytes = 256;
+    storage.setWritePolicy(policy);
+    const auto beforeOverflow = std::filesystem::file_size(ordersPath);
+    storage.saveOrders(batch.data(), 20);
+    assertTrue("A full buffer flushes on its own", std::filesystem::file_size(ordersPath) > beforeOverflow);
+    assertTrue("Explicit flush", storage.flush() && storage.loadAllOrders().size() == 2002);
+    
+    // A failed flush keeps its rows for the next one
+    std::filesystem::remove_all(dir);
+    storage.saveOrder(Order{6000, 5, 3.5, 1, 1700000003, OrderState::CREATED});
+    assertTrue("Flush fails without its directory", !storage.flush());
+    std::filesystem::create_directories(dir);
+    assertTrue("Rows survive a failed flush", storage.flush() && storage.loadOrder(6000).total == 3.5);
+    
+    std::filesystem::remove_all(dir);
+}
+
+void testLsmStorage() {
+    std::cout << "\n[TEST SUITE] LSM Storage\n";
+    
+    const std::string dir = "test_lsm_storage";
+    std::filesystem::remove_all(dir);
+    LsmOptions options;
+    options.memtableBytes = 8 * 1024;   // Many small runs
+    options.compactionTrigger = 3;
+    {
+        auto lsm = std::make_unique<LSMStorageStrategy>(dir, options);
+        assertTrue("LSM storage opens", lsm->isHealthy());
+        
+        // Every order saved three times; only the last version survives
+        for (int version = 1; version <= 3; ++version) {
+            std::vector<Order> batch;
+            for (int id = 1; id <= 2000; ++id) {
+                batch.push_back(Order{id, id % 30, 1.0 * version, version, 1700000000, OrderState::CREATED});
+            }
+            lsm->saveOrders(batch.data(), batch.size());
+        }
+        for (int id = 1; id <= 2000; id += 2) lsm->deleteOrder(id);
+        assertTrue("Updates replace instead of duplicating", lsm->loadAllOrders().size() == 1000);
+        assertTrue("Latest version loads", lsm->loadOrder(1000).total == 3.0 && lsm->loadOrder(1000).priority == 3);
+        assertTrue("Deleted order is gone", lsm->loadOrder(999).orderId == 0);
+        assertTrue("Large amount round-trips exactly",
+                   lsm->saveOrder(Order{2, 2, 98765.43, 1, 1700000000, OrderState::CREATED}) &&
+                   lsm->loadOrder(2).total == 98765.43);
+        
+        MenuItem item{7, "Masala Dosa", "Mains", 6.5};
+        CustomerRecord customer{};
+        customer.id = 3;
+        customer.name = "Ravi";
+        customer.loyaltyPoints = 12;
+        assertTrue("Other tables save", lsm->saveMenuItem(item) && lsm->saveCustomer(customer));
+        
+        assertTrue("Compaction merges runs", lsm->compact() && lsm->getOrderStats().runs == 1 &&
+                                             lsm->getOrderStats().flushes > 1);
+        assertTrue("Reads unchanged after compaction", lsm->loadOrder(1000).total == 3.0 &&
+                                                       lsm->loadOrder(999).orderId == 0);
+        
+        // Plugs into the storage manager like any other strategy
+        auto& manager = StorageManager::instance();
+        auto previous = manager.getStorageType();
+        manager.setStrategy(std::move(lsm));
+        assertTrue("StorageManager runs on LSM", manager.getStorageType() == "LSM Storage" &&
+                                                 manager.getStrategy().loadMenuItem(7).name == "Masala Dosa");
+        manager.setStrategy(std::make_unique<CSVStorageStrategy>());
+        assertTrue("StorageManager switches back", manager.getStorageType() == previous);
+    }
+    
+    // Reopen: runs and the unflushed log both come back
+    LSMStorageStrategy reopened(dir, options);
+    reopened.saveOrder(Order{5000, 1, 9.5, 1, 1700000000, OrderState::CONFIRMED});
+    assertTrue("Data survives reopen", reopened.loadAllOrders().size() == 1001 &&
+                                       reopened.loadCustomer(3).loyaltyPoints == 12 &&
+                                       reopened.loadOrder(2000).total == 3.0);
+    
+    std::filesystem::remove_all(dir);
+}
+
+void testCsvCompaction() {
+    std::cout << "\n[TEST SUITE] CSV Compaction\n";
+    
+    const std::string dir = "test_csv_compaction";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        CSVStorageStrategy storage(dir);
+        for (int version = 1; version <= 3; ++version) {
+            std::vector<Order> batch;
+            for (int id = 1; id <= 1000; ++id) {
+                batch.push_back(Order{id, id % 20, 1.0 * version, version, 1700000000, OrderState::CREATED});
+            }
+            storage.saveOrders(batch.data(), batch.size());
+        }
+        
+        CustomerRecord kept{};
+        kept.id = 1;
+        kept.name = "Meera";
+        CustomerRecord expired{};
+        expired.id = 2;
+        expired.name = "Old";
+        expired.isActive = false;
+        expired.deletedAt = 1000;   // Long past the retention horizon
+        storage.saveCustomer(kept);
+        storage.saveCustomer(expired);
+        assertTrue("Soft delete appends an inactive version", storage.deleteCustomer(1) &&
+                                                             !storage.loadCustomer(1).isActive &&
+                                                             storage.loadCustomer(1).deletedAt > 0);
+        const auto customers = storage.loadAllCustomers();
+        const std::size_t deletedRows = storage.forEachCustomer(
+            [](const CustomerRecord& customer) { return customer.id == 1; },
+            [](const CustomerRecord& customer) { return !customer.isActive; });
+        assertTrue("Soft-deleted customer listed once before compaction",
+                   customers.size() == 2 && customers[1].id == 1 && !customers[1].isActive && deletedRows == 1);
+        
+        const auto before = std::filesystem::file_size(dir + "/orders.txt");
+        assertTrue("Compaction succeeds", storage.compact());
+        assertTrue("Only the latest versions remain", storage.loadAllOrders().size() == 1000 &&
+                                                      std::filesystem::file_size(dir + "/orders.txt") < before / 2);
+        assertTrue("Point loads follow the rewrite", storage.loadOrder(777).priority == 3 &&
+                                                     storage.loadOrder(1000).total == 3.0);
+        assertTrue("Expired soft delete dropped", storage.loadCustomer(2).id == 0);
+        assertTrue("Recent soft delete kept", storage.loadCustomer(1).id == 1 && !storage.loadCustomer(1).isActive &&
+                                              storage.loadAllCustomers().size() == 1);
+        assertTrue("Stats count the dropped rows", storage.getCompactionStats().rowsDropped == 2000 + 2);
+        
+        // Background rewrites while orders keep changing: nothing saved is lost
+        CsvCompactionOptions options;
+        options.interval = std::chrono::milliseconds(1);
+        options.minBytes = 0;
+        options.growthFactor = 1.0;
+        storage.startCompaction(options);
+        for (int version = 4; version <= 40; ++version) {
+            for (int id = 1; id <= 1000; id += 10) {
+                storage.saveOrder(Order{id, id % 20, 1.0 * version, version, 1700000000, OrderState::CONFIRMED});
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        storage.stopCompaction();
+        assertTrue("Background compaction ran", storage.getCompactionStats().compactions > 0);
+        bool latest = storage.loadAllOrders().size() >= 1000;
+        for (int id = 1; id <= 1000; ++id) {
+            const Order order = storage.loadOrder(id);
+            latest = latest && order.priority == (id % 10 == 1 ? 40 : 3);
+        }
+        assertTrue("Saves during compaction survive", latest);
+    }
+    
+    std::filesystem::remove_all(dir);
+}
+
+void testStreamingQueries() {
+    std::cout << "\n[TEST SUITE] Streaming Queries\n";
+    
+    const std::string dir = "test_streaming";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        auto csv = std::make_unique<CSVStorageStrategy>(dir);
+        std::vector<Order> batch;
+        for (int id = 1; id <= 3000; ++id) {
+            const OrderState state = id % 3 == 0 ? OrderState::SERVED : OrderState::PREPARING;
+            batch.push_back(Order{id, id % 50, 10.0, 1, 1700000000 + id, state});
+        }
+        csv->saveOrders(batch.data(), batch.size());
+        
+        std::size_t seen = 0;
+        const std::size_t visited = csv->forEachOrder(
+            [](const Order& order) { return order.customerId == 7; },
+            [&](const Order& order) { seen += order.customerId == 7; return true; });
+        assertTrue("Predicate filters inside the scan", visited == 60 && seen == 60);
+        
+        int lastId = 0;
+        csv->forEachOrder(nullptr, [&](const Order& order) { lastId = order.orderId; return order.orderId < 10; });
+        assertTrue("Visitor stops the scan", lastId == 10);
+        
+        std::size_t customers = csv->forEachCustomer(nullptr, [](const CustomerRecord&) { return true; });
+        assertTrue("Missing file scans nothing", customers == 0);
+        
+        // Query service reads whichever strategy the manager holds
+        auto& manager = StorageManager::instance();
+        manager.setStrategy(std::move(csv));
+        auto& queries = OrderQueryService::instance();
+        assertTrue("Orders by customer", queries.getOrdersByCustomer(7).size() == 60);
+        assertTrue("Active orders", queries.getActiveOrders().size() == 2000);
+        assertTrue("Orders by status", queries.getOrdersByStatus(OrderState::SERVED).size() == 1000);
+        assertTrue("Last order", queries.getLastOrder().orderId == 3000);
+        
+        // Updated orders count once, in their new state
+        manager.getStrategy().saveOrder(Order{1, 1, 10.0, 1, 1700000001, OrderState::SERVED});
+        manager.getStrategy().saveOrder(Order{2, 2, 10.0, 1, 1700000002, OrderState::READY});
+        assertTrue("Served order no longer active", queries.getActiveOrders().size() == 1999 &&
+                                                    queries.getOrdersByStatus(OrderState::SERVED).size() == 1001);
+        assertTrue("Updates do not inflate counts", queries.countOrders(nullptr) == 3000 &&
+                                                    queries.getOrdersByStatus(OrderState::PREPARING).size() == 1998 &&
+                                                    queries.getLastOrder().orderId == 3000);
+        
+        manager.setStrategy(std::make_unique<LSMStorageStrategy>(dir + "/lsm"));
+        manager.getStrategy().saveOrders(batch.data(), batch.size());
+        assertTrue("LSM scans stream too", queries.countOrders([](const Order& order) {
+            return order.state == OrderState::SERVED;
+        }) == 1000);
+        manager.setStrategy(std::make_unique<CSVStorageStrategy>());
+    }
+    
+    // Released pages read back unchanged from the page cache
+    MappedFile mapped;
+    assertTrue("Data file maps", mapped.openReadOnly(dir + "/orders.txt"));
+    const std::string before(mapped.data(), mapped.size());
+    mapped.adviseSequential();
+    mapped.release(0, mapped.size());
+    assertTrue("Released mapping still reads", std::string(mapped.data(), mapped.size()) == before);
+    mapped.close();
+    
+    std::filesystem::remove_all(dir);
+}
+
+void testStorageCache() {
+    std::cout << "\n[TEST SUITE] Write-Behind Storage Cache\n";
+    
+    const std::string dir = "test_storage_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir + "/sync");
+    {
+        StorageCacheOptions options;
+        options.flushInterval = std::chrono::hours(1);   // Explicit flushes only
+        options.capacity = 100;
+        CachingStorageStrategy cache(std::make_unique<CSVStorageStrategy>(dir), options);
+        StorageStrategy& backend = cache.getBackend();
+        
+        for (int id = 1; id <= 50; ++id) {
+            cache.saveOrder(Order{id, id % 5, 10.0, 1, 1700000000, OrderState::CREATED});
+        }
+        assertTrue("Saves are absorbed", cache.loadOrder(7).orderId == 7 && backend.loadOrder(7).orderId == 0 &&
+                                         cache.getStats().dirtyRecords == 50);
+        assertTrue("Flush writes the batch", cache.flush() && backend.loadAllOrders().size() == 50 &&
+                                             cache.getStats().dirtyRecords == 0 &&
+                                             cache.getStats().flushedRecords == 50);
+        
+        cache.saveOrder(Order{7, 2, 99.0, 2, 1700000000, OrderState::CONFIRMED});
+        cache.saveOrder(Order{7, 2, 99.5, 3, 1700000000, OrderState::PREPARING});
+        assertTrue("Latest version served before the flush", cache.loadOrder(7).total == 99.5 &&
+                                                             backend.loadOrder(7).total == 10.0);
+        const std::size_t scanned = cache.forEachOrder([](const Order& order) { return order.total == 99.5; },
+                                                       [](const Order&) { return true; });
+        assertTrue("Scans flush first", scanned == 1 && backend.loadOrder(7).total == 99.5 &&
+                                        cache.getStats().flushedRecords == 51);
+        
+        assertTrue("Misses remember missing IDs", cache.loadOrder(900).orderId == 0 &&
+                                                  cache.loadOrder(900).orderId == 0 &&
+                                                  cache.getStats().misses == 1);
+        
+        CustomerRecord customer{};
+        customer.id = 4;
+        customer.name = "Anita";
+        cache.saveCustomer(customer);
+        assertTrue("Deletes reach the backend", cache.deleteCustomer(4) && !backend.loadCustomer(4).isActive &&
+                                                !cache.loadCustomer(4).isActive);
+        
+        std::vector<Order> batch;
+        for (int id = 100; id < 250; ++id) {
+            batch.push_back(Order{id, 1, 5.0, 1, 1700000000, OrderState::CREATED});
+        }
+        cache.saveOrders(batch.data(), batch.size());
+        assertTrue("Dirty records stay past capacity", cache.getStats().cachedRecords > 150);
+        cache.flush();
+        const StorageCacheStats stats = cache.getStats();
+        assertTrue("Clean records evicted (LRU)", stats.cachedRecords <= 3 * options.capacity &&
+                                                  cache.loadOrder(100).total == 5.0 &&
+                                                  cache.getStats().misses == stats.misses + 1);
+        assertTrue("Stats track hits and flushes", stats.hitRatio() > 0.5 && stats.flushes >= 4 &&
+                                                   stats.maxFlushMs >= stats.meanFlushMs());
+    }
+    
+    // Group commit: every save returns once it is in the backend
+    {
+        StorageCacheOptions options;
+        options.durability = StorageCacheOptions::Durability::SYNC_ON_COMMIT;
+        CachingStorageStrategy cache(std::make_unique<CSVStorageStrategy>(dir + "/sync"), options);
+        std::atomic<int> failures{0};
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&cache, &failures, t] {
+                for (int i = 1; i <= 100; ++i) {
+                    if (!cache.saveOrder(Order{t * 100 + i, t, 1.0, 1, 1700000000, OrderState::CREATED})) failures++;
+                }
+            });
+        }
+        for (auto& writer : writers) writer.join();
+        assertTrue("Synchronous saves land", failures == 0 && cache.getStats().dirtyRecords == 0 &&
+                                             cache.getBackend().loadAllOrders().size() == 400 &&
+                                             cache.getStats().flushedRecords == 400);
+    }
+    
+    // Periodic flushes, and whatever is left goes out on close
+    {
+        StorageCacheOptions options;
+        options.flushInterval = std::chrono::milliseconds(5);
+        CachingStorageStrategy cache(std::make_unique<CSVStorageStrategy>(dir + "/sync"), options);
+        cache.saveOrder(Order{1000, 9, 7.0, 1, 1700000000, OrderState::CREATED});
+        for (int i = 0; i < 200 && cache.getStats().flushes == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        assertTrue("Background flush runs", cache.getStats().flushedRecords == 1);
+        cache.saveOrder(Order{1001, 9, 7.0, 1, 1700000000, OrderState::CREATED});
+    }
+    assertTrue("Close writes the rest", CSVStorageStrategy(dir + "/sync").loadOrder(1001).orderId == 1001);
+    
+    // StorageManager wraps whatever backend it holds
+    auto& manager = StorageManager::instance();
+    manager.setStrategy(std::make_unique<CSVStorageStrategy>(dir));
+    manager.enableCache(StorageCacheOptions());
+    manager.getStrategy().saveMenuItem(MenuItem{3, "Idli", "Breakfast", 40.0});
+    StorageCacheStats stats;
+    assertTrue("StorageManager runs cached", manager.getStorageType() == "CSV Storage (cached)" &&
+                                             manager.getStrategy().loadMenuItem(3).name == "Idli" &&
+                                             manager.getCacheStats(stats) && stats.hits == 1);
+    const SystemHealth health = HealthService::instance().checkHealth();
+    assertTrue("HealthService reports the cache", health.storageCacheEnabled && health.storageCacheHitRatio == 1.0);
+    manager.setStrategy(std::make_unique<CSVStorageStrategy>());
+    assertTrue("Plain strategy again", !manager.getCacheStats(stats));
+    
+    std::filesystem::remove_all(dir);
+}
+
 void testOrderStateTransitions() {
     std::cout << "\n[TEST SUITE] Order State Machine\n";
     
@@ -318,13 +1581,34 @@ int main() {
     
     // TIER-2 Tests
     testEventSystem();
+    testTypedEventSubscription();
+    testAsyncEventDispatch();
+    testConcurrentEventBus();
+    testEventCoalescing();
+    testEventLog();
     testIdempotencyService();
+    testConcurrentIdempotency();
+    testIdempotencyExpiry();
+    testIdempotencyFilter();
+    testIdempotencyPersistence();
+    testSingleFlightRequests();
     testSoftDelete();
     
     // TIER-3 Tests
     testSnapshotRecovery();
     testCommandPattern();
     testValidationDSL();
+    testTransactionManager();
+    testWriteAheadLog();
+    testOptimisticTransactions();
+    testEntityLocks();
+    testCsvStorage();
+    testCsvIndex();
+    testCsvBatchWrites();
+    testLsmStorage();
+    testStreamingQueries();
+    testCsvCompaction();
+    testStorageCache();
     
     // Lifecycle Tests
     testOrderStateTransitions();
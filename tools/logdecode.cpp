@@ -0,0 +1,33 @@
+/**
+ * logdecode - Binary log decoder
+ * Converts a binary structured log (Logger::enableBinary) back into the
+ * regular text log format
+ *
+ * Build: g++ -std=c++17 -O2 tools/logdecode.cpp src/BinaryLog.cpp src/Logger.cpp -Iinclude -pthread -o logdecode
+ * Run:   ./logdecode restaurant.blog > restaurant.decoded.log
+ */
+
+#include "BinaryLog.h"
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary-log-file>\n";
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "logdecode: cannot open " << argv[1] << "\n";
+        return 1;
+    }
+
+    long records = BinaryLog::decode(in, std::cout);
+    if (records < 0) {
+        std::cerr << "logdecode: " << argv[1] << " is not a binary log\n";
+        return 1;
+    }
+    std::cerr << "logdecode: " << records << " records\n";
+    return 0;
+}